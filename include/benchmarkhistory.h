@@ -0,0 +1,61 @@
+/***********************************************************************
+*    benchmarkhistory.h:                                               *
+*    Keeps past benchmark runs and spots regressions for EasyGpp       *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a BenchmarkHistory class.     *
+*    This class stores the wall clock times of every benchmark of a    *
+*    project, tagged with what produced the executable (a hash of the  *
+*    sources, the compiler and a hash of the flags), and compares a    *
+*    new benchmark against the last comparable one with a Mann-Whitney *
+*    U test                                                            *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_BENCHMARKHISTORY_H
+#define EASYGPP_BENCHMARKHISTORY_H
+
+#include <string>
+#include <vector>
+
+struct BenchmarkEntry
+{
+    long long timestamp;
+    std::string programName;
+    std::string sourceHash;
+    std::string compiler;
+    std::string flagsHash;
+    std::string argumentsHash;
+    std::vector<double> wallMilliseconds;
+};
+
+class BenchmarkHistory
+{
+public:
+    BenchmarkHistory(const std::string &historyPath, size_t entryLimit);
+
+    bool load();
+    bool save() const;
+    //The most recent earlier run of the same program, built by the same
+    //compiler with the same flags and run with the same arguments
+    const BenchmarkEntry *baselineFor(const BenchmarkEntry &benchmarkEntry) const;
+    void addEntry(const BenchmarkEntry &benchmarkEntry);
+    
+    static std::string compare(const BenchmarkEntry &baseline, const BenchmarkEntry &current, double significanceLevel);
+    //Two sided p value of the null hypothesis that both samples come from
+    //the same distribution (exact when there are no ties and few samples)
+    static double mannWhitneyPValue(const std::vector<double> &firstSample, const std::vector<double> &secondSample);
+
+private:
+    std::string m_historyPath;
+    size_t m_entryLimit;
+    std::vector<BenchmarkEntry> m_entries;
+};
+
+#endif //EASYGPP_BENCHMARKHISTORY_H
@@ -0,0 +1,74 @@
+/***********************************************************************
+*    benchmarkrunner.h:                                                *
+*    Runs a compiled program repeatedly and measures it for EasyGpp    *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a BenchmarkRunner class. This *
+*    class runs a program directly (no shell in between) a number of   *
+*    times, collects the wall clock time and the resource usage the    *
+*    kernel reports for each run, and summarizes them statistically    *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_BENCHMARKRUNNER_H
+#define EASYGPP_BENCHMARKRUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "processlauncher.h"
+
+struct RunSample
+{
+    //-1 when the program could not be started, which leaves the rest at zero
+    int returnValue;
+    double wallSeconds;
+    double userSeconds;
+    double systemSeconds;
+    long peakMemoryKilobytes;
+    long voluntaryContextSwitches;
+    long involuntaryContextSwitches;
+};
+
+struct SampleSummary
+{
+    double mean;
+    double median;
+    double percentile95;
+    double standardDeviation;
+    double minimum;
+    double maximum;
+    //Indexes of the samples outside Tukey's fences (1.5 IQR past the quartiles)
+    std::vector<size_t> outliers;
+};
+
+class BenchmarkRunner
+{
+public:
+    BenchmarkRunner(const std::string &programPath, const std::vector<std::string> &arguments, const LaunchSettings &launchSettings = LaunchSettings{});
+
+    //The program's output is discarded, so only the program itself is timed
+    RunSample runOnce() const;
+    std::vector<RunSample> run(unsigned int warmupRuns, unsigned int timedRuns) const;
+    //Runs with a non-zero return value are counted, but left out of the figures
+    std::string report(const std::vector<RunSample> &samples) const;
+
+    static bool splitArguments(const std::string &argumentString, std::vector<std::string> &arguments);
+    static SampleSummary summarize(const std::vector<double> &values);
+    static double percentile(std::vector<double> sortedValues, double fraction);
+    //Half the width of the 95% confidence interval of the mean (Student's t)
+    static double confidenceHalfWidth95(const std::vector<double> &values);
+
+private:
+    std::string m_programPath;
+    std::vector<std::string> m_arguments;
+    ProcessLauncher m_processLauncher;
+};
+
+#endif //EASYGPP_BENCHMARKRUNNER_H
@@ -0,0 +1,77 @@
+/***********************************************************************
+*    buildmanifest.h:                                                  *
+*    Tracks what is needed to decide whether objects are stale         *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a BuildManifest class. This   *
+*    class records, for every object file, a fingerprint of the command*
+*    that produced it and the modification time and size of every file *
+*    the compiler reported (via -MMD) as an input, so that an unchanged*
+*    project can be detected using nothing but stat() calls            *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_BUILDMANIFEST_H
+#define EASYGPP_BUILDMANIFEST_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <cstdint>
+
+#include "easygpputilities.h"
+
+class BuildManifest
+{
+public:
+    explicit BuildManifest(const std::string &manifestPath);
+    bool load();
+    bool save() const;
+
+    bool objectIsUpToDate(const std::string &objectPath, uint64_t commandHash) const;
+    bool recordObject(const std::string &objectPath,
+                      uint64_t commandHash,
+                      const std::string &dependencyFilePath,
+                      long long compileStartTime);
+    void forgetObjectsExcept(const std::set<std::string> &objectPaths);
+
+    bool linkIsUpToDate(const std::string &executablePath, uint64_t linkHash) const;
+    void recordLink(const std::string &executablePath, uint64_t linkHash);
+
+    uint64_t configurationHash() const;
+    void setConfigurationHash(uint64_t configurationHash);
+    const std::set<std::string> &libraries() const;
+    void setLibraries(const std::set<std::string> &libraries);
+    const std::string &precompiledHeader() const;
+    void setPrecompiledHeader(const std::string &precompiledHeader);
+    const std::set<std::string> &splitUnityBatches() const;
+    void setSplitUnityBatches(const std::set<std::string> &splitUnityBatches);
+
+    static std::vector<std::string> parseDependencyFile(const std::string &dependencyFilePath);
+
+private:
+    struct ObjectEntry
+    {
+        uint64_t commandHash;
+        EasyGppUtilities::FileStamp objectStamp;
+        std::vector<std::pair<std::string, EasyGppUtilities::FileStamp>> dependencies;
+    };
+
+    std::string m_manifestPath;
+    uint64_t m_configurationHash;
+    uint64_t m_linkHash;
+    EasyGppUtilities::FileStamp m_executableStamp;
+    std::set<std::string> m_libraries;
+    std::string m_precompiledHeader;
+    std::set<std::string> m_splitUnityBatches;
+    std::map<std::string, ObjectEntry> m_objects;
+};
+
+#endif //EASYGPP_BUILDMANIFEST_H
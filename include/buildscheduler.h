@@ -0,0 +1,64 @@
+/***********************************************************************
+*    buildscheduler.h:                                                 *
+*    Runs independent compiler invocations in parallel for EasyGpp     *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a BuildScheduler class. This  *
+*    class runs a list of shell commands (usually one compiler         *
+*    invocation per translation unit) across a fixed number of worker  *
+*    threads, buffering everything each command prints so that the     *
+*    diagnostics can be reported in order once the command finishes    *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_BUILDSCHEDULER_H
+#define EASYGPP_BUILDSCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+
+struct BuildResult
+{
+    int returnValue;
+    std::string output;
+    double elapsedSeconds;
+    long peakMemoryKilobytes;
+    bool fromCache;
+    //Steady clock time (in seconds) at which a scheduled job started
+    double startTime;
+};
+
+struct BuildJob
+{
+    std::string description;
+    std::string command;
+    //When set, the worker calls this instead of running the command itself
+    std::function<BuildResult()> action;
+};
+
+class BuildScheduler
+{
+public:
+    explicit BuildScheduler(unsigned int jobCount);
+    unsigned int jobCount() const;
+
+    //The callback is invoked on the calling thread, in the same order
+    //as the jobs were given, as soon as each job (and all before it) is done
+    std::vector<BuildResult> run(const std::vector<BuildJob> &jobs,
+                                 const std::function<void(size_t, const BuildJob &, const BuildResult &)> &onJobFinished) const;
+
+    static unsigned int defaultJobCount();
+    static BuildResult runCommand(const std::string &command);
+
+private:
+    unsigned int m_jobCount;
+};
+
+#endif //EASYGPP_BUILDSCHEDULER_H
@@ -0,0 +1,66 @@
+/***********************************************************************
+*    cacheprofile.h:                                                   *
+*    Reads and compares cachegrind profiles for EasyGpp                *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a CacheProfile class. This    *
+*    class reads the output of valgrind's cachegrind tool, adds up the *
+*    instruction counts and cache misses by function and by source     *
+*    line, and reports them sorted by an estimated cost. A profile can *
+*    be saved and compared with the one from the previous build        *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_CACHEPROFILE_H
+#define EASYGPP_CACHEPROFILE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+struct CacheCounts
+{
+    uint64_t instructions;
+    uint64_t dataAccesses;
+    uint64_t level1DataMisses;
+    uint64_t lastLevelDataMisses;
+    uint64_t level1InstructionMisses;
+    uint64_t lastLevelInstructionMisses;
+};
+
+class CacheProfile
+{
+public:
+    CacheProfile();
+
+    //The miss counts are only there when cachegrind ran with --cache-sim=yes
+    bool readCachegrindOutput(const std::string &outputPath);
+    bool load(const std::string &profilePath);
+    bool save(const std::string &profilePath) const;
+    bool empty() const;
+    std::string report(size_t topCount) const;
+    std::string compare(const CacheProfile &previous, size_t topCount) const;
+
+    //Cycles estimated the way cg_annotate does: one per instruction, ten
+    //per first level miss and a hundred per last level miss
+    static uint64_t estimatedCost(const CacheCounts &cacheCounts);
+
+private:
+    CacheCounts m_totals;
+    //Keyed by function name, and by "file:line"
+    std::map<std::string, CacheCounts> m_functions;
+    std::map<std::string, CacheCounts> m_lines;
+
+    static void addCounts(CacheCounts &total, const CacheCounts &addition);
+    static std::vector<std::pair<std::string, CacheCounts>> sortedByCost(const std::map<std::string, CacheCounts> &countsMap);
+    static std::string missRate(uint64_t misses, uint64_t accesses);
+};
+
+#endif //EASYGPP_CACHEPROFILE_H
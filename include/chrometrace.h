@@ -0,0 +1,56 @@
+/***********************************************************************
+*    chrometrace.h:                                                    *
+*    Reads and writes Chrome trace event files for EasyGpp             *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a ChromeTrace class. This     *
+*    class collects "complete" (begin and duration) trace events on    *
+*    named lanes and writes them in the JSON format understood by      *
+*    chrome://tracing and Perfetto, and can read back the events of a  *
+*    trace written by another tool (eg clang's -ftime-trace)           *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_CHROMETRACE_H
+#define EASYGPP_CHROMETRACE_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+struct TraceEvent
+{
+    std::string name;
+    //Shown as args.detail, eg the header or template an event is about
+    std::string detail;
+    double startMicroseconds;
+    double durationMicroseconds;
+    int threadId;
+};
+
+class ChromeTrace
+{
+public:
+    ChromeTrace();
+
+    void addEvent(const TraceEvent &traceEvent);
+    void setThreadName(int threadId, const std::string &threadName);
+    const std::vector<TraceEvent> &events() const;
+    bool write(const std::string &filePath) const;
+
+    //Only complete ("ph":"X") events are returned
+    static bool readEvents(const std::string &filePath, std::vector<TraceEvent> &traceEvents);
+    static std::string escapeJson(const std::string &stringToEscape);
+
+private:
+    std::vector<TraceEvent> m_events;
+    std::map<int, std::string> m_threadNames;
+};
+
+#endif //EASYGPP_CHROMETRACE_H
@@ -0,0 +1,60 @@
+/***********************************************************************
+*    compilecache.h:                                                   *
+*    A content addressed object file cache shared between projects     *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a CompileCache class. This    *
+*    class stores object files (and the diagnostics printed while      *
+*    making them) under a key made from the preprocessed source and    *
+*    the normalized compile flags, so an identical translation unit    *
+*    from any project can be reused without invoking the compiler. The *
+*    cache is kept under a size limit by evicting the least recently   *
+*    used entries, and entries can optionally be stored compressed     *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_COMPILECACHE_H
+#define EASYGPP_COMPILECACHE_H
+
+#include <string>
+#include <mutex>
+
+class CompileCache
+{
+public:
+    CompileCache(const std::string &cacheDirectory, long long maximumSize, bool compression);
+
+    static std::string makeKey(const std::string &preprocessedFilePath, const std::string &normalizedFlags);
+    bool fetch(const std::string &key, const std::string &objectFilePath, std::string &compilerOutput);
+    bool store(const std::string &key, const std::string &objectFilePath, const std::string &compilerOutput);
+    std::string statistics() const;
+    bool compressionAvailable() const;
+
+private:
+    struct CacheStatistics
+    {
+        long long hits;
+        long long misses;
+        long long stores;
+        long long evictions;
+        long long totalSize;
+    };
+
+    std::string m_cacheDirectory;
+    long long m_maximumSize;
+    bool m_compression;
+    std::mutex m_statisticsMutex;
+
+    std::string entryBasePath(const std::string &key) const;
+    void updateStatistics(long long hits, long long misses, long long stores, long long sizeChange);
+    CacheStatistics readStatistics() const;
+    void evictLeastRecentlyUsed(CacheStatistics &cacheStatistics);
+};
+
+#endif //EASYGPP_COMPILECACHE_H
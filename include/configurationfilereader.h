@@ -10,7 +10,9 @@
 *    class. This class is used to configure EasyGpp, with things like  *
 *    auto populating included libraries (according to headers used),   *
 *    as well as specifying extra editors to choose from if the target  *
-*    program does not compile correctly, and must be edited            *
+*    program does not compile correctly, and must be edited. The parsed *
+*    result is kept in a compiled copy next to the configuration file, *
+*    so an unchanged file is not parsed again                          *
 *                                                                      *
 *    You should have received a copy of the GNU Lesser General         *
 *    Public license along with libraryprojects                         *
@@ -32,20 +34,45 @@
 #include <generalutilities.h>
 
 #include "easygppstrings.h"
+#include "easygpputilities.h"
 
 
 class ConfigurationFileReader
 {
 public:
     ConfigurationFileReader();
-    std::set<std::string> extraEditors() const;
-    std::map<std::string, std::string> libraryToHeaderMap() const;
-    std::vector<std::string> output() const;
+    const std::set<std::string> &extraEditors() const;
+    const std::map<std::string, std::string> &libraryToHeaderMap() const;
+    const std::vector<std::string> &output() const;
+    bool compileCacheEnabled() const;
+    long long compileCacheSize() const;
+    bool compileCacheCompression() const;
+    const std::vector<std::string> &precompiledHeaders() const;
+    const std::string &linker() const;
+    bool splitDwarf() const;
+    const std::map<std::string, std::string> &profiles() const;
+    const std::vector<std::string> &tuneOptions() const;
+
+    static long long parseByteSize(const std::string &sizeString);
 
 private:
     std::set<std::string> m_extraEditors;
     std::map<std::string, std::string> m_libraryToHeaderMap;
     std::vector<std::string> m_output;
+    bool m_compileCacheEnabled;
+    long long m_compileCacheSize;
+    bool m_compileCacheCompression;
+    std::vector<std::string> m_precompiledHeaders;
+    std::string m_linker;
+    bool m_splitDwarf;
+    std::map<std::string, std::string> m_profiles;
+    std::vector<std::string> m_tuneOptions;
+
+    bool getSingleArgument(const std::string &rawLine, const std::string &copyString, long int currentLine, std::string &argument);
+    bool getBooleanArgument(const std::string &rawLine, const std::string &argument, long int currentLine, bool &value);
+    void addConfigurationWarning(const std::string &rawLine, long int currentLine, const std::string &warning, size_t markerPosition);
+    bool loadCompiledConfiguration(const std::string &configurationFilePath);
+    bool saveCompiledConfiguration(const std::string &configurationFilePath, const EasyGppUtilities::FileStamp &fileStamp) const;
 };
 
 #endif //EASYGPP_CONFIGURATIONFILEREADER_H
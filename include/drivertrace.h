@@ -0,0 +1,78 @@
+/***********************************************************************
+*    drivertrace.h:                                                    *
+*    Times the phases of easyg++ itself for EasyGpp                    *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a DriverTrace class. This     *
+*    class records monotonic clock spans around the phases easyg++     *
+*    goes through before and around running the compiler, so the       *
+*    overhead of the driver itself can be broken down and written out  *
+*    as a Chrome trace                                                 *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_DRIVERTRACE_H
+#define EASYGPP_DRIVERTRACE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+
+class DriverTrace
+{
+public:
+    //Ends its phase when it goes out of scope (or when end() is called)
+    class Span
+    {
+    public:
+        Span(DriverTrace *driverTrace, size_t spanIndex);
+        Span(Span &&other);
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+        ~Span();
+        void end();
+
+    private:
+        DriverTrace *m_driverTrace;
+        size_t m_spanIndex;
+    };
+
+    DriverTrace();
+
+    //External phases are time spent waiting on the compiler or linker,
+    //which is left out of the driver's own overhead
+    Span span(const std::string &phaseName, bool external = false);
+    std::string summary() const;
+    bool write(const std::string &filePath) const;
+
+private:
+    struct PhaseRecord
+    {
+        std::string name;
+        int threadId;
+        size_t depth;
+        bool external;
+        double startMicroseconds;
+        double durationMicroseconds;
+    };
+
+    std::chrono::steady_clock::time_point m_startTime;
+    mutable std::mutex m_mutex;
+    std::vector<PhaseRecord> m_phases;
+    std::map<std::thread::id, int> m_threadIds;
+    std::map<int, size_t> m_openDepths;
+
+    double elapsedMicroseconds() const;
+    void endSpan(size_t spanIndex);
+};
+
+#endif //EASYGPP_DRIVERTRACE_H
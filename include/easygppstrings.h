@@ -18,6 +18,7 @@
 #define EASYGPP_EASYGPPSTRINGS_H
 
 #include <list>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -42,6 +43,36 @@ namespace EasyGppStrings
 	extern const std::list<const char *> NO_RECORD_GCC_SWITCHES_SWITCHES;
 	extern const std::list<const char *> NO_F_SANITIZE_SWITCHES;
 	extern const std::list<const char *> CONFIGURATION_FILE_SWITCHES;
+	extern const std::list<const char *> JOBS_SWITCHES;
+	extern const std::list<const char *> SINGLE_COMMAND_SWITCHES;
+	extern const std::list<const char *> UNITY_SWITCHES;
+	extern const std::list<const char *> REBUILD_SWITCHES;
+	extern const std::list<const char *> NO_PRECOMPILED_HEADER_SWITCHES;
+	extern const std::list<const char *> COMPILE_CACHE_SWITCHES;
+	extern const std::list<const char *> NO_COMPILE_CACHE_SWITCHES;
+	extern const std::list<const char *> CACHE_STATISTICS_SWITCHES;
+	extern const std::list<const char *> TIME_REPORT_SWITCHES;
+	extern const std::list<const char *> REMARKS_SWITCHES;
+	extern const std::list<const char *> TRACE_DRIVER_SWITCHES;
+	extern const std::list<const char *> PROFILE_SWITCHES;
+	extern const std::list<const char *> PGO_SWITCHES;
+	extern const std::list<const char *> PGO_ARGUMENTS_SWITCHES;
+	extern const std::list<const char *> PGO_INPUT_SWITCHES;
+	extern const std::list<const char *> AUTOTUNE_SWITCHES;
+	extern const std::list<const char *> AUTOTUNE_SAVE_SWITCHES;
+	extern const std::list<const char *> COMPARE_TOOLCHAINS_SWITCHES;
+	extern const std::list<const char *> LTO_SWITCHES;
+	extern const std::list<const char *> BENCHMARK_SWITCHES;
+	extern const std::list<const char *> WARMUP_SWITCHES;
+	extern const std::list<const char *> STABLE_RUN_SWITCHES;
+	extern const std::list<const char *> NO_ASLR_SWITCHES;
+	extern const std::list<const char *> MEMORY_LIMIT_SWITCHES;
+	extern const std::list<const char *> CPU_LIMIT_SWITCHES;
+	extern const std::list<const char *> TEST_SWITCHES;
+	extern const std::list<const char *> TEST_TIMEOUT_SWITCHES;
+	extern const std::list<const char *> PROFILE_RUN_SWITCHES;
+	extern const std::list<const char *> CACHE_PROFILE_SWITCHES;
+	extern const std::list<const char *> MICROBENCH_SWITCHES;
 	extern const char *GDB_SWITCH;
 	extern const char *GCC_COMPILER;
 	extern const char *GPP_COMPILER;
@@ -61,6 +92,77 @@ namespace EasyGppStrings
 
 	extern const char *EDITOR_IDENTIFIER;
 	extern const char *LIBRARY_IDENTIFIER;
+	extern const char *COMPILE_CACHE_IDENTIFIER;
+	extern const char *CACHE_SIZE_IDENTIFIER;
+	extern const char *CACHE_COMPRESSION_IDENTIFIER;
+	extern const long long DEFAULT_COMPILE_CACHE_SIZE;
+	extern const std::string COMPILE_CACHE_DIRECTORY;
+	extern const char *PRECOMPILED_HEADER_IDENTIFIER;
+	extern const char *LINKER_IDENTIFIER;
+	extern const char *SPLIT_DWARF_IDENTIFIER;
+	extern const char *PROFILE_IDENTIFIER;
+	extern const char *TUNE_OPTION_IDENTIFIER;
+	extern const std::vector<const char *> DEFAULT_TUNE_OPTIONS;
+	extern const unsigned int AUTOTUNE_VARIANT_LIMIT;
+	extern const char *AUTOTUNE_DIRECTORY_SUFFIX;
+	extern const char *TOOLCHAINS_DIRECTORY_SUFFIX;
+	extern const std::map<std::string, std::string> BUILT_IN_PROFILES;
+	extern const char *AUTOMATIC_LINKER;
+	extern const std::list<const char *> KNOWN_LINKERS;
+	extern const std::string LINKER_CACHE_FILE;
+	extern const char *SPLIT_DWARF_SWITCHES;
+	extern const char *COMPRESSED_DEBUG_SWITCH;
+	extern const char *GDB_INDEX_SWITCH;
+	extern const char *GCC_LTO_COMPILE_SWITCH;
+	extern const char *GCC_LTO_LINK_SWITCH;
+	extern const char *GCC_LTO_INCREMENTAL_SWITCH;
+	extern const char *CLANG_THIN_LTO_SWITCH;
+	extern const char *LTO_CACHE_NAME;
+	extern const char *PRECOMPILED_HEADER_NAME;
+	extern const std::string PRECOMPILED_HEADER_DIRECTORY;
+	extern const std::string EDITOR_CACHE_FILE;
+	extern const char *COMPILED_CONFIGURATION_EXTENSION;
+	extern const char *BUILD_DIRECTORY_NAME;
+	extern const char *OBJECT_FILE_EXTENSION;
+	extern const char *BUILD_MANIFEST_NAME;
+	extern const char *UNITY_SOURCE_PREFIX;
+	extern const unsigned int DEFAULT_UNITY_BATCH_SIZE;
+	extern const char *SCAN_CACHE_NAME;
+	extern const char *TIME_TRACE_NAME;
+	extern const unsigned int TIME_REPORT_TOP_COUNT;
+	extern const unsigned int DEFAULT_BENCHMARK_RUNS;
+	extern const unsigned int DEFAULT_WARMUP_RUNS;
+	extern const char *BENCHMARK_HISTORY_NAME;
+	extern const unsigned int DEFAULT_SAMPLING_FREQUENCY;
+	extern const unsigned int PROFILE_RUN_TOP_COUNT;
+	extern const char *FRAME_POINTER_SWITCH;
+	extern const char *FOLDED_STACKS_NAME;
+	extern const std::string SAMPLER_DIRECTORY;
+	extern const char *VALGRIND_PROGRAM;
+	extern const char *CACHEGRIND_SWITCHES;
+	extern const char *CACHEGRIND_OUTPUT_NAME;
+	extern const char *CACHE_PROFILE_NAME;
+	extern const unsigned int CACHE_PROFILE_TOP_COUNT;
+	extern const char *MICROBENCH_SUFFIX;
+	extern const char *MICROBENCH_SOURCE_NAME;
+	extern const unsigned int MICROBENCH_SAMPLE_COUNT;
+	extern const double MICROBENCH_TARGET_SECONDS;
+	extern const double MICROBENCH_WARMUP_SECONDS;
+	extern const unsigned int DEFAULT_TEST_TIMEOUT_SECONDS;
+	extern const unsigned long MAXIMUM_MEMORY_LIMIT_MEGABYTES;
+	extern const unsigned long MAXIMUM_CPU_LIMIT_SECONDS;
+	extern const char *PGO_BUILD_DIRECTORY_SUFFIX;
+	extern const char *PGO_KEY_NAME;
+	extern const char *PGO_INSTRUMENTED_SUFFIX;
+	extern const char *GCC_PROFILE_GENERATE_SWITCHES;
+	extern const char *GCC_PROFILE_USE_SWITCHES;
+	extern const char *CLANG_PROFILE_GENERATE_SWITCHES;
+	extern const char *CLANG_PROFILE_USE_SWITCH;
+	extern const char *CLANG_RAW_PROFILE_NAME;
+	extern const char *CLANG_MERGED_PROFILE_NAME;
+	extern const char *LLVM_PROFDATA_PROGRAM;
+	extern const unsigned int BENCHMARK_HISTORY_LIMIT;
+	extern const double BENCHMARK_SIGNIFICANCE_LEVEL;
 	extern const char *CONFIGURATION_FILE_NAME;
 	extern const std::string DEFAULT_CONFIGURATION_FILE;
 	extern const std::string BACKUP_CONFIGURATION_FILE;
@@ -87,6 +189,11 @@ namespace EasyGppStrings
     extern const char *CONFIG_EXPRESSION_MALFORMED_STRING;
     extern const char *NO_H_EXTENSION_FOUND_STRING;
     extern const char *NO_LIBRARY_NAME_SPECIFIED_STRING;
+    extern const char *NO_ARGUMENT_SPECIFIED_STRING;
+    extern const char *INVALID_BOOLEAN_STRING;
+    extern const char *INVALID_SIZE_STRING;
+    extern const char *INVALID_LINKER_STRING;
+    extern const char *INVALID_PROFILE_NAME_STRING;
 	extern const char *STANDARD_EXCEPTION_CAUGHT_IN_CONSTRUCTOR_STRING;
 
 }
@@ -0,0 +1,61 @@
+/***********************************************************************
+*    easygpputilities.h:                                               *
+*    Small filesystem and string helpers used throughout EasyGpp       *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of helper functions that do not  *
+*    belong to any one part of EasyGpp, in the EasyGppUtilities        *
+*    namespace                                                         *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_EASYGPPUTILITIES_H
+#define EASYGPP_EASYGPPUTILITIES_H
+
+#include <string>
+#include <vector>
+#include <climits>
+#include <cstdint>
+
+namespace EasyGppUtilities
+{
+    struct FileStamp
+    {
+        long long modifiedTime;
+        long long size;
+    };
+
+    bool getFileStamp(const std::string &filePath, FileStamp &fileStamp);
+    bool operator==(const FileStamp &lhs, const FileStamp &rhs);
+    bool operator!=(const FileStamp &lhs, const FileStamp &rhs);
+    long long currentFileSystemTime();
+    bool parseFileStamp(const std::string &modifiedTime, const std::string &size, FileStamp &fileStamp);
+    std::vector<std::string> splitOnTabs(const std::string &line);
+    std::vector<std::string> splitOnCharacter(const std::string &line, char delimiter);
+
+    uint64_t fnv1a64(const std::string &stringToHash, uint64_t seed = 14695981039346656037ULL);
+    uint64_t fnv1a64(const char *data, size_t length, uint64_t seed = 14695981039346656037ULL);
+    std::string toHexString(uint64_t value);
+    bool fromHexString(const std::string &hexString, uint64_t &value);
+
+    bool makeDirectoryPath(const std::string &directoryPath);
+    std::string parentDirectory(const std::string &filePath);
+    std::string fileBaseName(const std::string &filePath);
+    std::string stripExtension(const std::string &fileName);
+    std::string flattenPath(const std::string &filePath);
+    //Full paths of the regular files directly inside a directory whose names end with the extension
+    std::vector<std::string> filesWithExtension(const std::string &directoryPath, const std::string &extension);
+    bool isUnsignedInteger(const std::string &stringToCheck);
+    //False, leaving value alone, unless the whole string is a number no
+    //larger than maximumValue (so a long run of digits never throws)
+    bool parseUnsignedInteger(const std::string &stringToParse, unsigned long &value, unsigned long maximumValue = ULONG_MAX);
+    bool parseUnsignedInteger(const std::string &stringToParse, unsigned int &value, unsigned int maximumValue = UINT_MAX);
+}
+
+#endif //EASYGPP_EASYGPPUTILITIES_H
@@ -0,0 +1,44 @@
+/***********************************************************************
+*    editorlocator.h:                                                  *
+*    Finds the text editors installed on the PATH for EasyGpp          *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of an EditorLocator class. This  *
+*    class looks for a fixed set of editor names in every PATH         *
+*    directory, and remembers what it found in a small cache file that *
+*    is thrown away when PATH or any directory on it changes           *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_EDITORLOCATOR_H
+#define EASYGPP_EDITORLOCATOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+class EditorLocator
+{
+public:
+    explicit EditorLocator(const std::string &cachePath);
+
+    //Executable name, path of the first match on the PATH
+    std::map<std::string, std::string> findEditors(const std::string &pathString, const std::vector<std::string> &candidateNames) const;
+
+private:
+    std::string m_cachePath;
+
+    bool loadCache(const std::string &pathString, uint64_t candidatesHash, std::map<std::string, std::string> &editorPaths) const;
+    bool saveCache(const std::string &pathString, uint64_t candidatesHash, const std::vector<std::string> &pathDirectories, const std::map<std::string, std::string> &editorPaths) const;
+
+    static long long directoryModifiedTime(const std::string &directoryPath);
+};
+
+#endif //EASYGPP_EDITORLOCATOR_H
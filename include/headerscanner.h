@@ -0,0 +1,87 @@
+/***********************************************************************
+*    headerscanner.h:                                                  *
+*    Finds the #include directives of source files for EasyGpp        *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a HeaderScanner class. This   *
+*    class memory maps source files and lexes them just far enough to  *
+*    find real #include directives (skipping comments, string and      *
+*    character literals), then matches the included header names       *
+*    against a hashed index of the AddLibrary() configuration entries. *
+*    Included headers that can be found next to the including file or  *
+*    in an include path are followed, and every file's include list is *
+*    remembered on disk so unchanged headers are not read again        *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_HEADERSCANNER_H
+#define EASYGPP_HEADERSCANNER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include "easygpputilities.h"
+
+struct IncludeDirective
+{
+    std::string headerName;
+    bool angled;
+    //True when nothing but comments and other #includes came before it
+    bool leading;
+};
+
+struct ScanResult
+{
+    bool readable;
+    std::vector<IncludeDirective> includes;
+    //Includes found in the headers reached (transitively) from this file
+    std::vector<IncludeDirective> nestedIncludes;
+};
+
+class HeaderScanner
+{
+public:
+    explicit HeaderScanner(const std::map<std::string, std::string> &libraryToHeaderMap);
+
+    void setIncludePaths(const std::vector<std::string> &includePaths);
+    bool loadScanCache(const std::string &scanCachePath);
+    bool saveScanCache(const std::string &scanCachePath) const;
+
+    std::vector<ScanResult> scanFiles(const std::vector<std::string> &filePaths, unsigned int jobCount);
+    //Returns (configured header, library) for every AddLibrary() entry
+    //that the included header matches
+    std::vector<std::pair<std::string, std::string>> librariesFor(const std::string &headerName) const;
+
+    static ScanResult scanFile(const std::string &filePath);
+    static void scanBuffer(const char *buffer, size_t length, std::vector<IncludeDirective> &includes);
+
+private:
+    struct CachedScan
+    {
+        EasyGppUtilities::FileStamp fileStamp;
+        bool readable;
+        bool used;
+        std::vector<IncludeDirective> includes;
+        //Parallel to includes, empty where the header could not be found
+        std::vector<std::string> resolvedIncludes;
+    };
+
+    std::unordered_map<std::string, std::vector<std::pair<std::string, std::string>>> m_headerIndex;
+    std::vector<std::string> m_includePaths;
+    std::unordered_map<std::string, CachedScan> m_scanCache;
+    std::unordered_map<std::string, std::string> m_resolvedPaths;
+
+    void refreshScans(const std::vector<std::string> &filePaths, unsigned int jobCount);
+    std::string resolveInclude(const std::string &includingFile, const IncludeDirective &includeDirective);
+};
+
+#endif //EASYGPP_HEADERSCANNER_H
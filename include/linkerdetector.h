@@ -0,0 +1,42 @@
+/***********************************************************************
+*    linkerdetector.h:                                                 *
+*    Picks the fastest linker the compiler can use for EasyGpp         *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a LinkerDetector class. This  *
+*    class asks the compiler driver to use mold, lld and gold (in that *
+*    order) and remembers the first one that works, so the probe only  *
+*    runs again when the compiler or PATH changes                      *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_LINKERDETECTOR_H
+#define EASYGPP_LINKERDETECTOR_H
+
+#include <string>
+#include <cstdint>
+
+class LinkerDetector
+{
+public:
+    explicit LinkerDetector(const std::string &cachePath);
+
+    //Returns the name to pass to -fuse-ld=, or an empty string when only
+    //the default linker works
+    std::string detectFastestLinker(const std::string &compilerCommand, const std::string &compilerIdentity) const;
+
+    static bool linkerWorks(const std::string &compilerCommand, const std::string &linkerName);
+    static bool supportsGdbIndex(const std::string &linkerName);
+    static std::string thinLtoCacheSwitch(const std::string &linkerName, const std::string &cacheDirectory);
+
+private:
+    std::string m_cachePath;
+};
+
+#endif //EASYGPP_LINKERDETECTOR_H
@@ -0,0 +1,54 @@
+/***********************************************************************
+*    microbenchharness.h:                                              *
+*    Generates a micro-benchmark harness for one function for EasyGpp  *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a MicrobenchHarness class.    *
+*    This class writes a translation unit that includes the source     *
+*    file holding the program's main() (renaming that main() out of    *
+*    the way) and replaces it with one that calls a single function in *
+*    a tight loop, scaling the iteration count to a target runtime and *
+*    reporting the time per call with a confidence interval            *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_MICROBENCHHARNESS_H
+#define EASYGPP_MICROBENCHHARNESS_H
+
+#include <string>
+
+class MicrobenchHarness
+{
+public:
+    //A bare function name is called with no arguments, anything else (eg
+    //"fibonacci(30)") is used as the call expression as it is. The arguments
+    //of a call are evaluated once, and hidden from the optimizer before each
+    //call, so they cannot be folded into it
+    MicrobenchHarness(const std::string &functionCall, unsigned int sampleCount, double targetSeconds, double warmupSeconds);
+
+    std::string callExpression() const;
+    std::string source(const std::string &includedSource) const;
+    //Only rewritten when the contents change, so an unchanged harness is not recompiled
+    bool write(const std::string &harnessPath, const std::string &includedSource) const;
+
+    //Whether main( appears in the file outside comments and literals
+    static bool definesMain(const std::string &sourceFile);
+
+private:
+    std::string m_callExpression;
+    unsigned int m_sampleCount;
+    double m_targetSeconds;
+    double m_warmupSeconds;
+
+    static std::string stringLiteral(const std::string &text);
+    //Splits "name(arguments)" into its two parts, false for anything else
+    static bool splitCall(const std::string &callExpression, std::string &function, std::string &arguments);
+};
+
+#endif //EASYGPP_MICROBENCHHARNESS_H
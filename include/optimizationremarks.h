@@ -0,0 +1,66 @@
+/***********************************************************************
+*    optimizationremarks.h:                                            *
+*    Collects the compiler's optimization remarks for EasyGpp          *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of an OptimizationRemarks class. *
+*    This class adds the compiler's remark switches to every compile,  *
+*    gathers what each translation unit reported about vectorization   *
+*    and inlining (gcc's -fopt-info output, or clang's saved           *
+*    optimization record), and turns it into one summary sorted by     *
+*    file, function and line                                           *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_OPTIMIZATIONREMARKS_H
+#define EASYGPP_OPTIMIZATIONREMARKS_H
+
+#include <string>
+#include <vector>
+#include <set>
+
+class OptimizationRemarks
+{
+public:
+    //With no file filters, only remarks about the project's own files
+    //(not system headers) are kept
+    OptimizationRemarks(bool clangRemarks, const std::vector<std::string> &fileFilters);
+
+    std::string compileSwitches() const;
+    //Returns the compiler output, minus the lines the remark switches added
+    std::string addTranslationUnit(const std::string &objectFile, const std::string &output);
+    size_t remarkCount() const;
+    std::string summary() const;
+
+private:
+    struct Remark
+    {
+        std::string file;
+        int line;
+        int column;
+        std::string kind;
+        std::string function;
+        std::string message;
+    };
+
+    bool m_clangRemarks;
+    std::vector<std::string> m_fileFilters;
+    std::string m_workingDirectory;
+    std::vector<Remark> m_remarks;
+    std::set<std::string> m_seenRemarks;
+    size_t m_filteredCount;
+
+    bool keepFile(const std::string &file) const;
+    void addRemark(const Remark &remark);
+    std::string readGccRemarks(const std::string &output);
+    std::string stripClangRemarks(const std::string &output) const;
+    void readClangRecord(const std::string &objectFile);
+};
+
+#endif //EASYGPP_OPTIMIZATIONREMARKS_H
@@ -0,0 +1,72 @@
+/***********************************************************************
+*    processlauncher.h:                                                *
+*    Starts compiled programs with controlled conditions for EasyGpp   *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a ProcessLauncher class. This *
+*    class starts a program with posix_spawn (or fork and exec when it *
+*    has resource limits, with no shell in between either way),        *
+*    optionally pinned to a set of CPUs, with address space layout     *
+*    randomization turned off, with address space and CPU time limits, *
+*    and with an environment padded to a fixed size, so that repeated  *
+*    runs of a program differ as little as possible                    *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_PROCESSLAUNCHER_H
+#define EASYGPP_PROCESSLAUNCHER_H
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/resource.h>
+
+struct LaunchSettings
+{
+    //Empty leaves the program free to run on any CPU
+    std::vector<int> cpus;
+    bool disableAddressRandomization;
+    bool normalizeEnvironment;
+    //Zero is unlimited
+    unsigned long addressSpaceLimitMegabytes;
+    unsigned long cpuTimeLimitSeconds;
+    //So the program and anything it starts can be killed together
+    bool ownProcessGroup;
+};
+
+class ProcessLauncher
+{
+public:
+    explicit ProcessLauncher(const LaunchSettings &launchSettings);
+
+    //A descriptor of -1 is inherited from easyg++. Returns the child's
+    //process id, or -1 with errno set
+    pid_t spawn(const std::string &programPath, const std::vector<std::string> &arguments, int inputDescriptor, int outputDescriptor, int errorDescriptor) const;
+    //Retries on EINTR, and converts the status the way a shell would (128 + signal)
+    static int waitForExit(pid_t childPid, struct rusage *resourceUsage);
+    const LaunchSettings &launchSettings() const;
+    std::string describe() const;
+
+    //A comma separated list of CPUs and ranges, eg "2,4-7"
+    static bool parseCpuList(const std::string &cpuList, std::vector<int> &cpus);
+    //The highest numbered CPU easyg++ may run on, since CPU 0 usually
+    //services the most interrupts
+    static int quietestCpu();
+    //A warning for every CPU (all of them when none are given) whose
+    //frequency governor is not "performance"
+    static std::vector<std::string> governorWarnings(const std::vector<int> &cpus);
+
+private:
+    LaunchSettings m_launchSettings;
+
+    std::vector<std::string> environment(const std::string &programPath, const std::vector<std::string> &arguments) const;
+};
+
+#endif //EASYGPP_PROCESSLAUNCHER_H
@@ -0,0 +1,90 @@
+/***********************************************************************
+*    samplingprofiler.h:                                               *
+*    Runs a compiled program under a sampling profiler for EasyGpp     *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a SamplingProfiler class.     *
+*    This class runs a program while sampling its call stacks, either  *
+*    with perf_event_open (cpu-clock events, which also work inside    *
+*    virtual machines) or, where perf is not allowed, with a small     *
+*    SIGPROF sampler that is preloaded into the program. The samples   *
+*    are symbolized with addr2line against the program's debug         *
+*    information, and reported as a table of hotspots and as folded    *
+*    stacks for flame graphs                                           *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_SAMPLINGPROFILER_H
+#define EASYGPP_SAMPLINGPROFILER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+class SamplingProfiler
+{
+public:
+    SamplingProfiler(const std::string &programPath, const std::vector<std::string> &arguments, unsigned int frequency);
+
+    //The preloaded sampler is built (once) in samplerDirectory with the
+    //compiler, and only used when perf_event_open is not allowed. Returns
+    //false when the program could not be run at all
+    bool run(const std::string &samplerDirectory, const std::string &compilerCommand);
+    int returnValue() const;
+    std::string method() const;
+    size_t sampleCount() const;
+    std::string report(size_t topCount) const;
+    bool writeFoldedStacks(const std::string &filePath) const;
+
+private:
+    struct MappedRegion
+    {
+        uint64_t start;
+        uint64_t end;
+        uint64_t offset;
+        std::string path;
+    };
+
+    struct Frame
+    {
+        std::string function;
+        std::string location;
+    };
+
+    struct LoadSegment
+    {
+        uint64_t fileOffset;
+        uint64_t fileSize;
+        uint64_t virtualAddress;
+    };
+
+    std::string m_programPath;
+    std::vector<std::string> m_arguments;
+    unsigned int m_frequency;
+    int m_returnValue;
+    std::string m_method;
+    size_t m_lostSamples;
+    //Every stack runs from the sampled instruction outwards, and holds
+    //return addresses minus one, so they point into the calling line
+    std::vector<std::vector<uint64_t>> m_stacks;
+    std::vector<MappedRegion> m_regions;
+    std::map<uint64_t, Frame> m_frames;
+
+    bool runWithPerfEvents();
+    bool runWithPreloadedSampler(const std::string &samplerDirectory, const std::string &compilerCommand);
+    bool readSamplerOutput(const std::string &outputPath);
+    const MappedRegion *regionFor(uint64_t address) const;
+    void symbolize();
+    Frame frameFor(uint64_t address) const;
+
+    static bool readLoadSegments(const std::string &elfPath, std::vector<LoadSegment> &loadSegments);
+};
+
+#endif //EASYGPP_SAMPLINGPROFILER_H
@@ -0,0 +1,71 @@
+/***********************************************************************
+*    testrunner.h:                                                     *
+*    Runs a compiled program against input/expected output files       *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a TestRunner class. This      *
+*    class finds the NAME.in/NAME.out pairs in a directory, runs the   *
+*    program once per pair with NAME.in as its standard input, and     *
+*    compares what it prints with NAME.out as it is printed, with a    *
+*    time limit on each run                                            *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_TESTRUNNER_H
+#define EASYGPP_TESTRUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "processlauncher.h"
+
+struct TestCase
+{
+    std::string name;
+    std::string inputPath;
+    std::string expectedOutputPath;
+};
+
+struct TestResult
+{
+    bool passed;
+    bool timedOut;
+    int returnValue;
+    double wallSeconds;
+    long peakMemoryKilobytes;
+    //The first line (counted from 1) that differs, zero when none does
+    size_t differingLine;
+    std::string expectedLine;
+    std::string actualLine;
+    //Set when the program could not be run at all
+    std::string error;
+};
+
+class TestRunner
+{
+public:
+    TestRunner(const std::string &programPath, const std::vector<std::string> &arguments, const LaunchSettings &launchSettings, unsigned int timeoutSeconds);
+
+    //Sorted by name. Inputs without an expected output are left out, and
+    //returned in unpairedInputs
+    static std::vector<TestCase> findTestCases(const std::string &directoryPath, std::vector<std::string> &unpairedInputs);
+    //Lines are compared without their trailing whitespace, and blank lines
+    //at the end of either side are ignored
+    TestResult run(const TestCase &testCase) const;
+    static std::string describe(const TestCase &testCase, const TestResult &testResult);
+    static std::string summary(const std::vector<TestCase> &testCases, const std::vector<TestResult> &testResults);
+
+private:
+    std::string m_programPath;
+    std::vector<std::string> m_arguments;
+    ProcessLauncher m_processLauncher;
+    unsigned int m_timeoutSeconds;
+};
+
+#endif //EASYGPP_TESTRUNNER_H
@@ -0,0 +1,66 @@
+/***********************************************************************
+*    timereport.h:                                                     *
+*    Collects where the compiler spends its time for EasyGpp           *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a header file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the declarations of a TimeReport class. This      *
+*    class adds the compiler's own timing switches to every compile,   *
+*    gathers what each translation unit reported (clang's -ftime-trace *
+*    files, or gcc's -ftime-report and -H output), and turns it into a *
+*    ranked summary for the whole project and one merged Chrome trace  *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#ifndef EASYGPP_TIMEREPORT_H
+#define EASYGPP_TIMEREPORT_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+
+#include "buildscheduler.h"
+#include "chrometrace.h"
+
+class TimeReport
+{
+public:
+    explicit TimeReport(bool clangTrace);
+
+    std::string compileSwitches() const;
+    //Returns the compiler output, minus the lines the timing switches added
+    std::string addTranslationUnit(const std::string &description, const std::string &objectFile, const BuildResult &buildResult);
+    size_t translationUnitCount() const;
+    std::string summary(size_t topCount) const;
+    bool writeTrace(const std::string &filePath) const;
+
+private:
+    struct HeaderCost
+    {
+        double seconds;
+        size_t translationUnits;
+        size_t pulledInHeaders;
+    };
+
+    bool m_clangTrace;
+    double m_baseTime;
+    int m_nextThreadId;
+    ChromeTrace m_chromeTrace;
+    std::vector<std::pair<std::string, double>> m_phaseSeconds;
+    std::map<std::string, double> m_activitySeconds;
+    std::map<std::string, std::pair<double, size_t>> m_templateSeconds;
+    std::map<std::string, HeaderCost> m_headerCosts;
+    std::vector<std::pair<std::string, double>> m_unitSeconds;
+
+    void addPhaseSeconds(const std::string &phaseName, double seconds);
+    std::string readGccReport(const std::string &output, int threadId, double startMicroseconds);
+    void readClangTrace(const std::string &objectFile, int threadId, double startMicroseconds);
+};
+
+#endif //EASYGPP_TIMEREPORT_H
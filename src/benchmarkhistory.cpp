@@ -0,0 +1,226 @@
+/***********************************************************************
+*    benchmarkhistory.cpp:                                             *
+*    Keeps past benchmark runs and spots regressions for EasyGpp       *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a BenchmarkHistory class.   *
+*    This class stores the wall clock times of every benchmark of a    *
+*    project, tagged with what produced the executable (a hash of the  *
+*    sources, the compiler and a hash of the flags), and compares a    *
+*    new benchmark against the last comparable one with a Mann-Whitney *
+*    U test                                                            *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "benchmarkhistory.h"
+#include "benchmarkrunner.h"
+#include "easygpputilities.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace EasyGppUtilities;
+
+static const char *HISTORY_HEADER{"EasyGppBenchHistory\t1"};
+//Above this many combinations the exact distribution of U is replaced by
+//the normal approximation
+static const double EXACT_TEST_COMBINATION_LIMIT{1.0e6};
+
+BenchmarkHistory::BenchmarkHistory(const std::string &historyPath, size_t entryLimit) :
+    m_historyPath{historyPath},
+    m_entryLimit{entryLimit},
+    m_entries{}
+{
+
+}
+
+bool BenchmarkHistory::load()
+{
+    std::ifstream readFromFile{this->m_historyPath};
+    if (!readFromFile.is_open()) {
+        return false;
+    }
+    std::string line{""};
+    if ((!std::getline(readFromFile, line)) || (line != HISTORY_HEADER)) {
+        return false;
+    }
+    while (std::getline(readFromFile, line)) {
+        std::vector<std::string> fields{splitOnTabs(line)};
+        if ((fields[0] != "run") || (fields.size() != 8)) {
+            continue;
+        }
+        BenchmarkEntry benchmarkEntry{std::strtoll(fields[1].c_str(), nullptr, 10), fields[2], fields[3], fields[4], fields[5], fields[6], {}};
+        for (auto &it : splitOnCharacter(fields[7], ',')) {
+            char *numberEnd{nullptr};
+            double wallMilliseconds{std::strtod(it.c_str(), &numberEnd)};
+            if ((numberEnd != it.c_str()) && (*numberEnd == '\0')) {
+                benchmarkEntry.wallMilliseconds.emplace_back(wallMilliseconds);
+            }
+        }
+        if (!benchmarkEntry.wallMilliseconds.empty()) {
+            this->m_entries.emplace_back(benchmarkEntry);
+        }
+    }
+    return true;
+}
+
+bool BenchmarkHistory::save() const
+{
+    std::string temporaryPath{this->m_historyPath + ".tmp"};
+    std::ofstream writeToFile{temporaryPath};
+    if (!writeToFile.is_open()) {
+        return false;
+    }
+    writeToFile << HISTORY_HEADER << '\n';
+    writeToFile << std::setprecision(6) << std::fixed;
+    size_t firstEntry{(this->m_entries.size() > this->m_entryLimit) ? (this->m_entries.size() - this->m_entryLimit) : 0};
+    for (size_t i = firstEntry; i < this->m_entries.size(); i++) {
+        const BenchmarkEntry &benchmarkEntry = this->m_entries[i];
+        writeToFile << "run\t" << benchmarkEntry.timestamp << '\t' << benchmarkEntry.programName << '\t' << benchmarkEntry.sourceHash << '\t' 
+                    << benchmarkEntry.compiler << '\t' << benchmarkEntry.flagsHash << '\t' << benchmarkEntry.argumentsHash << '\t';
+        for (auto &it : benchmarkEntry.wallMilliseconds) {
+            writeToFile << ((&it == &benchmarkEntry.wallMilliseconds.front()) ? "" : ",") << it;
+        }
+        writeToFile << '\n';
+    }
+    writeToFile.close();
+    if (!writeToFile) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return (std::rename(temporaryPath.c_str(), this->m_historyPath.c_str()) == 0);
+}
+
+const BenchmarkEntry *BenchmarkHistory::baselineFor(const BenchmarkEntry &benchmarkEntry) const
+{
+    for (auto it = this->m_entries.rbegin(); it != this->m_entries.rend(); it++) {
+        if ((it->programName == benchmarkEntry.programName) && (it->compiler == benchmarkEntry.compiler) 
+            && (it->flagsHash == benchmarkEntry.flagsHash) && (it->argumentsHash == benchmarkEntry.argumentsHash)) {
+            return &(*it);
+        }
+    }
+    return nullptr;
+}
+
+void BenchmarkHistory::addEntry(const BenchmarkEntry &benchmarkEntry)
+{
+    this->m_entries.emplace_back(benchmarkEntry);
+}
+
+double BenchmarkHistory::mannWhitneyPValue(const std::vector<double> &firstSample, const std::vector<double> &secondSample)
+{
+    size_t firstCount{firstSample.size()};
+    size_t secondCount{secondSample.size()};
+    if ((firstCount == 0) || (secondCount == 0)) {
+        return 1.0;
+    }
+    //Rank both samples together, giving tied values their average rank
+    std::vector<std::pair<double, bool>> combined;
+    for (auto &it : firstSample) {
+        combined.emplace_back(it, true);
+    }
+    for (auto &it : secondSample) {
+        combined.emplace_back(it, false);
+    }
+    std::sort(combined.begin(), combined.end());
+    double firstRankSum{0.0};
+    double tieCorrection{0.0};
+    bool hasTies{false};
+    for (size_t i = 0; i < combined.size(); ) {
+        size_t tieEnd{i};
+        while ((tieEnd < combined.size()) && (combined[tieEnd].first == combined[i].first)) {
+            tieEnd++;
+        }
+        double averageRank{(static_cast<double>(i + 1) + static_cast<double>(tieEnd)) / 2.0};
+        for (size_t j = i; j < tieEnd; j++) {
+            if (combined[j].second) {
+                firstRankSum += averageRank;
+            }
+        }
+        double tieSize{static_cast<double>(tieEnd - i)};
+        if (tieSize > 1.0) {
+            hasTies = true;
+            tieCorrection += (tieSize * tieSize * tieSize - tieSize);
+        }
+        i = tieEnd;
+    }
+    double firstU{firstRankSum - static_cast<double>(firstCount * (firstCount + 1)) / 2.0};
+    double meanU{static_cast<double>(firstCount * secondCount) / 2.0};
+
+    double combinations{1.0};
+    for (size_t i = 1; i <= std::min(firstCount, secondCount); i++) {
+        combinations = combinations * static_cast<double>(firstCount + secondCount - std::min(firstCount, secondCount) + i) / static_cast<double>(i);
+    }
+    if ((!hasTies) && (combinations <= EXACT_TEST_COMBINATION_LIMIT)) {
+        //ways[n][u]: arrangements of the first n values of the first sample
+        //among the second sample that give a U of u (built up one row at a time)
+        size_t maximumU{firstCount * secondCount};
+        std::vector<std::vector<double>> ways(secondCount + 1, std::vector<double>(maximumU + 1, 0.0));
+        for (size_t j = 0; j <= secondCount; j++) {
+            ways[j][0] = 1.0;
+        }
+        for (size_t i = 1; i <= firstCount; i++) {
+            std::vector<std::vector<double>> nextWays(secondCount + 1, std::vector<double>(maximumU + 1, 0.0));
+            nextWays[0][0] = 1.0;
+            for (size_t j = 1; j <= secondCount; j++) {
+                for (size_t u = 0; u <= maximumU; u++) {
+                    nextWays[j][u] = nextWays[j - 1][u] + ((u >= j) ? ways[j][u - j] : 0.0);
+                }
+            }
+            ways = std::move(nextWays);
+        }
+        size_t observedU{static_cast<size_t>(std::llround(std::min(firstU, static_cast<double>(maximumU) - firstU)))};
+        double lowerTail{0.0};
+        for (size_t u = 0; u <= observedU; u++) {
+            lowerTail += ways[secondCount][u];
+        }
+        return std::min(1.0, 2.0 * lowerTail / combinations);
+    }
+    double totalCount{static_cast<double>(firstCount + secondCount)};
+    double varianceU{(static_cast<double>(firstCount * secondCount) / 12.0) * ((totalCount + 1.0) - tieCorrection / (totalCount * (totalCount - 1.0)))};
+    if (varianceU <= 0.0) {
+        return 1.0;
+    }
+    //Continuity corrected normal approximation
+    double zScore{(std::fabs(firstU - meanU) - 0.5) / std::sqrt(varianceU)};
+    if (zScore < 0.0) {
+        zScore = 0.0;
+    }
+    return std::min(1.0, std::erfc(zScore / std::sqrt(2.0)));
+}
+
+std::string BenchmarkHistory::compare(const BenchmarkEntry &baseline, const BenchmarkEntry &current, double significanceLevel)
+{
+    double baselineMedian{BenchmarkRunner::percentile(baseline.wallMilliseconds, 0.5)};
+    double currentMedian{BenchmarkRunner::percentile(current.wallMilliseconds, 0.5)};
+    double pValue{mannWhitneyPValue(baseline.wallMilliseconds, current.wallMilliseconds)};
+    double percentChange{(baselineMedian > 0.0) ? (100.0 * (currentMedian - baselineMedian) / baselineMedian) : 0.0};
+    std::stringstream returnStream;
+    returnStream << std::fixed << std::setprecision(1);
+    if (pValue < significanceLevel) {
+        returnStream << std::fabs(percentChange) << "% " << ((percentChange > 0.0) ? "slower" : "faster") << " than baseline (p<" << std::setprecision(2) << significanceLevel << ")";
+    } else {
+        returnStream << "No significant change from baseline (" << ((percentChange >= 0.0) ? "+" : "") << percentChange << "% median";
+    }
+    returnStream << std::setprecision(3);
+    if (pValue >= significanceLevel) {
+        returnStream << ", p=" << pValue << ")";
+    }
+    returnStream << std::endl << "    median " << currentMedian << "ms now, " << baselineMedian << "ms in the baseline (" << baseline.wallMilliseconds.size() << " runs";
+    returnStream << ((baseline.sourceHash == current.sourceHash) ? ", same sources" : ", sources have changed since") << ")" << std::endl;
+    if ((pValue >= significanceLevel) && ((baseline.wallMilliseconds.size() < 5) || (current.wallMilliseconds.size() < 5))) {
+        returnStream << "    NOTE: with fewer than 5 runs on either side, even a real change is unlikely to be significant" << std::endl;
+    }
+    return returnStream.str();
+}
@@ -0,0 +1,236 @@
+/***********************************************************************
+*    benchmarkrunner.cpp:                                              *
+*    Runs a compiled program repeatedly and measures it for EasyGpp    *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a BenchmarkRunner class.    *
+*    This class runs a program directly (no shell in between) a number *
+*    of times, collects the wall clock time and the resource usage the *
+*    kernel reports for each run, and summarizes them statistically    *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "benchmarkrunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <wordexp.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+BenchmarkRunner::BenchmarkRunner(const std::string &programPath, const std::vector<std::string> &arguments, const LaunchSettings &launchSettings) :
+    m_programPath{programPath},
+    m_arguments{arguments},
+    m_processLauncher{launchSettings}
+{
+
+}
+
+RunSample BenchmarkRunner::runOnce() const
+{
+    RunSample runSample{-1, 0.0, 0.0, 0.0, 0, 0, 0};
+    int nullDevice{open("/dev/null", O_RDWR | O_CLOEXEC)};
+    auto startTime = std::chrono::steady_clock::now();
+    pid_t childPid{this->m_processLauncher.spawn(this->m_programPath, this->m_arguments, nullDevice, nullDevice, nullDevice)};
+    if (childPid < 0) {
+        if (nullDevice >= 0) {
+            close(nullDevice);
+        }
+        return runSample;
+    }
+    struct rusage resourceUsage;
+    int returnValue{ProcessLauncher::waitForExit(childPid, &resourceUsage)};
+    if (returnValue < 0) {
+        if (nullDevice >= 0) {
+            close(nullDevice);
+        }
+        return runSample;
+    }
+    runSample.returnValue = returnValue;
+    runSample.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if (nullDevice >= 0) {
+        close(nullDevice);
+    }
+    runSample.userSeconds = static_cast<double>(resourceUsage.ru_utime.tv_sec) + static_cast<double>(resourceUsage.ru_utime.tv_usec) / 1000000.0;
+    runSample.systemSeconds = static_cast<double>(resourceUsage.ru_stime.tv_sec) + static_cast<double>(resourceUsage.ru_stime.tv_usec) / 1000000.0;
+    runSample.peakMemoryKilobytes = resourceUsage.ru_maxrss;
+    runSample.voluntaryContextSwitches = resourceUsage.ru_nvcsw;
+    runSample.involuntaryContextSwitches = resourceUsage.ru_nivcsw;
+    return runSample;
+}
+
+std::vector<RunSample> BenchmarkRunner::run(unsigned int warmupRuns, unsigned int timedRuns) const
+{
+    //Warmup runs fill the page cache and the CPU caches, and are thrown away
+    for (unsigned int i = 0; i < warmupRuns; i++) {
+        this->runOnce();
+    }
+    std::vector<RunSample> returnVector;
+    for (unsigned int i = 0; i < timedRuns; i++) {
+        returnVector.emplace_back(this->runOnce());
+    }
+    return returnVector;
+}
+
+bool BenchmarkRunner::splitArguments(const std::string &argumentString, std::vector<std::string> &arguments)
+{
+    //Split the way a shell would (quotes, escapes and $VARIABLES), but
+    //never run a command substitution
+    arguments.clear();
+    wordexp_t expandedWords;
+    if (wordexp(argumentString.c_str(), &expandedWords, WRDE_NOCMD) != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < expandedWords.we_wordc; i++) {
+        arguments.emplace_back(expandedWords.we_wordv[i]);
+    }
+    wordfree(&expandedWords);
+    return true;
+}
+
+double BenchmarkRunner::percentile(std::vector<double> sortedValues, double fraction)
+{
+    //Linear interpolation between the two closest ranks
+    if (sortedValues.empty()) {
+        return 0.0;
+    }
+    std::sort(sortedValues.begin(), sortedValues.end());
+    double rank{fraction * static_cast<double>(sortedValues.size() - 1)};
+    size_t lowerRank{static_cast<size_t>(std::floor(rank))};
+    size_t upperRank{std::min(lowerRank + 1, sortedValues.size() - 1)};
+    return sortedValues[lowerRank] + (rank - static_cast<double>(lowerRank)) * (sortedValues[upperRank] - sortedValues[lowerRank]);
+}
+
+double BenchmarkRunner::confidenceHalfWidth95(const std::vector<double> &values)
+{
+    //Two sided 95% critical values of Student's t for 1 to 30 degrees of
+    //freedom, past which the normal distribution's 1.96 is close enough
+    static const double T_CRITICAL_VALUES[]{12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (values.size() < 2) {
+        return 0.0;
+    }
+    size_t degreesOfFreedom{values.size() - 1};
+    double criticalValue{(degreesOfFreedom <= 30) ? T_CRITICAL_VALUES[degreesOfFreedom - 1] : 1.96};
+    return criticalValue * summarize(values).standardDeviation / std::sqrt(static_cast<double>(values.size()));
+}
+
+SampleSummary BenchmarkRunner::summarize(const std::vector<double> &values)
+{
+    SampleSummary sampleSummary{0.0, 0.0, 0.0, 0.0, 0.0, 0.0, {}};
+    if (values.empty()) {
+        return sampleSummary;
+    }
+    double total{0.0};
+    for (auto &it : values) {
+        total += it;
+    }
+    sampleSummary.mean = total / static_cast<double>(values.size());
+    double squaredDeviations{0.0};
+    for (auto &it : values) {
+        squaredDeviations += (it - sampleSummary.mean) * (it - sampleSummary.mean);
+    }
+    sampleSummary.standardDeviation = ((values.size() > 1) ? std::sqrt(squaredDeviations / static_cast<double>(values.size() - 1)) : 0.0);
+    sampleSummary.median = percentile(values, 0.5);
+    sampleSummary.percentile95 = percentile(values, 0.95);
+    sampleSummary.minimum = *std::min_element(values.begin(), values.end());
+    sampleSummary.maximum = *std::max_element(values.begin(), values.end());
+    double lowerQuartile{percentile(values, 0.25)};
+    double upperQuartile{percentile(values, 0.75)};
+    double fenceWidth{1.5 * (upperQuartile - lowerQuartile)};
+    for (size_t i = 0; i < values.size(); i++) {
+        if ((values[i] < lowerQuartile - fenceWidth) || (values[i] > upperQuartile + fenceWidth)) {
+            sampleSummary.outliers.emplace_back(i);
+        }
+    }
+    return sampleSummary;
+}
+
+std::string BenchmarkRunner::report(const std::vector<RunSample> &samples) const
+{
+    //A run that failed (or could not be started at all, which leaves every
+    //figure at zero) says nothing about how fast the program is, so only
+    //the runs that exited cleanly are summarized
+    std::vector<double> wallTimes;
+    std::vector<double> userTimes;
+    std::vector<double> systemTimes;
+    std::vector<double> peakMemories;
+    std::vector<double> voluntarySwitches;
+    std::vector<double> involuntarySwitches;
+    std::vector<size_t> runNumbers;
+    size_t failedRuns{0};
+    size_t unstartedRuns{0};
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (samples[i].returnValue != 0) {
+            failedRuns++;
+            unstartedRuns += ((samples[i].returnValue < 0) ? 1 : 0);
+            continue;
+        }
+        wallTimes.emplace_back(samples[i].wallSeconds * 1000.0);
+        userTimes.emplace_back(samples[i].userSeconds * 1000.0);
+        systemTimes.emplace_back(samples[i].systemSeconds * 1000.0);
+        peakMemories.emplace_back(static_cast<double>(samples[i].peakMemoryKilobytes));
+        voluntarySwitches.emplace_back(static_cast<double>(samples[i].voluntaryContextSwitches));
+        involuntarySwitches.emplace_back(static_cast<double>(samples[i].involuntaryContextSwitches));
+        runNumbers.emplace_back(i + 1);
+    }
+    std::stringstream returnStream;
+    returnStream << std::fixed << std::setprecision(3);
+    returnStream << "Benchmark of " << this->m_programPath << " (" << samples.size() << ((samples.size() == 1) ? " run" : " runs") << "):" << std::endl;
+    if (!wallTimes.empty()) {
+        returnStream << "    " << std::left << std::setw(28) << "" << std::right;
+        for (auto &it : {"mean", "median", "p95", "stddev", "min", "max"}) {
+            returnStream << std::setw(12) << it;
+        }
+        returnStream << std::endl;
+        auto addRow = [&returnStream](const std::string &rowName, const SampleSummary &sampleSummary) {
+            returnStream << "    " << std::left << std::setw(28) << rowName << std::right
+                         << std::setw(12) << sampleSummary.mean << std::setw(12) << sampleSummary.median << std::setw(12) << sampleSummary.percentile95
+                         << std::setw(12) << sampleSummary.standardDeviation << std::setw(12) << sampleSummary.minimum << std::setw(12) << sampleSummary.maximum << std::endl;
+        };
+        SampleSummary wallSummary{summarize(wallTimes)};
+        addRow("wall time (ms)", wallSummary);
+        addRow("user CPU (ms)", summarize(userTimes));
+        addRow("system CPU (ms)", summarize(systemTimes));
+        addRow("peak RSS (KB)", summarize(peakMemories));
+        addRow("voluntary switches", summarize(voluntarySwitches));
+        addRow("involuntary switches", summarize(involuntarySwitches));
+        if (!wallSummary.outliers.empty()) {
+            returnStream << std::endl << "    " << wallSummary.outliers.size() << ((wallSummary.outliers.size() == 1) ? " run was an outlier" : " runs were outliers") << " by wall time (run";
+            for (auto &it : wallSummary.outliers) {
+                returnStream << ((&it == &wallSummary.outliers.front()) ? " " : ", ") << runNumbers[it] << " at " << wallTimes[it] << "ms";
+            }
+            returnStream << "), the system may have been busy" << std::endl;
+        }
+    }
+    if (failedRuns != 0) {
+        if (!wallTimes.empty()) {
+            returnStream << std::endl;
+        }
+        returnStream << "    WARNING: " << failedRuns << " of " << samples.size() << " runs failed";
+        if (unstartedRuns == failedRuns) {
+            returnStream << " (could not be started)";
+        } else if (unstartedRuns != 0) {
+            returnStream << " (" << unstartedRuns << " could not be started, the rest exited with a non-zero return value)";
+        } else {
+            returnStream << " (exited with a non-zero return value)";
+        }
+        returnStream << ", and " << ((failedRuns == 1) ? "is" : "are") << " left out of the figures" << ((wallTimes.empty()) ? ", so there are none" : " above") << std::endl;
+    }
+    return returnStream.str();
+}
@@ -0,0 +1,287 @@
+/***********************************************************************
+*    buildmanifest.cpp:                                                *
+*    Tracks what is needed to decide whether objects are stale         *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a BuildManifest class. This *
+*    class records, for every object file, a fingerprint of the command*
+*    that produced it and the modification time and size of every file *
+*    the compiler reported (via -MMD) as an input, so that an unchanged*
+*    project can be detected using nothing but stat() calls            *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "buildmanifest.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+using namespace EasyGppUtilities;
+
+static const char *MANIFEST_HEADER{"EasyGppManifest\t1"};
+
+BuildManifest::BuildManifest(const std::string &manifestPath) :
+    m_manifestPath{manifestPath},
+    m_configurationHash{0},
+    m_linkHash{0},
+    m_executableStamp{FileStamp{-1, -1}},
+    m_libraries{std::set<std::string>{}},
+    m_precompiledHeader{""},
+    m_splitUnityBatches{std::set<std::string>{}},
+    m_objects{std::map<std::string, ObjectEntry>{}}
+{
+
+}
+
+bool BuildManifest::load()
+{
+    std::ifstream readFromFile{this->m_manifestPath};
+    if (!readFromFile.is_open()) {
+        return false;
+    }
+    std::string line{""};
+    if ((!std::getline(readFromFile, line)) || (line != MANIFEST_HEADER)) {
+        return false;
+    }
+    ObjectEntry *currentObject{nullptr};
+    while (std::getline(readFromFile, line)) {
+        std::vector<std::string> fields{splitOnTabs(line)};
+        if ((fields[0] == "configuration") && (fields.size() == 2)) {
+            fromHexString(fields[1], this->m_configurationHash);
+        } else if ((fields[0] == "link") && (fields.size() == 4)) {
+            if ((!fromHexString(fields[1], this->m_linkHash)) || (!parseFileStamp(fields[2], fields[3], this->m_executableStamp))) {
+                this->m_linkHash = 0;
+            }
+        } else if ((fields[0] == "library") && (fields.size() == 2)) {
+            this->m_libraries.emplace(fields[1]);
+        } else if ((fields[0] == "precompiledheader") && (fields.size() == 2)) {
+            this->m_precompiledHeader = fields[1];
+        } else if ((fields[0] == "splitunitybatch") && (fields.size() == 2)) {
+            this->m_splitUnityBatches.emplace(fields[1]);
+        } else if ((fields[0] == "object") && (fields.size() == 5)) {
+            ObjectEntry objectEntry{0, FileStamp{-1, -1}, {}};
+            if ((!fromHexString(fields[2], objectEntry.commandHash)) || (!parseFileStamp(fields[3], fields[4], objectEntry.objectStamp))) {
+                currentObject = nullptr;
+                continue;
+            }
+            currentObject = &(this->m_objects[fields[1]] = objectEntry);
+        } else if ((fields[0] == "dependency") && (fields.size() == 4) && (currentObject)) {
+            FileStamp fileStamp{-1, -1};
+            parseFileStamp(fields[2], fields[3], fileStamp);
+            currentObject->dependencies.emplace_back(fields[1], fileStamp);
+        }
+    }
+    return true;
+}
+
+bool BuildManifest::save() const
+{
+    //Write to a temporary file first, so an interrupted build never leaves a
+    //half written manifest that claims objects are up to date
+    std::string temporaryPath{this->m_manifestPath + ".tmp"};
+    std::ofstream writeToFile{temporaryPath};
+    if (!writeToFile.is_open()) {
+        return false;
+    }
+    writeToFile << MANIFEST_HEADER << '\n';
+    writeToFile << "configuration\t" << toHexString(this->m_configurationHash) << '\n';
+    writeToFile << "link\t" << toHexString(this->m_linkHash) << '\t' << this->m_executableStamp.modifiedTime << '\t' << this->m_executableStamp.size << '\n';
+    for (auto &it : this->m_libraries) {
+        writeToFile << "library\t" << it << '\n';
+    }
+    if (this->m_precompiledHeader != "") {
+        writeToFile << "precompiledheader\t" << this->m_precompiledHeader << '\n';
+    }
+    for (auto &it : this->m_splitUnityBatches) {
+        writeToFile << "splitunitybatch\t" << it << '\n';
+    }
+    for (auto &it : this->m_objects) {
+        writeToFile << "object\t" << it.first << '\t' << toHexString(it.second.commandHash) << '\t' 
+                    << it.second.objectStamp.modifiedTime << '\t' << it.second.objectStamp.size << '\n';
+        for (auto &dependencyIt : it.second.dependencies) {
+            writeToFile << "dependency\t" << dependencyIt.first << '\t' 
+                        << dependencyIt.second.modifiedTime << '\t' << dependencyIt.second.size << '\n';
+        }
+    }
+    writeToFile.close();
+    if (!writeToFile) {
+        return false;
+    }
+    return (std::rename(temporaryPath.c_str(), this->m_manifestPath.c_str()) == 0);
+}
+
+bool BuildManifest::objectIsUpToDate(const std::string &objectPath, uint64_t commandHash) const
+{
+    auto foundObject = this->m_objects.find(objectPath);
+    if ((foundObject == this->m_objects.end()) || (foundObject->second.commandHash != commandHash)) {
+        return false;
+    }
+    FileStamp fileStamp{-1, -1};
+    if ((!getFileStamp(objectPath, fileStamp)) || (fileStamp != foundObject->second.objectStamp)) {
+        return false;
+    }
+    if (foundObject->second.dependencies.empty()) {
+        return false;
+    }
+    for (auto &it : foundObject->second.dependencies) {
+        if ((!getFileStamp(it.first, fileStamp)) || (fileStamp != it.second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BuildManifest::recordObject(const std::string &objectPath,
+                                 uint64_t commandHash,
+                                 const std::string &dependencyFilePath,
+                                 long long compileStartTime)
+{
+    ObjectEntry objectEntry{commandHash, FileStamp{-1, -1}, {}};
+    if (!getFileStamp(objectPath, objectEntry.objectStamp)) {
+        this->m_objects.erase(objectPath);
+        return false;
+    }
+    std::vector<std::string> dependencies{parseDependencyFile(dependencyFilePath)};
+    if (dependencies.empty()) {
+        this->m_objects.erase(objectPath);
+        return false;
+    }
+    for (auto &it : dependencies) {
+        FileStamp fileStamp{-1, -1};
+        getFileStamp(it, fileStamp);
+        //An input touched while it was being compiled may not be reflected
+        //in the object, so store a stamp that can never match
+        if (fileStamp.modifiedTime >= compileStartTime) {
+            fileStamp = FileStamp{-1, -1};
+        }
+        objectEntry.dependencies.emplace_back(it, fileStamp);
+    }
+    this->m_objects[objectPath] = objectEntry;
+    return true;
+}
+
+void BuildManifest::forgetObjectsExcept(const std::set<std::string> &objectPaths)
+{
+    for (auto it = this->m_objects.begin(); it != this->m_objects.end(); ) {
+        if (objectPaths.find(it->first) == objectPaths.end()) {
+            it = this->m_objects.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+bool BuildManifest::linkIsUpToDate(const std::string &executablePath, uint64_t linkHash) const
+{
+    if (this->m_linkHash != linkHash) {
+        return false;
+    }
+    FileStamp fileStamp{-1, -1};
+    return ((getFileStamp(executablePath, fileStamp)) && (fileStamp == this->m_executableStamp));
+}
+
+void BuildManifest::recordLink(const std::string &executablePath, uint64_t linkHash)
+{
+    if (getFileStamp(executablePath, this->m_executableStamp)) {
+        this->m_linkHash = linkHash;
+    } else {
+        this->m_linkHash = 0;
+    }
+}
+
+uint64_t BuildManifest::configurationHash() const
+{
+    return this->m_configurationHash;
+}
+
+void BuildManifest::setConfigurationHash(uint64_t configurationHash)
+{
+    this->m_configurationHash = configurationHash;
+}
+
+const std::set<std::string> &BuildManifest::libraries() const
+{
+    return this->m_libraries;
+}
+
+void BuildManifest::setLibraries(const std::set<std::string> &libraries)
+{
+    this->m_libraries = libraries;
+}
+
+const std::string &BuildManifest::precompiledHeader() const
+{
+    return this->m_precompiledHeader;
+}
+
+void BuildManifest::setPrecompiledHeader(const std::string &precompiledHeader)
+{
+    this->m_precompiledHeader = precompiledHeader;
+}
+
+const std::set<std::string> &BuildManifest::splitUnityBatches() const
+{
+    return this->m_splitUnityBatches;
+}
+
+void BuildManifest::setSplitUnityBatches(const std::set<std::string> &splitUnityBatches)
+{
+    this->m_splitUnityBatches = splitUnityBatches;
+}
+
+std::vector<std::string> BuildManifest::parseDependencyFile(const std::string &dependencyFilePath)
+{
+    //Make style rule as written by -MMD: "target.o: first.cpp header.h \"
+    //with "\ " escaping spaces inside of file names
+    std::ifstream readFromFile{dependencyFilePath};
+    std::vector<std::string> returnVector;
+    if (!readFromFile.is_open()) {
+        return returnVector;
+    }
+    std::stringstream fileContents;
+    fileContents << readFromFile.rdbuf();
+    std::string contents{fileContents.str()};
+    size_t position{contents.find(": ")};
+    if (position == std::string::npos) {
+        return returnVector;
+    }
+    position += 2;
+    std::string currentFile{""};
+    for (; position < contents.length(); position++) {
+        char currentChar{contents[position]};
+        if ((currentChar == '\\') && (position + 1 < contents.length())) {
+            char nextChar{contents[position + 1]};
+            if ((nextChar == '\n') || (nextChar == '\r')) {
+                position++;
+                continue;
+            } else if (nextChar == ' ') {
+                currentFile += ' ';
+                position++;
+                continue;
+            }
+        }
+        if ((currentChar == ' ') || (currentChar == '\n') || (currentChar == '\r') || (currentChar == '\t')) {
+            if (!currentFile.empty()) {
+                returnVector.emplace_back(currentFile);
+                currentFile.clear();
+            }
+            //-MMD only writes one rule, a second line (eg from -MP) ends it
+            if ((currentChar == '\n') && (position + 1 < contents.length()) && (contents[position + 1] != ' ')) {
+                break;
+            }
+        } else {
+            currentFile += currentChar;
+        }
+    }
+    if (!currentFile.empty()) {
+        returnVector.emplace_back(currentFile);
+    }
+    return returnVector;
+}
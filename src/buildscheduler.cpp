@@ -0,0 +1,154 @@
+/***********************************************************************
+*    buildscheduler.cpp:                                               *
+*    Runs independent compiler invocations in parallel for EasyGpp     *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a BuildScheduler class. This*
+*    class runs a list of shell commands (usually one compiler         *
+*    invocation per translation unit) across a fixed number of worker  *
+*    threads, buffering everything each command prints so that the     *
+*    diagnostics can be reported in order once the command finishes    *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "buildscheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+BuildScheduler::BuildScheduler(unsigned int jobCount) :
+    m_jobCount{(jobCount == 0) ? defaultJobCount() : jobCount}
+{
+
+}
+
+unsigned int BuildScheduler::jobCount() const
+{
+    return this->m_jobCount;
+}
+
+unsigned int BuildScheduler::defaultJobCount()
+{
+    long onlineProcessors{sysconf(_SC_NPROCESSORS_ONLN)};
+    if (onlineProcessors > 0) {
+        return static_cast<unsigned int>(onlineProcessors);
+    }
+    unsigned int hardwareThreads{std::thread::hardware_concurrency()};
+    return ((hardwareThreads == 0) ? 1 : hardwareThreads);
+}
+
+BuildResult BuildScheduler::runCommand(const std::string &command)
+{
+    BuildResult buildResult{-1, "", 0.0, 0, false, 0.0};
+    auto startTime = std::chrono::steady_clock::now();
+    int outputPipe[2];
+    //O_CLOEXEC keeps the read end from leaking into sibling jobs forked by
+    //other workers, which would otherwise hold the pipe open past our EOF
+    if (pipe2(outputPipe, O_CLOEXEC) != 0) {
+        buildResult.output = "ERROR: unable to create pipe for command: " + command + "\n";
+        return buildResult;
+    }
+    pid_t childPid{fork()};
+    if (childPid < 0) {
+        close(outputPipe[0]);
+        close(outputPipe[1]);
+        buildResult.output = "ERROR: unable to fork for command: " + command + "\n";
+        return buildResult;
+    } else if (childPid == 0) {
+        dup2(outputPipe[1], STDOUT_FILENO);
+        dup2(outputPipe[1], STDERR_FILENO);
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    close(outputPipe[1]);
+    char readBuffer[4096];
+    while (true) {
+        ssize_t bytesRead{read(outputPipe[0], readBuffer, sizeof(readBuffer))};
+        if (bytesRead > 0) {
+            buildResult.output.append(readBuffer, static_cast<size_t>(bytesRead));
+        } else if ((bytesRead < 0) && (errno == EINTR)) {
+            continue;
+        } else {
+            break;
+        }
+    }
+    close(outputPipe[0]);
+    int status{0};
+    struct rusage resourceUsage;
+    while (wait4(childPid, &status, 0, &resourceUsage) < 0) {
+        if (errno != EINTR) {
+            buildResult.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            return buildResult;
+        }
+    }
+    buildResult.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    buildResult.peakMemoryKilobytes = resourceUsage.ru_maxrss;
+    if (WIFEXITED(status)) {
+        buildResult.returnValue = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        buildResult.returnValue = 128 + WTERMSIG(status);
+    }
+    return buildResult;
+}
+
+std::vector<BuildResult> BuildScheduler::run(const std::vector<BuildJob> &jobs,
+                                             const std::function<void(size_t, const BuildJob &, const BuildResult &)> &onJobFinished) const
+{
+    std::vector<BuildResult> results(jobs.size(), BuildResult{-1, "", 0.0, 0, false, 0.0});
+    std::vector<bool> finished(jobs.size(), false);
+    std::atomic<size_t> nextJob{0};
+    std::mutex finishedMutex;
+    std::condition_variable finishedCondition;
+
+    auto worker = [&]() {
+        while (true) {
+            size_t jobIndex{nextJob++};
+            if (jobIndex >= jobs.size()) {
+                return;
+            }
+            double startTime{std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count()};
+            BuildResult buildResult{(jobs[jobIndex].action) ? jobs[jobIndex].action() : runCommand(jobs[jobIndex].command)};
+            buildResult.startTime = startTime;
+            std::lock_guard<std::mutex> lock{finishedMutex};
+            results[jobIndex] = std::move(buildResult);
+            finished[jobIndex] = true;
+            finishedCondition.notify_all();
+        }
+    };
+
+    size_t workerCount{std::min<size_t>(this->m_jobCount, jobs.size())};
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(worker);
+    }
+    for (size_t i = 0; i < jobs.size(); i++) {
+        std::unique_lock<std::mutex> lock{finishedMutex};
+        finishedCondition.wait(lock, [&]() { return finished[i]; });
+        lock.unlock();
+        if (onJobFinished) {
+            onJobFinished(i, jobs[i], results[i]);
+        }
+    }
+    for (auto &it : workers) {
+        it.join();
+    }
+    return results;
+}
@@ -0,0 +1,343 @@
+/***********************************************************************
+*    cacheprofile.cpp:                                                 *
+*    Reads and compares cachegrind profiles for EasyGpp                *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a CacheProfile class. This  *
+*    class reads the output of valgrind's cachegrind tool, adds up the *
+*    instruction counts and cache misses by function and by source     *
+*    line, and reports them sorted by an estimated cost. A profile can *
+*    be saved and compared with the one from the previous build        *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "cacheprofile.h"
+#include "easygpputilities.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+
+#include <unistd.h>
+
+using namespace EasyGppUtilities;
+
+static const char *PROFILE_HEADER{"EasyGppCacheProfile\t1"};
+static const char *UNKNOWN_NAME{"???"};
+
+namespace {
+    bool startsWith(const std::string &stringToCheck, const std::string &prefix)
+    {
+        return (stringToCheck.compare(0, prefix.length(), prefix) == 0);
+    }
+
+    //callgrind style name compression: "(3) name" the first time, "(3)" after
+    std::string expandName(const std::string &name, std::map<std::string, std::string> &compressedNames)
+    {
+        if ((name.empty()) || (name[0] != '(')) {
+            return name;
+        }
+        size_t closingParenthesis{name.find(')')};
+        if (closingParenthesis == std::string::npos) {
+            return name;
+        }
+        std::string nameIndex{name.substr(0, closingParenthesis + 1)};
+        if (closingParenthesis + 1 < name.length()) {
+            std::string expandedName{name.substr(name.find_first_not_of(' ', closingParenthesis + 1))};
+            compressedNames[nameIndex] = expandedName;
+            return expandedName;
+        }
+        auto foundName = compressedNames.find(nameIndex);
+        return ((foundName == compressedNames.end()) ? name : foundName->second);
+    }
+
+    std::string countsFields(const CacheCounts &cacheCounts)
+    {
+        std::stringstream returnStream;
+        returnStream << cacheCounts.instructions << '\t' << cacheCounts.dataAccesses << '\t' << cacheCounts.level1DataMisses << '\t'
+                     << cacheCounts.lastLevelDataMisses << '\t' << cacheCounts.level1InstructionMisses << '\t' << cacheCounts.lastLevelInstructionMisses;
+        return returnStream.str();
+    }
+
+    std::string withThousands(uint64_t value)
+    {
+        std::string returnString{std::to_string(value)};
+        for (int i = static_cast<int>(returnString.length()) - 3; i > 0; i -= 3) {
+            returnString.insert(static_cast<size_t>(i), ",");
+        }
+        return returnString;
+    }
+
+    std::string shortened(const std::string &name, size_t maximumLength)
+    {
+        return ((name.length() > maximumLength) ? (name.substr(0, maximumLength - 3) + "...") : name);
+    }
+}
+
+CacheProfile::CacheProfile() :
+    m_totals{0, 0, 0, 0, 0, 0},
+    m_functions{},
+    m_lines{}
+{
+
+}
+
+bool CacheProfile::empty() const
+{
+    return this->m_functions.empty();
+}
+
+uint64_t CacheProfile::estimatedCost(const CacheCounts &cacheCounts)
+{
+    return cacheCounts.instructions + 10 * (cacheCounts.level1DataMisses + cacheCounts.level1InstructionMisses)
+                                    + 100 * (cacheCounts.lastLevelDataMisses + cacheCounts.lastLevelInstructionMisses);
+}
+
+void CacheProfile::addCounts(CacheCounts &total, const CacheCounts &addition)
+{
+    total.instructions += addition.instructions;
+    total.dataAccesses += addition.dataAccesses;
+    total.level1DataMisses += addition.level1DataMisses;
+    total.lastLevelDataMisses += addition.lastLevelDataMisses;
+    total.level1InstructionMisses += addition.level1InstructionMisses;
+    total.lastLevelInstructionMisses += addition.lastLevelInstructionMisses;
+}
+
+bool CacheProfile::readCachegrindOutput(const std::string &outputPath)
+{
+    std::ifstream readFromFile{outputPath};
+    if (!readFromFile.is_open()) {
+        return false;
+    }
+    this->m_totals = CacheCounts{0, 0, 0, 0, 0, 0};
+    this->m_functions.clear();
+    this->m_lines.clear();
+    char workingDirectory[4096];
+    std::string currentDirectory{(getcwd(workingDirectory, sizeof(workingDirectory)) != nullptr) ? (static_cast<std::string>(workingDirectory) + "/") : ""};
+    std::vector<std::string> eventNames;
+    std::map<std::string, std::string> compressedFiles;
+    std::map<std::string, std::string> compressedFunctions;
+    std::string currentFile{UNKNOWN_NAME};
+    std::string currentFunction{UNKNOWN_NAME};
+    std::string line{""};
+    while (std::getline(readFromFile, line)) {
+        if (startsWith(line, "events:")) {
+            std::stringstream eventStream{line.substr(std::string{"events:"}.length())};
+            std::string eventName{""};
+            while (eventStream >> eventName) {
+                eventNames.emplace_back(eventName);
+            }
+        } else if ((startsWith(line, "fl=")) || (startsWith(line, "fi=")) || (startsWith(line, "fe="))) {
+            //fi= and fe= switch to an inlined file without leaving the function
+            currentFile = expandName(line.substr(3), compressedFiles);
+            if ((currentDirectory != "") && (startsWith(currentFile, currentDirectory))) {
+                currentFile.erase(0, currentDirectory.length());
+            }
+        } else if (startsWith(line, "fn=")) {
+            currentFunction = expandName(line.substr(3), compressedFunctions);
+        } else if ((!line.empty()) && (std::isdigit(static_cast<unsigned char>(line[0])))) {
+            //A line number, then one count per event (missing trailing counts are zero)
+            std::stringstream countStream{line};
+            unsigned long long lineNumber{0};
+            countStream >> lineNumber;
+            CacheCounts cacheCounts{0, 0, 0, 0, 0, 0};
+            unsigned long long eventCount{0};
+            for (size_t i = 0; (i < eventNames.size()) && (countStream >> eventCount); i++) {
+                const std::string &eventName = eventNames[i];
+                if (eventName == "Ir") {
+                    cacheCounts.instructions += eventCount;
+                } else if ((eventName == "Dr") || (eventName == "Dw")) {
+                    cacheCounts.dataAccesses += eventCount;
+                } else if ((eventName == "D1mr") || (eventName == "D1mw")) {
+                    cacheCounts.level1DataMisses += eventCount;
+                } else if ((eventName == "DLmr") || (eventName == "DLmw")) {
+                    cacheCounts.lastLevelDataMisses += eventCount;
+                } else if (eventName == "I1mr") {
+                    cacheCounts.level1InstructionMisses += eventCount;
+                } else if (eventName == "ILmr") {
+                    cacheCounts.lastLevelInstructionMisses += eventCount;
+                }
+            }
+            addCounts(this->m_totals, cacheCounts);
+            addCounts(this->m_functions[currentFunction], cacheCounts);
+            if (currentFile != UNKNOWN_NAME) {
+                addCounts(this->m_lines[currentFile + ":" + std::to_string(lineNumber)], cacheCounts);
+            }
+        }
+    }
+    return !eventNames.empty();
+}
+
+bool CacheProfile::load(const std::string &profilePath)
+{
+    std::ifstream readFromFile{profilePath};
+    if (!readFromFile.is_open()) {
+        return false;
+    }
+    std::string line{""};
+    if ((!std::getline(readFromFile, line)) || (line != PROFILE_HEADER)) {
+        return false;
+    }
+    this->m_totals = CacheCounts{0, 0, 0, 0, 0, 0};
+    this->m_functions.clear();
+    this->m_lines.clear();
+    while (std::getline(readFromFile, line)) {
+        std::vector<std::string> fields{splitOnTabs(line)};
+        if ((fields.size() != 8) || ((fields[0] != "function") && (fields[0] != "line"))) {
+            continue;
+        }
+        CacheCounts cacheCounts{std::strtoull(fields[2].c_str(), nullptr, 10), std::strtoull(fields[3].c_str(), nullptr, 10),
+                                std::strtoull(fields[4].c_str(), nullptr, 10), std::strtoull(fields[5].c_str(), nullptr, 10),
+                                std::strtoull(fields[6].c_str(), nullptr, 10), std::strtoull(fields[7].c_str(), nullptr, 10)};
+        if (fields[0] == "function") {
+            this->m_functions[fields[1]] = cacheCounts;
+            addCounts(this->m_totals, cacheCounts);
+        } else {
+            this->m_lines[fields[1]] = cacheCounts;
+        }
+    }
+    return true;
+}
+
+bool CacheProfile::save(const std::string &profilePath) const
+{
+    std::string temporaryPath{profilePath + ".tmp"};
+    std::ofstream writeToFile{temporaryPath};
+    if (!writeToFile.is_open()) {
+        return false;
+    }
+    writeToFile << PROFILE_HEADER << '\n';
+    for (auto &it : this->m_functions) {
+        writeToFile << "function\t" << it.first << '\t' << countsFields(it.second) << '\n';
+    }
+    for (auto &it : this->m_lines) {
+        writeToFile << "line\t" << it.first << '\t' << countsFields(it.second) << '\n';
+    }
+    writeToFile.close();
+    if (!writeToFile) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return (std::rename(temporaryPath.c_str(), profilePath.c_str()) == 0);
+}
+
+std::vector<std::pair<std::string, CacheCounts>> CacheProfile::sortedByCost(const std::map<std::string, CacheCounts> &countsMap)
+{
+    std::vector<std::pair<std::string, CacheCounts>> returnVector{countsMap.begin(), countsMap.end()};
+    std::stable_sort(returnVector.begin(), returnVector.end(), [](const std::pair<std::string, CacheCounts> &lhs, const std::pair<std::string, CacheCounts> &rhs) {
+        return (estimatedCost(lhs.second) > estimatedCost(rhs.second));
+    });
+    return returnVector;
+}
+
+std::string CacheProfile::missRate(uint64_t misses, uint64_t accesses)
+{
+    if (accesses == 0) {
+        return "-";
+    }
+    std::stringstream returnStream;
+    returnStream << std::fixed << std::setprecision(2) << 100.0 * static_cast<double>(misses) / static_cast<double>(accesses) << "%";
+    return returnStream.str();
+}
+
+std::string CacheProfile::report(size_t topCount) const
+{
+    std::stringstream returnStream;
+    uint64_t totalCost{estimatedCost(this->m_totals)};
+    returnStream << "Cache profile: " << withThousands(this->m_totals.instructions) << " instructions, " << withThousands(this->m_totals.dataAccesses) << " data accesses, D1 miss rate "
+                 << missRate(this->m_totals.level1DataMisses, this->m_totals.dataAccesses) << ", LL miss rate " << missRate(this->m_totals.lastLevelDataMisses, this->m_totals.dataAccesses) << std::endl;
+    if (this->m_totals.dataAccesses == 0) {
+        returnStream << "    NOTE: no data accesses were counted, cachegrind may have run without --cache-sim=yes" << std::endl;
+    }
+    auto addTable = [&](const std::string &title, const std::string &nameHeading, const std::map<std::string, CacheCounts> &countsMap) {
+        std::vector<std::pair<std::string, CacheCounts>> sortedCounts{sortedByCost(countsMap)};
+        returnStream << std::endl << title << " (sorted by estimated cycles, Ir + 10 x L1 misses + 100 x LL misses):" << std::endl;
+        returnStream << "    " << std::setw(8) << "cost" << std::setw(16) << "Ir" << std::setw(16) << "D refs" << std::setw(10) << "D1 miss" << std::setw(10) << "LL miss" << "  " << nameHeading << std::endl;
+        for (size_t i = 0; (i < sortedCounts.size()) && (i < topCount); i++) {
+            const CacheCounts &cacheCounts = sortedCounts[i].second;
+            std::stringstream costShare;
+            costShare << std::fixed << std::setprecision(1) << ((totalCost == 0) ? 0.0 : (100.0 * static_cast<double>(estimatedCost(cacheCounts)) / static_cast<double>(totalCost))) << "%";
+            returnStream << "    " << std::setw(8) << costShare.str() << std::setw(16) << withThousands(cacheCounts.instructions) << std::setw(16) << withThousands(cacheCounts.dataAccesses)
+                         << std::setw(10) << missRate(cacheCounts.level1DataMisses, cacheCounts.dataAccesses) << std::setw(10) << missRate(cacheCounts.lastLevelDataMisses, cacheCounts.dataAccesses)
+                         << "  " << shortened(sortedCounts[i].first, 60) << std::endl;
+        }
+        if (sortedCounts.size() > topCount) {
+            returnStream << "    (" << sortedCounts.size() - topCount << " more not shown)" << std::endl;
+        }
+    };
+    addTable("By function", "function", this->m_functions);
+    addTable("By line", "line", this->m_lines);
+    return returnStream.str();
+}
+
+std::string CacheProfile::compare(const CacheProfile &previous, size_t topCount) const
+{
+    std::stringstream returnStream;
+    auto percentChange = [](uint64_t before, uint64_t after) {
+        std::stringstream changeStream;
+        if (before == 0) {
+            changeStream << ((after == 0) ? "unchanged" : "new");
+        } else {
+            double change{100.0 * (static_cast<double>(after) - static_cast<double>(before)) / static_cast<double>(before)};
+            changeStream << std::fixed << std::setprecision(1) << ((change >= 0.0) ? "+" : "") << change << "%";
+        }
+        return changeStream.str();
+    };
+    returnStream << "Compared with the previous build:" << std::endl;
+    returnStream << "    " << std::left << std::setw(20) << "instructions" << std::right << std::setw(20) << withThousands(previous.m_totals.instructions) << " -> " << std::setw(20)
+                 << withThousands(this->m_totals.instructions) << "  (" << percentChange(previous.m_totals.instructions, this->m_totals.instructions) << ")" << std::endl;
+    returnStream << "    " << std::left << std::setw(20) << "estimated cycles" << std::right << std::setw(20) << withThousands(estimatedCost(previous.m_totals)) << " -> " << std::setw(20)
+                 << withThousands(estimatedCost(this->m_totals)) << "  (" << percentChange(estimatedCost(previous.m_totals), estimatedCost(this->m_totals)) << ")" << std::endl;
+    returnStream << "    " << std::left << std::setw(20) << "D1 miss rate" << std::right << std::setw(20) << missRate(previous.m_totals.level1DataMisses, previous.m_totals.dataAccesses) << " -> "
+                 << std::setw(20) << missRate(this->m_totals.level1DataMisses, this->m_totals.dataAccesses) << std::endl;
+    returnStream << "    " << std::left << std::setw(20) << "LL miss rate" << std::right << std::setw(20) << missRate(previous.m_totals.lastLevelDataMisses, previous.m_totals.dataAccesses) << " -> "
+                 << std::setw(20) << missRate(this->m_totals.lastLevelDataMisses, this->m_totals.dataAccesses) << std::endl;
+
+    //Functions ordered by how much their estimated cost moved, either way
+    std::set<std::string> functionNames;
+    for (auto &it : previous.m_functions) {
+        functionNames.emplace(it.first);
+    }
+    for (auto &it : this->m_functions) {
+        functionNames.emplace(it.first);
+    }
+    std::vector<std::pair<std::string, std::pair<uint64_t, uint64_t>>> changes;
+    for (auto &it : functionNames) {
+        auto foundPrevious = previous.m_functions.find(it);
+        auto foundCurrent = this->m_functions.find(it);
+        uint64_t previousCost{(foundPrevious == previous.m_functions.end()) ? 0 : estimatedCost(foundPrevious->second)};
+        uint64_t currentCost{(foundCurrent == this->m_functions.end()) ? 0 : estimatedCost(foundCurrent->second)};
+        if (previousCost != currentCost) {
+            changes.emplace_back(it, std::make_pair(previousCost, currentCost));
+        }
+    }
+    std::stable_sort(changes.begin(), changes.end(), [](const std::pair<std::string, std::pair<uint64_t, uint64_t>> &lhs, const std::pair<std::string, std::pair<uint64_t, uint64_t>> &rhs) {
+        uint64_t lhsChange{std::max(lhs.second.first, lhs.second.second) - std::min(lhs.second.first, lhs.second.second)};
+        uint64_t rhsChange{std::max(rhs.second.first, rhs.second.second) - std::min(rhs.second.first, rhs.second.second)};
+        return (lhsChange > rhsChange);
+    });
+    if (changes.empty()) {
+        returnStream << "    No function's estimated cost changed" << std::endl;
+        return returnStream.str();
+    }
+    returnStream << std::endl << "Largest changes in estimated cycles by function:" << std::endl;
+    for (size_t i = 0; (i < changes.size()) && (i < topCount); i++) {
+        uint64_t previousCost{changes[i].second.first};
+        uint64_t currentCost{changes[i].second.second};
+        std::string changeDescription{(currentCost == 0) ? "gone" : percentChange(previousCost, currentCost)};
+        returnStream << "    " << std::setw(10) << changeDescription << std::setw(20) << withThousands(previousCost) << " -> " << std::setw(20) << withThousands(currentCost)
+                     << "  " << shortened(changes[i].first, 60) << std::endl;
+    }
+    return returnStream.str();
+}
@@ -0,0 +1,335 @@
+/***********************************************************************
+*    chrometrace.cpp:                                                  *
+*    Reads and writes Chrome trace event files for EasyGpp             *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a ChromeTrace class. This   *
+*    class collects "complete" (begin and duration) trace events on    *
+*    named lanes and writes them in the JSON format understood by      *
+*    chrome://tracing and Perfetto, and can read back the events of a  *
+*    trace written by another tool (eg clang's -ftime-trace)           *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "chrometrace.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+    //Just enough of a JSON reader for trace files: every member of each
+    //object in "traceEvents" is flattened to a "key" or "parent.key" string
+    class JsonScanner
+    {
+    public:
+        JsonScanner(const std::string &contents) :
+            m_position{contents.c_str()},
+            m_end{contents.c_str() + contents.length()}
+        {
+
+        }
+
+        bool readEvents(std::vector<TraceEvent> &traceEvents)
+        {
+            this->skipWhitespace();
+            if ((this->m_position < this->m_end) && (*this->m_position == '[')) {
+                return this->readEventArray(traceEvents);
+            }
+            if (!this->consume('{')) {
+                return false;
+            }
+            while (true) {
+                std::string key{""};
+                if ((!this->readString(key)) || (!this->consume(':'))) {
+                    return false;
+                }
+                this->skipWhitespace();
+                if ((key == "traceEvents") && (this->m_position < this->m_end) && (*this->m_position == '[')) {
+                    if (!this->readEventArray(traceEvents)) {
+                        return false;
+                    }
+                } else if (!this->skipValue()) {
+                    return false;
+                }
+                if (this->consume('}')) {
+                    return true;
+                }
+                if (!this->consume(',')) {
+                    return false;
+                }
+            }
+        }
+
+    private:
+        const char *m_position;
+        const char *m_end;
+
+        void skipWhitespace()
+        {
+            while ((this->m_position < this->m_end) && ((*this->m_position == ' ') || (*this->m_position == '\n') || (*this->m_position == '\r') || (*this->m_position == '\t'))) {
+                this->m_position++;
+            }
+        }
+
+        bool consume(char expectedChar)
+        {
+            this->skipWhitespace();
+            if ((this->m_position < this->m_end) && (*this->m_position == expectedChar)) {
+                this->m_position++;
+                return true;
+            }
+            return false;
+        }
+
+        bool readEventArray(std::vector<TraceEvent> &traceEvents)
+        {
+            if (!this->consume('[')) {
+                return false;
+            }
+            if (this->consume(']')) {
+                return true;
+            }
+            while (true) {
+                std::map<std::string, std::string> fields;
+                this->skipWhitespace();
+                if ((this->m_position < this->m_end) && (*this->m_position == '{')) {
+                    if (!this->readObject("", fields)) {
+                        return false;
+                    }
+                    if (fields["ph"] == "X") {
+                        traceEvents.emplace_back(TraceEvent{fields["name"], fields["args.detail"], 
+                                                            atof(fields["ts"].c_str()), atof(fields["dur"].c_str()), atoi(fields["tid"].c_str())});
+                    }
+                } else if (!this->skipValue()) {
+                    return false;
+                }
+                if (this->consume(']')) {
+                    return true;
+                }
+                if (!this->consume(',')) {
+                    return false;
+                }
+            }
+        }
+
+        bool readObject(const std::string &prefix, std::map<std::string, std::string> &fields)
+        {
+            if (!this->consume('{')) {
+                return false;
+            }
+            if (this->consume('}')) {
+                return true;
+            }
+            while (true) {
+                std::string key{""};
+                if ((!this->readString(key)) || (!this->consume(':'))) {
+                    return false;
+                }
+                this->skipWhitespace();
+                if (this->m_position >= this->m_end) {
+                    return false;
+                }
+                if (*this->m_position == '{') {
+                    if (!this->readObject(prefix + key + ".", fields)) {
+                        return false;
+                    }
+                } else if (*this->m_position == '"') {
+                    if (!this->readString(fields[prefix + key])) {
+                        return false;
+                    }
+                } else {
+                    const char *valueStart{this->m_position};
+                    if (!this->skipValue()) {
+                        return false;
+                    }
+                    fields[prefix + key] = std::string{valueStart, static_cast<size_t>(this->m_position - valueStart)};
+                }
+                if (this->consume('}')) {
+                    return true;
+                }
+                if (!this->consume(',')) {
+                    return false;
+                }
+            }
+        }
+
+        bool readString(std::string &value)
+        {
+            if (!this->consume('"')) {
+                return false;
+            }
+            value.clear();
+            while (this->m_position < this->m_end) {
+                char currentChar{*this->m_position++};
+                if (currentChar == '"') {
+                    return true;
+                } else if ((currentChar == '\\') && (this->m_position < this->m_end)) {
+                    char escapedChar{*this->m_position++};
+                    if (escapedChar == 'n') {
+                        value += '\n';
+                    } else if (escapedChar == 't') {
+                        value += '\t';
+                    } else if ((escapedChar == 'u') && (this->m_end - this->m_position >= 4)) {
+                        long codePoint{strtol(std::string{this->m_position, 4}.c_str(), nullptr, 16)};
+                        this->m_position += 4;
+                        if (codePoint < 0x80) {
+                            value += static_cast<char>(codePoint);
+                        } else if (codePoint < 0x800) {
+                            value += static_cast<char>(0xC0 | (codePoint >> 6));
+                            value += static_cast<char>(0x80 | (codePoint & 0x3F));
+                        } else {
+                            value += static_cast<char>(0xE0 | (codePoint >> 12));
+                            value += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                            value += static_cast<char>(0x80 | (codePoint & 0x3F));
+                        }
+                    } else {
+                        value += escapedChar;
+                    }
+                } else {
+                    value += currentChar;
+                }
+            }
+            return false;
+        }
+
+        bool skipValue()
+        {
+            this->skipWhitespace();
+            if (this->m_position >= this->m_end) {
+                return false;
+            }
+            if (*this->m_position == '"') {
+                std::string ignored{""};
+                return this->readString(ignored);
+            } else if ((*this->m_position == '{') || (*this->m_position == '[')) {
+                char closingChar{(*this->m_position == '{') ? '}' : ']'};
+                this->m_position++;
+                if (this->consume(closingChar)) {
+                    return true;
+                }
+                while (true) {
+                    if (closingChar == '}') {
+                        std::string ignored{""};
+                        if ((!this->readString(ignored)) || (!this->consume(':'))) {
+                            return false;
+                        }
+                    }
+                    if (!this->skipValue()) {
+                        return false;
+                    }
+                    if (this->consume(closingChar)) {
+                        return true;
+                    }
+                    if (!this->consume(',')) {
+                        return false;
+                    }
+                }
+            }
+            const char *valueStart{this->m_position};
+            while ((this->m_position < this->m_end) && (*this->m_position != ',') && (*this->m_position != '}') && (*this->m_position != ']')
+                   && (*this->m_position != ' ') && (*this->m_position != '\n') && (*this->m_position != '\r') && (*this->m_position != '\t')) {
+                this->m_position++;
+            }
+            return (this->m_position != valueStart);
+        }
+    };
+}
+
+ChromeTrace::ChromeTrace() :
+    m_events{},
+    m_threadNames{}
+{
+
+}
+
+void ChromeTrace::addEvent(const TraceEvent &traceEvent)
+{
+    this->m_events.emplace_back(traceEvent);
+}
+
+void ChromeTrace::setThreadName(int threadId, const std::string &threadName)
+{
+    this->m_threadNames[threadId] = threadName;
+}
+
+const std::vector<TraceEvent> &ChromeTrace::events() const
+{
+    return this->m_events;
+}
+
+bool ChromeTrace::write(const std::string &filePath) const
+{
+    std::string temporaryPath{filePath + ".tmp"};
+    std::ofstream writeToFile{temporaryPath};
+    if (!writeToFile.is_open()) {
+        return false;
+    }
+    writeToFile << std::fixed << std::setprecision(3);
+    writeToFile << "{\"traceEvents\":[\n";
+    bool firstEvent{true};
+    for (auto &it : this->m_threadNames) {
+        writeToFile << (firstEvent ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << it.first 
+                    << ",\"args\":{\"name\":\"" << escapeJson(it.second) << "\"}}";
+        firstEvent = false;
+    }
+    for (auto &it : this->m_events) {
+        writeToFile << (firstEvent ? "" : ",\n") << "{\"name\":\"" << escapeJson(it.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << it.threadId
+                    << ",\"ts\":" << it.startMicroseconds << ",\"dur\":" << it.durationMicroseconds;
+        if (it.detail != "") {
+            writeToFile << ",\"args\":{\"detail\":\"" << escapeJson(it.detail) << "\"}";
+        }
+        writeToFile << "}";
+        firstEvent = false;
+    }
+    writeToFile << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    writeToFile.close();
+    if (!writeToFile) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return (std::rename(temporaryPath.c_str(), filePath.c_str()) == 0);
+}
+
+bool ChromeTrace::readEvents(const std::string &filePath, std::vector<TraceEvent> &traceEvents)
+{
+    std::ifstream readFromFile{filePath};
+    if (!readFromFile.is_open()) {
+        return false;
+    }
+    std::stringstream fileContents;
+    fileContents << readFromFile.rdbuf();
+    std::string contents{fileContents.str()};
+    JsonScanner jsonScanner{contents};
+    return jsonScanner.readEvents(traceEvents);
+}
+
+std::string ChromeTrace::escapeJson(const std::string &stringToEscape)
+{
+    std::string returnString{""};
+    for (auto &it : stringToEscape) {
+        if ((it == '"') || (it == '\\')) {
+            returnString += '\\';
+            returnString += it;
+        } else if (it == '\n') {
+            returnString += "\\n";
+        } else if (it == '\t') {
+            returnString += "\\t";
+        } else if (static_cast<unsigned char>(it) < 0x20) {
+            char escapedChar[8];
+            snprintf(escapedChar, sizeof(escapedChar), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(it)));
+            returnString += escapedChar;
+        } else {
+            returnString += it;
+        }
+    }
+    return returnString;
+}
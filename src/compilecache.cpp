@@ -0,0 +1,333 @@
+/***********************************************************************
+*    compilecache.cpp:                                                 *
+*    A content addressed object file cache shared between projects     *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a CompileCache class. This  *
+*    class stores object files (and the diagnostics printed while      *
+*    making them) under a key made from the preprocessed source and    *
+*    the normalized compile flags, so an identical translation unit    *
+*    from any project can be reused without invoking the compiler. The *
+*    cache is kept under a size limit by evicting the least recently   *
+*    used entries, and entries can optionally be stored compressed     *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "compilecache.h"
+#include "easygpputilities.h"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#if defined(EASYGPP_HAVE_ZLIB)
+    #include <zlib.h>
+#endif
+
+using namespace EasyGppUtilities;
+
+static const char *STATISTICS_FILE_NAME{"stats"};
+static const char *OBJECT_ENTRY_EXTENSION{".o"};
+static const char *COMPRESSED_OBJECT_ENTRY_EXTENSION{".o.gz"};
+static const char *OUTPUT_ENTRY_EXTENSION{".stderr"};
+static const uint64_t SECOND_HASH_SEED{0x84222325cbf29ce4ULL};
+
+namespace {
+    bool readWholeFile(const std::string &filePath, std::string &contents)
+    {
+        std::ifstream readFromFile{filePath, std::ios::binary};
+        if (!readFromFile.is_open()) {
+            return false;
+        }
+        std::stringstream fileContents;
+        fileContents << readFromFile.rdbuf();
+        contents = fileContents.str();
+        return true;
+    }
+
+    bool writeWholeFile(const std::string &filePath, const std::string &contents)
+    {
+        std::ofstream writeToFile{filePath, std::ios::binary | std::ios::trunc};
+        if (!writeToFile.is_open()) {
+            return false;
+        }
+        writeToFile.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        writeToFile.close();
+        return static_cast<bool>(writeToFile);
+    }
+
+    bool copyFile(const std::string &sourcePath, const std::string &destinationPath, bool compress, bool decompress)
+    {
+        #if defined(EASYGPP_HAVE_ZLIB)
+            if (decompress) {
+                gzFile compressedFile{gzopen(sourcePath.c_str(), "rb")};
+                if (!compressedFile) {
+                    return false;
+                }
+                std::string contents{""};
+                char readBuffer[65536];
+                int bytesRead{0};
+                while ((bytesRead = gzread(compressedFile, readBuffer, sizeof(readBuffer))) > 0) {
+                    contents.append(readBuffer, static_cast<size_t>(bytesRead));
+                }
+                gzclose(compressedFile);
+                return ((bytesRead == 0) && (writeWholeFile(destinationPath, contents)));
+            } else if (compress) {
+                std::string contents{""};
+                if (!readWholeFile(sourcePath, contents)) {
+                    return false;
+                }
+                gzFile compressedFile{gzopen(destinationPath.c_str(), "wb6")};
+                if (!compressedFile) {
+                    return false;
+                }
+                bool writeSucceeded{(contents.empty()) || (gzwrite(compressedFile, contents.data(), static_cast<unsigned int>(contents.size())) > 0)};
+                return ((gzclose(compressedFile) == Z_OK) && (writeSucceeded));
+            }
+        #else
+            (void)compress;
+            if (decompress) {
+                return false;
+            }
+        #endif
+        std::string contents{""};
+        return ((readWholeFile(sourcePath, contents)) && (writeWholeFile(destinationPath, contents)));
+    }
+
+    long long fileSize(const std::string &filePath)
+    {
+        struct stat fileStat;
+        if (stat(filePath.c_str(), &fileStat) != 0) {
+            return 0;
+        }
+        return static_cast<long long>(fileStat.st_size);
+    }
+}
+
+CompileCache::CompileCache(const std::string &cacheDirectory, long long maximumSize, bool compression) :
+    m_cacheDirectory{cacheDirectory},
+    m_maximumSize{maximumSize},
+    m_compression{compression && compressionAvailable()}
+{
+    makeDirectoryPath(this->m_cacheDirectory);
+}
+
+bool CompileCache::compressionAvailable() const
+{
+    #if defined(EASYGPP_HAVE_ZLIB)
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+std::string CompileCache::makeKey(const std::string &preprocessedFilePath, const std::string &normalizedFlags)
+{
+    //Two independently seeded 64 bit hashes, so the key is 128 bits wide
+    std::string contents{""};
+    if (!readWholeFile(preprocessedFilePath, contents)) {
+        return "";
+    }
+    uint64_t firstHash{fnv1a64(normalizedFlags, fnv1a64(contents))};
+    uint64_t secondHash{fnv1a64(normalizedFlags, fnv1a64(contents, SECOND_HASH_SEED))};
+    return toHexString(firstHash) + toHexString(secondHash);
+}
+
+std::string CompileCache::entryBasePath(const std::string &key) const
+{
+    return this->m_cacheDirectory + "/" + key.substr(0, 2) + "/" + key;
+}
+
+bool CompileCache::fetch(const std::string &key, const std::string &objectFilePath, std::string &compilerOutput)
+{
+    std::string basePath{entryBasePath(key)};
+    std::string entryPath{basePath + OBJECT_ENTRY_EXTENSION};
+    bool compressed{false};
+    if (access(entryPath.c_str(), R_OK) != 0) {
+        entryPath = basePath + COMPRESSED_OBJECT_ENTRY_EXTENSION;
+        compressed = true;
+        if ((!compressionAvailable()) || (access(entryPath.c_str(), R_OK) != 0)) {
+            updateStatistics(0, 1, 0, 0);
+            return false;
+        }
+    }
+    std::string temporaryPath{objectFilePath + ".tmp"};
+    if ((!copyFile(entryPath, temporaryPath, false, compressed)) || (std::rename(temporaryPath.c_str(), objectFilePath.c_str()) != 0)) {
+        std::remove(temporaryPath.c_str());
+        updateStatistics(0, 1, 0, 0);
+        return false;
+    }
+    readWholeFile(basePath + OUTPUT_ENTRY_EXTENSION, compilerOutput);
+    //The modification time doubles as the last use time for eviction
+    utimes(entryPath.c_str(), nullptr);
+    updateStatistics(1, 0, 0, 0);
+    return true;
+}
+
+bool CompileCache::store(const std::string &key, const std::string &objectFilePath, const std::string &compilerOutput)
+{
+    std::string basePath{entryBasePath(key)};
+    if (!makeDirectoryPath(parentDirectory(basePath))) {
+        return false;
+    }
+    std::string entryPath{basePath + (this->m_compression ? COMPRESSED_OBJECT_ENTRY_EXTENSION : OBJECT_ENTRY_EXTENSION)};
+    std::string temporaryPath{entryPath + "." + std::to_string(getpid()) + ".tmp"};
+    if ((!writeWholeFile(basePath + OUTPUT_ENTRY_EXTENSION, compilerOutput)) 
+        || (!copyFile(objectFilePath, temporaryPath, this->m_compression, false))
+        || (std::rename(temporaryPath.c_str(), entryPath.c_str()) != 0)) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    updateStatistics(0, 0, 1, fileSize(entryPath) + static_cast<long long>(compilerOutput.size()));
+    return true;
+}
+
+CompileCache::CacheStatistics CompileCache::readStatistics() const
+{
+    CacheStatistics cacheStatistics{0, 0, 0, 0, 0};
+    std::ifstream readFromFile{this->m_cacheDirectory + "/" + STATISTICS_FILE_NAME};
+    std::string name{""};
+    long long value{0};
+    while (readFromFile >> name >> value) {
+        if (name == "hits") {
+            cacheStatistics.hits = value;
+        } else if (name == "misses") {
+            cacheStatistics.misses = value;
+        } else if (name == "stores") {
+            cacheStatistics.stores = value;
+        } else if (name == "evictions") {
+            cacheStatistics.evictions = value;
+        } else if (name == "size") {
+            cacheStatistics.totalSize = value;
+        }
+    }
+    return cacheStatistics;
+}
+
+void CompileCache::updateStatistics(long long hits, long long misses, long long stores, long long sizeChange)
+{
+    //The mutex serializes the worker threads of this process, the flock
+    //serializes any other easyg++ running against the same cache
+    std::lock_guard<std::mutex> lock{this->m_statisticsMutex};
+    std::string statisticsPath{this->m_cacheDirectory + "/" + STATISTICS_FILE_NAME};
+    int lockDescriptor{open((statisticsPath + ".lock").c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644)};
+    if (lockDescriptor >= 0) {
+        flock(lockDescriptor, LOCK_EX);
+    }
+    CacheStatistics cacheStatistics{readStatistics()};
+    cacheStatistics.hits += hits;
+    cacheStatistics.misses += misses;
+    cacheStatistics.stores += stores;
+    cacheStatistics.totalSize += sizeChange;
+    if (cacheStatistics.totalSize > this->m_maximumSize) {
+        evictLeastRecentlyUsed(cacheStatistics);
+    }
+    std::ofstream writeToFile{statisticsPath + ".tmp", std::ios::trunc};
+    writeToFile << "hits " << cacheStatistics.hits << '\n'
+                << "misses " << cacheStatistics.misses << '\n'
+                << "stores " << cacheStatistics.stores << '\n'
+                << "evictions " << cacheStatistics.evictions << '\n'
+                << "size " << cacheStatistics.totalSize << '\n';
+    writeToFile.close();
+    std::rename((statisticsPath + ".tmp").c_str(), statisticsPath.c_str());
+    if (lockDescriptor >= 0) {
+        flock(lockDescriptor, LOCK_UN);
+        close(lockDescriptor);
+    }
+}
+
+void CompileCache::evictLeastRecentlyUsed(CacheStatistics &cacheStatistics)
+{
+    //Walk every entry (this also corrects any drift in the running total),
+    //then delete the oldest until the cache is back under 90% of its limit
+    struct CacheEntry
+    {
+        std::string basePath;
+        std::string objectPath;
+        long long lastUsed;
+        long long size;
+    };
+    std::vector<CacheEntry> cacheEntries;
+    long long totalSize{0};
+    DIR *cacheDirectory{opendir(this->m_cacheDirectory.c_str())};
+    if (!cacheDirectory) {
+        return;
+    }
+    while (struct dirent *subdirectoryEntry = readdir(cacheDirectory)) {
+        std::string subdirectoryName{subdirectoryEntry->d_name};
+        if ((subdirectoryName.length() != 2) || (subdirectoryName[0] == '.')) {
+            continue;
+        }
+        std::string subdirectoryPath{this->m_cacheDirectory + "/" + subdirectoryName};
+        DIR *subdirectory{opendir(subdirectoryPath.c_str())};
+        if (!subdirectory) {
+            continue;
+        }
+        while (struct dirent *fileEntry = readdir(subdirectory)) {
+            std::string fileName{fileEntry->d_name};
+            std::string extension{""};
+            if ((fileName.length() > 5) && (fileName.substr(fileName.length() - 5) == COMPRESSED_OBJECT_ENTRY_EXTENSION)) {
+                extension = COMPRESSED_OBJECT_ENTRY_EXTENSION;
+            } else if ((fileName.length() > 2) && (fileName.substr(fileName.length() - 2) == OBJECT_ENTRY_EXTENSION)) {
+                extension = OBJECT_ENTRY_EXTENSION;
+            } else {
+                continue;
+            }
+            std::string basePath{subdirectoryPath + "/" + fileName.substr(0, fileName.length() - extension.length())};
+            FileStamp fileStamp{-1, -1};
+            if (!getFileStamp(subdirectoryPath + "/" + fileName, fileStamp)) {
+                continue;
+            }
+            long long entrySize{fileStamp.size + fileSize(basePath + OUTPUT_ENTRY_EXTENSION)};
+            cacheEntries.emplace_back(CacheEntry{basePath, subdirectoryPath + "/" + fileName, fileStamp.modifiedTime, entrySize});
+            totalSize += entrySize;
+        }
+        closedir(subdirectory);
+    }
+    closedir(cacheDirectory);
+    std::sort(cacheEntries.begin(), cacheEntries.end(), [](const CacheEntry &lhs, const CacheEntry &rhs) {
+        return lhs.lastUsed < rhs.lastUsed;
+    });
+    long long targetSize{this->m_maximumSize - (this->m_maximumSize / 10)};
+    for (auto &it : cacheEntries) {
+        if (totalSize <= targetSize) {
+            break;
+        }
+        std::remove(it.objectPath.c_str());
+        std::remove((it.basePath + OUTPUT_ENTRY_EXTENSION).c_str());
+        totalSize -= it.size;
+        cacheStatistics.evictions++;
+    }
+    cacheStatistics.totalSize = totalSize;
+}
+
+std::string CompileCache::statistics() const
+{
+    CacheStatistics cacheStatistics{readStatistics()};
+    long long lookups{cacheStatistics.hits + cacheStatistics.misses};
+    std::stringstream returnStream;
+    returnStream << "Compile cache directory: " << this->m_cacheDirectory << '\n'
+                 << "    cache hits:      " << cacheStatistics.hits << '\n'
+                 << "    cache misses:    " << cacheStatistics.misses << '\n'
+                 << "    hit rate:        " << ((lookups == 0) ? 0 : (cacheStatistics.hits * 100) / lookups) << "%" << '\n'
+                 << "    objects stored:  " << cacheStatistics.stores << '\n'
+                 << "    objects evicted: " << cacheStatistics.evictions << '\n'
+                 << "    cache size:      " << cacheStatistics.totalSize / 1024 << " KiB of " << this->m_maximumSize / 1024 << " KiB"
+                 << (this->m_compression ? " (compressed)" : "") << '\n';
+    return returnStream.str();
+}
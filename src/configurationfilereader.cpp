@@ -10,7 +10,9 @@
 *    class. This class is used to configure EasyGpp, with things like  *
 *    auto populating included libraries (according to headers used),   *
 *    as well as specifying extra editors to choose from if the target  *
-*    program does not compile correctly, and must be edited            *
+*    program does not compile correctly, and must be edited. The parsed *
+*    result is kept in a compiled copy next to the configuration file, *
+*    so an unchanged file is not parsed again                          *
 *                                                                      *
 *    You should have received a copy of the GNU Lesser General         *
 *    Public license along with libraryprojects                         *
@@ -19,10 +21,90 @@
 
 #include "configurationfilereader.h"
 
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//Bump whenever the payload layout changes, or a directive is added or read
+//differently, so compiled configurations written before are parsed again
+static const char *COMPILED_CONFIGURATION_MAGIC{"EGPPCFG1"};
+static const uint64_t CONFIG_FORMAT_VERSION{1};
+
+namespace {
+    void appendInteger(std::string &payload, uint64_t value)
+    {
+        payload.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void appendString(std::string &payload, const std::string &stringToAppend)
+    {
+        appendInteger(payload, stringToAppend.length());
+        payload.append(stringToAppend);
+    }
+
+    //Bounds checked reads from a mapped compiled configuration, which might
+    //be truncated or corrupt
+    class PayloadReader
+    {
+    public:
+        PayloadReader(const char *data, size_t length) :
+            m_data{data},
+            m_length{length},
+            m_position{0}
+        {
+
+        }
+
+        bool readInteger(uint64_t &value)
+        {
+            if (this->m_length - this->m_position < sizeof(value)) {
+                return false;
+            }
+            memcpy(&value, this->m_data + this->m_position, sizeof(value));
+            this->m_position += sizeof(value);
+            return true;
+        }
+
+        bool readString(std::string &value)
+        {
+            uint64_t stringLength{0};
+            if ((!this->readInteger(stringLength)) || (this->m_length - this->m_position < stringLength)) {
+                return false;
+            }
+            value.assign(this->m_data + this->m_position, stringLength);
+            this->m_position += stringLength;
+            return true;
+        }
+
+        bool atEnd() const
+        {
+            return (this->m_position == this->m_length);
+        }
+
+    private:
+        const char *m_data;
+        size_t m_length;
+        size_t m_position;
+    };
+}
+
 ConfigurationFileReader::ConfigurationFileReader() :
     m_extraEditors{std::set<std::string>{}},
     m_libraryToHeaderMap{std::map<std::string, std::string>{}},
-    m_output{std::vector<std::string>{}}
+    m_output{std::vector<std::string>{}},
+    m_compileCacheEnabled{false},
+    m_compileCacheSize{EasyGppStrings::DEFAULT_COMPILE_CACHE_SIZE},
+    m_compileCacheCompression{false},
+    m_precompiledHeaders{std::vector<std::string>{}},
+    m_linker{EasyGppStrings::AUTOMATIC_LINKER},
+    m_splitDwarf{true},
+    m_profiles{std::map<std::string, std::string>{}},
+    m_tuneOptions{std::vector<std::string>{}}
 {
     using namespace FileUtilities;
     using namespace GeneralUtilities;
@@ -38,12 +120,22 @@ ConfigurationFileReader::ConfigurationFileReader() :
     }
     std::vector<std::string> buffer;
     std::ifstream readFromFile;
+    std::string configurationFilePath{""};
+    EasyGppUtilities::FileStamp configurationFileStamp{-1, -1};
     const std::vector<std::string> configurationFiles{DEFAULT_CONFIGURATION_FILE,
                                                       BACKUP_CONFIGURATION_FILE,
                                                       LAST_CHANCE_CONFIGURATION_FILE};
     for (auto it = configurationFiles.begin(); it != configurationFiles.end(); it++) {
+        if (this->loadCompiledConfiguration(*it)) {
+            std::cout << USING_CONFIGURATION_FILE_STRING << tQuoted(*it) << std::endl;
+            return;
+        }
+        //Stamped before reading, so an edit made while parsing is never
+        //mistaken for the version that was compiled
+        EasyGppUtilities::getFileStamp(*it, configurationFileStamp);
         readFromFile.open(*it);
         if (readFromFile.is_open()) {
+            configurationFilePath = *it;
             std::cout << USING_CONFIGURATION_FILE_STRING << tQuoted(*it) << std::endl;
             std::string tempString{""};
             while (std::getline(readFromFile, tempString)) {
@@ -80,6 +172,14 @@ ConfigurationFileReader::ConfigurationFileReader() :
             //TODO: Replace with regex for searching
             size_t foundLibraryPosition{copyString.find(static_cast<std::string>(LIBRARY_IDENTIFIER))};
             size_t foundEditorPosition{copyString.find(static_cast<std::string>(EDITOR_IDENTIFIER))};
+            size_t foundCompileCachePosition{copyString.find(static_cast<std::string>(COMPILE_CACHE_IDENTIFIER))};
+            size_t foundCacheSizePosition{copyString.find(static_cast<std::string>(CACHE_SIZE_IDENTIFIER))};
+            size_t foundCacheCompressionPosition{copyString.find(static_cast<std::string>(CACHE_COMPRESSION_IDENTIFIER))};
+            size_t foundPrecompiledHeaderPosition{copyString.find(static_cast<std::string>(PRECOMPILED_HEADER_IDENTIFIER))};
+            size_t foundLinkerPosition{copyString.find(static_cast<std::string>(LINKER_IDENTIFIER))};
+            size_t foundSplitDwarfPosition{copyString.find(static_cast<std::string>(SPLIT_DWARF_IDENTIFIER))};
+            size_t foundProfilePosition{copyString.find(static_cast<std::string>(PROFILE_IDENTIFIER))};
+            size_t foundTuneOptionPosition{copyString.find(static_cast<std::string>(TUNE_OPTION_IDENTIFIER))};
             if (copyString.length() != 0) {
                 std::string otherCopy{copyString};
                 int numberOfWhitespace{0};
@@ -158,6 +258,76 @@ ConfigurationFileReader::ConfigurationFileReader() :
                     continue;
                 } 
                 this->m_extraEditors.emplace(getBetween("(", ")", *iter));
+            } else if (foundCompileCachePosition != std::string::npos) {
+                std::string argument{""};
+                if (getSingleArgument(*iter, copyString, currentLine, argument)) {
+                    getBooleanArgument(*iter, argument, currentLine, this->m_compileCacheEnabled);
+                }
+            } else if (foundCacheSizePosition != std::string::npos) {
+                std::string argument{""};
+                if (getSingleArgument(*iter, copyString, currentLine, argument)) {
+                    long long cacheSize{parseByteSize(argument)};
+                    if (cacheSize <= 0) {
+                        addConfigurationWarning(*iter, currentLine, INVALID_SIZE_STRING, iter->find(")"));
+                        continue;
+                    }
+                    this->m_compileCacheSize = cacheSize;
+                }
+            } else if (foundCacheCompressionPosition != std::string::npos) {
+                std::string argument{""};
+                if (getSingleArgument(*iter, copyString, currentLine, argument)) {
+                    getBooleanArgument(*iter, argument, currentLine, this->m_compileCacheCompression);
+                }
+            } else if (foundPrecompiledHeaderPosition != std::string::npos) {
+                std::string argument{""};
+                if (getSingleArgument(*iter, copyString, currentLine, argument)) {
+                    if (std::find(this->m_precompiledHeaders.begin(), this->m_precompiledHeaders.end(), argument) == this->m_precompiledHeaders.end()) {
+                        this->m_precompiledHeaders.emplace_back(argument);
+                    }
+                }
+            } else if (foundLinkerPosition != std::string::npos) {
+                std::string argument{""};
+                if (getSingleArgument(*iter, copyString, currentLine, argument)) {
+                    std::transform(argument.begin(), argument.end(), argument.begin(), ::tolower);
+                    if (std::find(KNOWN_LINKERS.begin(), KNOWN_LINKERS.end(), argument) == KNOWN_LINKERS.end()) {
+                        addConfigurationWarning(*iter, currentLine, INVALID_LINKER_STRING, iter->find(")"));
+                        continue;
+                    }
+                    this->m_linker = argument;
+                }
+            } else if (foundSplitDwarfPosition != std::string::npos) {
+                std::string argument{""};
+                if (getSingleArgument(*iter, copyString, currentLine, argument)) {
+                    getBooleanArgument(*iter, argument, currentLine, this->m_splitDwarf);
+                }
+            } else if (foundProfilePosition != std::string::npos) {
+                //The switches may contain parentheses of their own, so they
+                //run up to the last closing parenthesis on the line
+                size_t closingPosition{iter->rfind(")")};
+                if (closingPosition == std::string::npos) {
+                    addConfigurationWarning(*iter, currentLine, NO_CLOSING_PARENTHESIS_FOUND_STRING, iter->length());
+                    continue;
+                }
+                size_t openingPosition{iter->find("(")};
+                std::string nameAndSwitches{iter->substr(openingPosition + 1, closingPosition - openingPosition - 1)};
+                if (nameAndSwitches.find(",") == std::string::npos) {
+                    addConfigurationWarning(*iter, currentLine, NO_PARAMETER_SEPARATING_COMMA_STRING, closingPosition);
+                    continue;
+                }
+                std::string profileName{trimWhitespace(nameAndSwitches.substr(0, nameAndSwitches.find(",")))};
+                std::string profileSwitches{trimWhitespace(nameAndSwitches.substr(nameAndSwitches.find(",") + 1))};
+                std::transform(profileName.begin(), profileName.end(), profileName.begin(), ::tolower);
+                //The name becomes a directory name, so it is kept to a safe set of characters
+                if ((profileName.empty()) || (profileName.find_first_not_of("abcdefghijklmnopqrstuvwxyz0123456789-_") != std::string::npos)) {
+                    addConfigurationWarning(*iter, currentLine, INVALID_PROFILE_NAME_STRING, iter->find(","));
+                    continue;
+                }
+                this->m_profiles[profileName] = profileSwitches;
+            } else if (foundTuneOptionPosition != std::string::npos) {
+                std::string argument{""};
+                if (getSingleArgument(*iter, copyString, currentLine, argument)) {
+                    this->m_tuneOptions.emplace_back(argument);
+                }
             } else {
                     this->m_output.emplace_back(static_cast<std::string>(GENERIC_CONFIG_WARNING_BASE_STRING) 
                                                 + toString(currentLine) 
@@ -170,19 +340,304 @@ ConfigurationFileReader::ConfigurationFileReader() :
              this->m_output.emplace_back(static_cast<std::string>(STANDARD_EXCEPTION_CAUGHT_IN_CONSTRUCTOR_STRING) + toString(e.what()) + tEndl());
         }
     }
+    if ((configurationFilePath != "") && (configurationFileStamp.modifiedTime >= 0) 
+        && (configurationFileStamp.modifiedTime < EasyGppUtilities::currentFileSystemTime())) {
+        this->saveCompiledConfiguration(configurationFilePath, configurationFileStamp);
+    }
 }
 
-std::set<std::string> ConfigurationFileReader::extraEditors() const
+const std::set<std::string> &ConfigurationFileReader::extraEditors() const
 {
     return this->m_extraEditors;
 }
 
-std::map<std::string, std::string> ConfigurationFileReader::libraryToHeaderMap() const
+const std::map<std::string, std::string> &ConfigurationFileReader::libraryToHeaderMap() const
 {
     return this->m_libraryToHeaderMap;
 }
 
-std::vector<std::string> ConfigurationFileReader::output() const
+const std::vector<std::string> &ConfigurationFileReader::output() const
 {
     return this->m_output;
 }
+
+bool ConfigurationFileReader::compileCacheEnabled() const
+{
+    return this->m_compileCacheEnabled;
+}
+
+long long ConfigurationFileReader::compileCacheSize() const
+{
+    return this->m_compileCacheSize;
+}
+
+bool ConfigurationFileReader::compileCacheCompression() const
+{
+    return this->m_compileCacheCompression;
+}
+
+const std::vector<std::string> &ConfigurationFileReader::precompiledHeaders() const
+{
+    return this->m_precompiledHeaders;
+}
+
+const std::string &ConfigurationFileReader::linker() const
+{
+    return this->m_linker;
+}
+
+bool ConfigurationFileReader::splitDwarf() const
+{
+    return this->m_splitDwarf;
+}
+
+const std::map<std::string, std::string> &ConfigurationFileReader::profiles() const
+{
+    return this->m_profiles;
+}
+
+const std::vector<std::string> &ConfigurationFileReader::tuneOptions() const
+{
+    return this->m_tuneOptions;
+}
+
+void ConfigurationFileReader::addConfigurationWarning(const std::string &rawLine, long int currentLine, const std::string &warning, size_t markerPosition)
+{
+    using namespace GeneralUtilities;
+    using namespace EasyGppStrings;
+    this->m_output.emplace_back(static_cast<std::string>(GENERIC_CONFIG_WARNING_BASE_STRING) 
+                                + toString(currentLine) 
+                                + static_cast<std::string>(GENERIC_CONFIG_WARNING_TAIL_STRING));
+    this->m_output.emplace_back(warning);
+    this->m_output.emplace_back(rawLine);
+    this->m_output.emplace_back(tWhitespace((markerPosition == std::string::npos) ? rawLine.length() : markerPosition) 
+                                + static_cast<std::string>(EXPECTED_HERE_STRING) + tEndl());
+}
+
+bool ConfigurationFileReader::getSingleArgument(const std::string &rawLine, const std::string &copyString, long int currentLine, std::string &argument)
+{
+    using namespace GeneralUtilities;
+    using namespace EasyGppStrings;
+    if (copyString.find(")") == std::string::npos) {
+        addConfigurationWarning(rawLine, currentLine, NO_CLOSING_PARENTHESIS_FOUND_STRING, rawLine.length());
+        return false;
+    }
+    argument = trimWhitespace(getBetween("(", ")", rawLine));
+    if (argument.length() == 0) {
+        addConfigurationWarning(rawLine, currentLine, NO_ARGUMENT_SPECIFIED_STRING, rawLine.find(")"));
+        return false;
+    }
+    return true;
+}
+
+bool ConfigurationFileReader::getBooleanArgument(const std::string &rawLine, const std::string &argument, long int currentLine, bool &value)
+{
+    std::string copyString{argument};
+    std::transform(copyString.begin(), copyString.end(), copyString.begin(), ::tolower);
+    if ((copyString == "true") || (copyString == "on") || (copyString == "yes") || (copyString == "1")) {
+        value = true;
+        return true;
+    } else if ((copyString == "false") || (copyString == "off") || (copyString == "no") || (copyString == "0")) {
+        value = false;
+        return true;
+    }
+    addConfigurationWarning(rawLine, currentLine, EasyGppStrings::INVALID_BOOLEAN_STRING, rawLine.find(")"));
+    return false;
+}
+
+long long ConfigurationFileReader::parseByteSize(const std::string &sizeString)
+{
+    //Accepts a plain number of bytes, or one suffixed with K, M or G
+    std::string copyString{GeneralUtilities::trimWhitespace(sizeString)};
+    if (copyString.empty()) {
+        return -1;
+    }
+    long long multiplier{1};
+    char suffix{static_cast<char>(::tolower(copyString.back()))};
+    if ((suffix == 'k') || (suffix == 'm') || (suffix == 'g')) {
+        multiplier = ((suffix == 'k') ? 1024LL : ((suffix == 'm') ? 1024LL * 1024LL : 1024LL * 1024LL * 1024LL));
+        copyString.pop_back();
+    }
+    if (!EasyGppUtilities::isUnsignedInteger(copyString)) {
+        return -1;
+    }
+    try {
+        return std::stoll(copyString) * multiplier;
+    } catch (std::exception &e) {
+        return -1;
+    }
+}
+
+bool ConfigurationFileReader::loadCompiledConfiguration(const std::string &configurationFilePath)
+{
+    //Layout: magic, format version, configuration file modification time
+    //and size, payload hash, payload length, then the payload itself
+    using namespace EasyGppUtilities;
+    FileStamp fileStamp{-1, -1};
+    if (!getFileStamp(configurationFilePath, fileStamp)) {
+        return false;
+    }
+    std::string compiledPath{configurationFilePath + EasyGppStrings::COMPILED_CONFIGURATION_EXTENSION};
+    int fileDescriptor{open(compiledPath.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fileDescriptor < 0) {
+        return false;
+    }
+    struct stat fileStat;
+    const size_t headerLength{8 + 5 * sizeof(uint64_t)};
+    if ((fstat(fileDescriptor, &fileStat) != 0) || (static_cast<size_t>(fileStat.st_size) < headerLength)) {
+        close(fileDescriptor);
+        return false;
+    }
+    size_t length{static_cast<size_t>(fileStat.st_size)};
+    void *mappedFile{mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fileDescriptor, 0)};
+    close(fileDescriptor);
+    if (mappedFile == MAP_FAILED) {
+        return false;
+    }
+    const char *data{static_cast<const char *>(mappedFile)};
+    PayloadReader headerReader{data + 8, headerLength - 8};
+    uint64_t formatVersion{0};
+    uint64_t modifiedTime{0};
+    uint64_t fileSize{0};
+    uint64_t payloadHash{0};
+    uint64_t payloadLength{0};
+    headerReader.readInteger(formatVersion);
+    headerReader.readInteger(modifiedTime);
+    headerReader.readInteger(fileSize);
+    headerReader.readInteger(payloadHash);
+    headerReader.readInteger(payloadLength);
+    bool loaded{false};
+    if ((memcmp(data, COMPILED_CONFIGURATION_MAGIC, 8) == 0) && (formatVersion == CONFIG_FORMAT_VERSION)
+        && (static_cast<long long>(modifiedTime) == fileStamp.modifiedTime) && (static_cast<long long>(fileSize) == fileStamp.size)
+        && (payloadLength == length - headerLength) && (fnv1a64(data + headerLength, payloadLength) == payloadHash)) {
+        PayloadReader payloadReader{data + headerLength, payloadLength};
+        std::set<std::string> extraEditors;
+        std::map<std::string, std::string> libraryToHeaderMap;
+        std::vector<std::string> output;
+        std::vector<std::string> precompiledHeaders;
+        std::string linker{""};
+        uint64_t splitDwarf{0};
+        std::map<std::string, std::string> profiles;
+        std::vector<std::string> tuneOptions;
+        uint64_t compileCacheEnabled{0};
+        uint64_t compileCacheSize{0};
+        uint64_t compileCacheCompression{0};
+        uint64_t entryCount{0};
+        loaded = ((payloadReader.readInteger(compileCacheEnabled)) && (payloadReader.readInteger(compileCacheSize)) 
+                  && (payloadReader.readInteger(compileCacheCompression)) && (payloadReader.readInteger(entryCount)));
+        for (uint64_t i = 0; (loaded) && (i < entryCount); i++) {
+            std::string editorName{""};
+            loaded = payloadReader.readString(editorName);
+            extraEditors.emplace(editorName);
+        }
+        loaded = ((loaded) && (payloadReader.readInteger(entryCount)));
+        for (uint64_t i = 0; (loaded) && (i < entryCount); i++) {
+            std::string headerFile{""};
+            std::string targetLibrary{""};
+            loaded = ((payloadReader.readString(headerFile)) && (payloadReader.readString(targetLibrary)));
+            libraryToHeaderMap.emplace(headerFile, targetLibrary);
+        }
+        loaded = ((loaded) && (payloadReader.readInteger(entryCount)));
+        for (uint64_t i = 0; (loaded) && (i < entryCount); i++) {
+            std::string outputLine{""};
+            loaded = payloadReader.readString(outputLine);
+            output.emplace_back(outputLine);
+        }
+        loaded = ((loaded) && (payloadReader.readInteger(entryCount)));
+        for (uint64_t i = 0; (loaded) && (i < entryCount); i++) {
+            std::string headerName{""};
+            loaded = payloadReader.readString(headerName);
+            precompiledHeaders.emplace_back(headerName);
+        }
+        loaded = ((loaded) && (payloadReader.readString(linker)) && (payloadReader.readInteger(splitDwarf)) && (payloadReader.readInteger(entryCount)));
+        for (uint64_t i = 0; (loaded) && (i < entryCount); i++) {
+            std::string profileName{""};
+            std::string profileSwitches{""};
+            loaded = ((payloadReader.readString(profileName)) && (payloadReader.readString(profileSwitches)));
+            profiles.emplace(profileName, profileSwitches);
+        }
+        loaded = ((loaded) && (payloadReader.readInteger(entryCount)));
+        for (uint64_t i = 0; (loaded) && (i < entryCount); i++) {
+            std::string tuneOption{""};
+            loaded = payloadReader.readString(tuneOption);
+            tuneOptions.emplace_back(tuneOption);
+        }
+        if ((loaded) && (payloadReader.atEnd())) {
+            this->m_extraEditors = std::move(extraEditors);
+            this->m_libraryToHeaderMap = std::move(libraryToHeaderMap);
+            this->m_output.insert(this->m_output.end(), output.begin(), output.end());
+            this->m_compileCacheEnabled = (compileCacheEnabled != 0);
+            this->m_compileCacheSize = static_cast<long long>(compileCacheSize);
+            this->m_compileCacheCompression = (compileCacheCompression != 0);
+            this->m_precompiledHeaders = std::move(precompiledHeaders);
+            this->m_linker = linker;
+            this->m_splitDwarf = (splitDwarf != 0);
+            this->m_profiles = std::move(profiles);
+            this->m_tuneOptions = std::move(tuneOptions);
+        } else {
+            loaded = false;
+        }
+    }
+    munmap(mappedFile, length);
+    return loaded;
+}
+
+bool ConfigurationFileReader::saveCompiledConfiguration(const std::string &configurationFilePath, const EasyGppUtilities::FileStamp &fileStamp) const
+{
+    //The configuration file may live somewhere read only (eg /usr/share),
+    //in which case it is simply parsed every time
+    using namespace EasyGppUtilities;
+    std::string payload{""};
+    appendInteger(payload, this->m_compileCacheEnabled ? 1 : 0);
+    appendInteger(payload, static_cast<uint64_t>(this->m_compileCacheSize));
+    appendInteger(payload, this->m_compileCacheCompression ? 1 : 0);
+    appendInteger(payload, this->m_extraEditors.size());
+    for (auto &it : this->m_extraEditors) {
+        appendString(payload, it);
+    }
+    appendInteger(payload, this->m_libraryToHeaderMap.size());
+    for (auto &it : this->m_libraryToHeaderMap) {
+        appendString(payload, it.first);
+        appendString(payload, it.second);
+    }
+    appendInteger(payload, this->m_output.size());
+    for (auto &it : this->m_output) {
+        appendString(payload, it);
+    }
+    appendInteger(payload, this->m_precompiledHeaders.size());
+    for (auto &it : this->m_precompiledHeaders) {
+        appendString(payload, it);
+    }
+    appendString(payload, this->m_linker);
+    appendInteger(payload, this->m_splitDwarf ? 1 : 0);
+    appendInteger(payload, this->m_profiles.size());
+    for (auto &it : this->m_profiles) {
+        appendString(payload, it.first);
+        appendString(payload, it.second);
+    }
+    appendInteger(payload, this->m_tuneOptions.size());
+    for (auto &it : this->m_tuneOptions) {
+        appendString(payload, it);
+    }
+    std::string compiledConfiguration{COMPILED_CONFIGURATION_MAGIC};
+    appendInteger(compiledConfiguration, CONFIG_FORMAT_VERSION);
+    appendInteger(compiledConfiguration, static_cast<uint64_t>(fileStamp.modifiedTime));
+    appendInteger(compiledConfiguration, static_cast<uint64_t>(fileStamp.size));
+    appendInteger(compiledConfiguration, fnv1a64(payload));
+    appendInteger(compiledConfiguration, payload.length());
+    compiledConfiguration += payload;
+
+    std::string compiledPath{configurationFilePath + EasyGppStrings::COMPILED_CONFIGURATION_EXTENSION};
+    std::string temporaryPath{compiledPath + ".tmp"};
+    std::ofstream writeToFile{temporaryPath, std::ios::binary};
+    if (!writeToFile.is_open()) {
+        return false;
+    }
+    writeToFile.write(compiledConfiguration.data(), compiledConfiguration.length());
+    writeToFile.close();
+    if (!writeToFile) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return (std::rename(temporaryPath.c_str(), compiledPath.c_str()) == 0);
+}
@@ -0,0 +1,143 @@
+/***********************************************************************
+*    drivertrace.cpp:                                                  *
+*    Times the phases of easyg++ itself for EasyGpp                    *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a DriverTrace class. This   *
+*    class records monotonic clock spans around the phases easyg++     *
+*    goes through before and around running the compiler, so the       *
+*    overhead of the driver itself can be broken down and written out  *
+*    as a Chrome trace                                                 *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "drivertrace.h"
+#include "chrometrace.h"
+
+#include <sstream>
+#include <iomanip>
+
+//Duration of a span that has not ended yet
+static const double UNFINISHED_SPAN{-1.0};
+
+DriverTrace::Span::Span(DriverTrace *driverTrace, size_t spanIndex) :
+    m_driverTrace{driverTrace},
+    m_spanIndex{spanIndex}
+{
+
+}
+
+DriverTrace::Span::Span(Span &&other) :
+    m_driverTrace{other.m_driverTrace},
+    m_spanIndex{other.m_spanIndex}
+{
+    other.m_driverTrace = nullptr;
+}
+
+DriverTrace::Span::~Span()
+{
+    this->end();
+}
+
+void DriverTrace::Span::end()
+{
+    if (this->m_driverTrace) {
+        this->m_driverTrace->endSpan(this->m_spanIndex);
+        this->m_driverTrace = nullptr;
+    }
+}
+
+DriverTrace::DriverTrace() :
+    m_startTime{std::chrono::steady_clock::now()},
+    m_mutex{},
+    m_phases{},
+    m_threadIds{},
+    m_openDepths{}
+{
+
+}
+
+double DriverTrace::elapsedMicroseconds() const
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - this->m_startTime).count();
+}
+
+DriverTrace::Span DriverTrace::span(const std::string &phaseName, bool external)
+{
+    double startMicroseconds{this->elapsedMicroseconds()};
+    std::lock_guard<std::mutex> phaseLock{this->m_mutex};
+    //The thread that reaches here first (main) gets the first lane
+    int threadId{this->m_threadIds.emplace(std::this_thread::get_id(), static_cast<int>(this->m_threadIds.size()) + 1).first->second};
+    size_t &openDepth = this->m_openDepths[threadId];
+    this->m_phases.emplace_back(PhaseRecord{phaseName, threadId, openDepth, external, startMicroseconds, UNFINISHED_SPAN});
+    openDepth++;
+    return Span{this, this->m_phases.size() - 1};
+}
+
+void DriverTrace::endSpan(size_t spanIndex)
+{
+    double endMicroseconds{this->elapsedMicroseconds()};
+    std::lock_guard<std::mutex> phaseLock{this->m_mutex};
+    PhaseRecord &phaseRecord = this->m_phases[spanIndex];
+    phaseRecord.durationMicroseconds = endMicroseconds - phaseRecord.startMicroseconds;
+    this->m_openDepths[phaseRecord.threadId]--;
+}
+
+std::string DriverTrace::summary() const
+{
+    double totalMicroseconds{this->elapsedMicroseconds()};
+    std::lock_guard<std::mutex> phaseLock{this->m_mutex};
+    double externalMicroseconds{0.0};
+    std::stringstream returnStream;
+    returnStream << std::fixed << std::setprecision(3);
+    returnStream << "Driver phases (milliseconds since startup):" << std::endl;
+    for (auto &it : this->m_phases) {
+        bool unfinished{it.durationMicroseconds < 0.0};
+        double durationMicroseconds{unfinished ? (totalMicroseconds - it.startMicroseconds) : it.durationMicroseconds};
+        std::string phaseName{std::string(4 * it.depth, ' ') + it.name + ((it.threadId == 1) ? "" : (" [thread " + std::to_string(it.threadId) + "]"))};
+        if (phaseName.length() < 44) {
+            phaseName += std::string(44 - phaseName.length(), ' ');
+        }
+        returnStream << "    " << phaseName << std::setw(10) << it.startMicroseconds / 1000.0 << std::setw(12) << durationMicroseconds / 1000.0 << " ms"
+                     << (it.external ? " (compiler/linker)" : "") << (unfinished ? " (still running)" : "") << std::endl;
+        //Only the outermost external phases count, so nothing is subtracted twice
+        if ((it.external) && (it.threadId == 1)) {
+            bool insideExternal{false};
+            for (auto &outerIt : this->m_phases) {
+                if ((&outerIt != &it) && (outerIt.external) && (outerIt.threadId == 1) && (outerIt.depth < it.depth) 
+                    && (outerIt.startMicroseconds <= it.startMicroseconds) && (outerIt.startMicroseconds + outerIt.durationMicroseconds >= it.startMicroseconds + durationMicroseconds)) {
+                    insideExternal = true;
+                    break;
+                }
+            }
+            if (!insideExternal) {
+                externalMicroseconds += durationMicroseconds;
+            }
+        }
+    }
+    returnStream << std::endl << "Driver overhead: " << (totalMicroseconds - externalMicroseconds) / 1000.0 << " ms (" << totalMicroseconds / 1000.0 << " ms in total, " 
+                 << externalMicroseconds / 1000.0 << " ms waiting on the compiler and linker)" << std::endl;
+    return returnStream.str();
+}
+
+bool DriverTrace::write(const std::string &filePath) const
+{
+    double totalMicroseconds{this->elapsedMicroseconds()};
+    std::lock_guard<std::mutex> phaseLock{this->m_mutex};
+    ChromeTrace chromeTrace;
+    for (auto &it : this->m_threadIds) {
+        chromeTrace.setThreadName(it.second, (it.second == 1) ? "easyg++" : ("easyg++ thread " + std::to_string(it.second)));
+    }
+    for (auto &it : this->m_phases) {
+        bool unfinished{it.durationMicroseconds < 0.0};
+        chromeTrace.addEvent(TraceEvent{it.name, (it.external ? "compiler/linker" : ""), it.startMicroseconds, 
+                                        (unfinished ? (totalMicroseconds - it.startMicroseconds) : it.durationMicroseconds), it.threadId});
+    }
+    return chromeTrace.write(filePath);
+}
@@ -28,28 +28,49 @@
 #include <vector>
 #include <sstream>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <iterator>
 #include <future>
 #include <chrono>
 #include <cstring>
+#include <ctime>
 #include <list>
 #include <map>
 #include <set>
 
 #include <unistd.h>
 #include <signal.h>
+#include <sys/time.h>
 
 #include <generalutilities.h>
 #include <systemcommand.h>
 #include <fileutilities.h>
 
 #include "easygppstrings.h"
+#include "easygpputilities.h"
 #include "configurationfilereader.h"
+#include "buildscheduler.h"
+#include "timereport.h"
+#include "optimizationremarks.h"
+#include "drivertrace.h"
+#include "benchmarkrunner.h"
+#include "processlauncher.h"
+#include "testrunner.h"
+#include "benchmarkhistory.h"
+#include "samplingprofiler.h"
+#include "cacheprofile.h"
+#include "microbenchharness.h"
+#include "buildmanifest.h"
+#include "compilecache.h"
+#include "headerscanner.h"
+#include "editorlocator.h"
+#include "linkerdetector.h"
 
 using namespace GeneralUtilities;
 using namespace FileUtilities;
 using namespace EasyGppStrings;
+using namespace EasyGppUtilities;
 
 #define SIGNAL_STRING_BUFFER_SIZE 255
 
@@ -102,10 +123,51 @@ bool isSourceCodeFile(const std::string &stringToCheck);
 
 void doLibraryAdditions();
 
+std::string buildDirectoryPath();
+std::string objectFilePath(const std::string &sourceFile);
+uint64_t configurationStampHash();
+std::string normalizedCompileFlags();
+BuildResult compileWithCache(const std::string &sourceFile, const std::string &objectFile, const std::string &compileCommand, const std::string &headerPath);
+std::string compileSwitches();
+std::string linkSwitches();
+bool buildPerTranslationUnit();
+bool buildWithProfileGuidance();
+std::string sourceContentsHash();
+void compareWithBenchmarkHistory(const std::vector<RunSample> &samples, const std::vector<std::string> &programArguments);
+bool runCacheProfile(const std::vector<std::string> &programArguments);
+bool prepareMicrobench();
+bool launchSettingsRequested();
+int runWithLaunchSettings();
+bool runTestCases();
+bool promptForProgramArguments(const std::string &purpose, std::vector<std::string> &programArguments);
+bool autotuneSwitches(const std::vector<std::string> &programArguments);
+bool compareToolchains(const std::vector<std::string> &programArguments);
+std::string singleCommandBuild(const std::string &extraSwitches, const std::string &outputFile);
+std::vector<std::vector<RunSample>> benchmarkInterleaved(const std::vector<std::string> &executables, const std::vector<std::string> &programArguments);
+
+struct CompileUnit
+{
+    std::string description;
+    std::string sourceFile;
+    std::string objectFile;
+    std::vector<std::string> members;
+};
+std::vector<std::vector<std::string>> unityBatches();
+std::string unitySourcePath(const std::vector<std::string> &batch);
+bool writeUnitySource(const std::string &unitySource, const std::vector<std::string> &batch);
+
+std::vector<std::string> commonLeadingIncludes();
+std::string compilerStamp();
+std::string preparePrecompiledHeader();
+std::string precompiledHeaderSwitch(const std::string &headerPath);
+void selectLinker();
+bool enableLinkTimeOptimization();
+bool applyProfile();
+bool debugInformationEnabled();
+
 std::string determineOverrideStandard(const std::string &stringToDetermine);
 std::map<std::string, std::string> getEditorProgramPaths();
 
-bool matchesKnownEditorBinaries(const std::string &binaryNameToCheck);
 void readConfigurationFile();
 std::unique_ptr<ConfigurationFileReader> configurationFileReader;
 
@@ -115,11 +177,53 @@ static bool buildAndRun{false};
 static bool verboseOutput{false};
 static bool libraryOverride{false};
 static bool editorProgramsRetrieved{false};
+static bool perTranslationUnitBuild{true};
+static bool forceRebuild{false};
+static bool compileCacheRequested{false};
+static bool compileCacheDisabled{false};
+static std::unique_ptr<CompileCache> compileCache;
+static unsigned int jobCount{0};
+static bool unityBuild{false};
+static unsigned int unityBatchSize{DEFAULT_UNITY_BATCH_SIZE};
+static bool timeReportRequested{false};
+static bool remarksRequested{false};
+static std::vector<std::string> remarkFileFilters;
+static bool traceDriverRequested{false};
+static std::string driverTracePath{""};
+static unsigned int benchmarkRuns{0};
+static unsigned int samplingFrequency{0};
+static bool cacheProfileRequested{false};
+static std::string microbenchExpression{""};
+static bool autotuneRequested{false};
+static bool compareToolchainsRequested{false};
+static std::vector<std::string> autotuneOptions;
+static std::string autotuneProfileName{""};
+static unsigned int warmupRuns{DEFAULT_WARMUP_RUNS};
+static bool stableRunRequested{false};
+static LaunchSettings launchSettings{{}, false, false, 0, 0, false};
+static std::string testDirectory{""};
+static unsigned int testTimeoutSeconds{DEFAULT_TEST_TIMEOUT_SECONDS};
+//Constructed before main() runs, so every phase is timed from startup
+static DriverTrace driverTrace;
 static std::string mTune{M_TUNE_GENERIC};
 static std::string recordGCCSwitches{RECORD_GCC_SWITCHES};
 static std::string sanitize{F_SANITIZE_UNDEFINED};
 static std::string compilerType{static_cast<std::string>(GPP_COMPILER)};
 static std::string gnuDebugSwitch{static_cast<std::string>(GDB_SWITCH)};
+static std::string profileName{""};
+static std::string profileSwitches{""};
+static bool profileGuidedBuild{false};
+static std::string trainingArguments{""};
+static std::string trainingInputFile{""};
+static std::string profileGuidedSwitches{""};
+static std::string buildDirectoryOverride{""};
+static std::string linkerName{""};
+static std::string linkerSwitch{""};
+static std::string splitDwarfSwitches{""};
+static std::string linkDebugSwitches{""};
+static bool ltoRequested{false};
+static std::string ltoCompileSwitches{""};
+static std::string ltoLinkSwitches{""};
 static std::string executableName{""};
 static std::string staticSwitch{""};
 static std::string staticLibGCCSwitch{""};
@@ -128,12 +232,17 @@ static std::vector<std::string> generalSwitches;
 static std::set<std::string> includePaths;
 static std::set<std::string> libraryPaths;
 static std::set<std::string> librarySwitches;
+static std::set<std::string> commandLineLibrarySwitches;
+static std::map<std::string, std::vector<std::string>> leadingSystemIncludes;
+static bool usePrecompiledHeaders{true};
 static std::string compilerStandard{DEFAULT_CPP_COMPILER_STANDARD};
 
 int main(int argc, char *argv[])
 {
     using namespace FileUtilities;
+    DriverTrace::Span signalHandlerSpan{driverTrace.span("install signal handlers")};
     installSignalHandlers(interruptHandler);
+    signalHandlerSpan.end();
     
     std::cout << std::endl;
     for (int i = 0; i < argc; i++) { 
@@ -146,13 +255,22 @@ int main(int argc, char *argv[])
         } else if (isSwitch(argv[i], CONFIGURATION_FILE_SWITCHES)) {
             displayConfigurationFilePaths();
             return 0;
+        } else if (isSwitch(argv[i], CACHE_STATISTICS_SWITCHES)) {
+            readConfigurationFile();
+            CompileCache cacheForStatistics{COMPILE_CACHE_DIRECTORY, 
+                                            configurationFileReader->compileCacheSize(), 
+                                            configurationFileReader->compileCacheCompression()};
+            std::cout << cacheForStatistics.statistics() << std::endl;
+            return 0;
         }
     }
+    DriverTrace::Span versionSpan{driverTrace.span("display version")};
     displayVersion();
+    versionSpan.end();
 
     auto configFileTask = std::async(std::launch::async, readConfigurationFile);
-    std::future<std::map<std::string, std::string>> editorProgramsTask = std::async(std::launch::async, getEditorProgramPaths);
 
+    DriverTrace::Span argumentSpan{driverTrace.span("parse arguments")};
     for (int i = 0; i < argc; i++) {
         if (isSwitch(argv[i], GCC_SWITCHES)) {
             gccFlag = true;
@@ -227,6 +345,259 @@ int main(int argc, char *argv[])
             recordGCCSwitches = "";
         } else if (isSwitch(argv[i], NO_F_SANITIZE_SWITCHES)) {
             sanitize = "";
+        } else if (isSwitch(argv[i], JOBS_SWITCHES)) {
+            if ((argv[i+1]) && (isUnsignedInteger(static_cast<std::string>(argv[i+1])))) {
+                if (!parseUnsignedInteger(static_cast<std::string>(argv[i+1]), jobCount)) {
+                    std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(argv[i+1]) << " is not a valid job count" << std::endl;
+                    std::cout << "    Falling back on the number of online processors (" << BuildScheduler::defaultJobCount() << ")" << std::endl << std::endl;
+                }
+                i++;
+            }
+        } else if (isEqualsSwitch(argv[i], JOBS_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            std::string jobString{stripAllFromString(copyString.substr(copyString.find("=")+1), "\"")};
+            if (!parseUnsignedInteger(jobString, jobCount)) {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(jobString) << " is not a valid job count" << std::endl;
+                std::cout << "    Falling back on the number of online processors (" << BuildScheduler::defaultJobCount() << ")" << std::endl << std::endl;
+            }
+        } else if (isSwitch(argv[i], UNITY_SWITCHES)) {
+            unityBuild = true;
+            if ((argv[i+1]) && (isUnsignedInteger(static_cast<std::string>(argv[i+1])))) {
+                if (!parseUnsignedInteger(static_cast<std::string>(argv[i+1]), unityBatchSize)) {
+                    std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(argv[i+1]) << " is not a valid batch size" << std::endl;
+                    std::cout << "    Falling back on the default batch size (" << DEFAULT_UNITY_BATCH_SIZE << ")" << std::endl << std::endl;
+                }
+                i++;
+            }
+        } else if (isEqualsSwitch(argv[i], UNITY_SWITCHES)) {
+            unityBuild = true;
+            std::string copyString{static_cast<std::string>(argv[i])};
+            std::string batchString{stripAllFromString(copyString.substr(copyString.find("=")+1), "\"")};
+            if (!parseUnsignedInteger(batchString, unityBatchSize)) {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(batchString) << " is not a valid batch size" << std::endl;
+                std::cout << "    Falling back on the default batch size (" << DEFAULT_UNITY_BATCH_SIZE << ")" << std::endl << std::endl;
+            }
+        } else if (isSwitch(argv[i], SINGLE_COMMAND_SWITCHES)) {
+            perTranslationUnitBuild = false;
+        } else if (isSwitch(argv[i], TIME_REPORT_SWITCHES)) {
+            timeReportRequested = true;
+        } else if (isSwitch(argv[i], REMARKS_SWITCHES)) {
+            remarksRequested = true;
+        } else if (isEqualsSwitch(argv[i], REMARKS_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            remarksRequested = true;
+            for (auto &it : splitOnCharacter(copyString.substr(copyString.find("=")+1), ',')) {
+                if (!isWhitespace(it)) {
+                    remarkFileFilters.emplace_back(it);
+                }
+            }
+        } else if (isSwitch(argv[i], PROFILE_RUN_SWITCHES)) {
+            samplingFrequency = DEFAULT_SAMPLING_FREQUENCY;
+            if ((argv[i+1]) && (isUnsignedInteger(static_cast<std::string>(argv[i+1])))) {
+                if (!parseUnsignedInteger(static_cast<std::string>(argv[i+1]), samplingFrequency)) {
+                    std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(argv[i+1]) << " is not a valid sampling frequency" << std::endl;
+                    std::cout << "    Falling back on the default sampling frequency (" << DEFAULT_SAMPLING_FREQUENCY << " Hz)" << std::endl << std::endl;
+                }
+                samplingFrequency = std::max(1u, samplingFrequency);
+                i++;
+            }
+        } else if (isEqualsSwitch(argv[i], PROFILE_RUN_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            std::string frequencyString{stripAllFromString(copyString.substr(copyString.find("=")+1), "\"")};
+            samplingFrequency = DEFAULT_SAMPLING_FREQUENCY;
+            if ((!parseUnsignedInteger(frequencyString, samplingFrequency)) || (samplingFrequency == 0)) {
+                samplingFrequency = DEFAULT_SAMPLING_FREQUENCY;
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(frequencyString) << " is not a valid sampling frequency" << std::endl;
+                std::cout << "    Falling back on the default sampling frequency (" << DEFAULT_SAMPLING_FREQUENCY << " Hz)" << std::endl << std::endl;
+            }
+        } else if (isSwitch(argv[i], CACHE_PROFILE_SWITCHES)) {
+            cacheProfileRequested = true;
+        } else if (isSwitch(argv[i], MICROBENCH_SWITCHES)) {
+            if (argv[i+1]) {
+                microbenchExpression = static_cast<std::string>(argv[i+1]);
+                i++;
+            } else {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but no function was specified, skipping option" << std::endl << std::endl;
+            }
+        } else if (isEqualsSwitch(argv[i], MICROBENCH_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            microbenchExpression = copyString.substr(copyString.find("=")+1);
+        } else if (isSwitch(argv[i], PROFILE_SWITCHES)) {
+            if (argv[i+1]) {
+                profileName = static_cast<std::string>(argv[i+1]);
+                i++;
+            } else {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but no profile was specified, skipping option" << std::endl << std::endl;
+            }
+        } else if (isEqualsSwitch(argv[i], PROFILE_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            profileName = stripAllFromString(copyString.substr(copyString.find("=")+1), "\"");
+        } else if (isSwitch(argv[i], PGO_SWITCHES)) {
+            profileGuidedBuild = true;
+        } else if (isSwitch(argv[i], PGO_ARGUMENTS_SWITCHES)) {
+            if (argv[i+1]) {
+                trainingArguments = static_cast<std::string>(argv[i+1]);
+                i++;
+            } else {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but no training arguments were specified, skipping option" << std::endl << std::endl;
+            }
+        } else if (isEqualsSwitch(argv[i], PGO_ARGUMENTS_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            trainingArguments = copyString.substr(copyString.find("=")+1);
+        } else if ((isSwitch(argv[i], PGO_INPUT_SWITCHES)) || (isEqualsSwitch(argv[i], PGO_INPUT_SWITCHES))) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            std::string inputFile{(copyString.find("=") != std::string::npos) ? stripAllFromString(copyString.substr(copyString.find("=")+1), "\"") 
+                                                                                : (argv[i+1] ? static_cast<std::string>(argv[i+1]) : "")};
+            if ((copyString.find("=") == std::string::npos) && (argv[i+1])) {
+                i++;
+            }
+            if (!fileExists(inputFile)) {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but training input " << tQuoted(inputFile) << " is not a readable file, skipping option" << std::endl << std::endl;
+            } else {
+                trainingInputFile = inputFile;
+            }
+        } else if (isSwitch(argv[i], LTO_SWITCHES)) {
+            ltoRequested = true;
+        } else if (isSwitch(argv[i], COMPARE_TOOLCHAINS_SWITCHES)) {
+            compareToolchainsRequested = true;
+        } else if (isSwitch(argv[i], AUTOTUNE_SWITCHES)) {
+            autotuneRequested = true;
+        } else if (isEqualsSwitch(argv[i], AUTOTUNE_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            autotuneRequested = true;
+            for (auto &it : splitOnCharacter(copyString.substr(copyString.find("=")+1), ',')) {
+                if (!isWhitespace(it)) {
+                    autotuneOptions.emplace_back(it);
+                }
+            }
+        } else if (isSwitch(argv[i], AUTOTUNE_SAVE_SWITCHES)) {
+            if (argv[i+1]) {
+                autotuneProfileName = static_cast<std::string>(argv[i+1]);
+                i++;
+            } else {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but no profile name was specified, skipping option" << std::endl << std::endl;
+            }
+        } else if (isEqualsSwitch(argv[i], AUTOTUNE_SAVE_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            autotuneProfileName = stripAllFromString(copyString.substr(copyString.find("=")+1), "\"");
+        } else if (isSwitch(argv[i], BENCHMARK_SWITCHES)) {
+            benchmarkRuns = DEFAULT_BENCHMARK_RUNS;
+            if ((argv[i+1]) && (isUnsignedInteger(static_cast<std::string>(argv[i+1])))) {
+                if (!parseUnsignedInteger(static_cast<std::string>(argv[i+1]), benchmarkRuns)) {
+                    std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(argv[i+1]) << " is not a valid run count" << std::endl;
+                    std::cout << "    Falling back on the default run count (" << DEFAULT_BENCHMARK_RUNS << ")" << std::endl << std::endl;
+                }
+                i++;
+            }
+        } else if (isEqualsSwitch(argv[i], BENCHMARK_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            std::string runString{stripAllFromString(copyString.substr(copyString.find("=")+1), "\"")};
+            benchmarkRuns = DEFAULT_BENCHMARK_RUNS;
+            if (!parseUnsignedInteger(runString, benchmarkRuns)) {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(runString) << " is not a valid run count" << std::endl;
+                std::cout << "    Falling back on the default run count (" << DEFAULT_BENCHMARK_RUNS << ")" << std::endl << std::endl;
+            }
+        } else if (isSwitch(argv[i], WARMUP_SWITCHES)) {
+            if ((argv[i+1]) && (isUnsignedInteger(static_cast<std::string>(argv[i+1])))) {
+                if (!parseUnsignedInteger(static_cast<std::string>(argv[i+1]), warmupRuns)) {
+                    std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(argv[i+1]) << " is not a valid run count" << std::endl;
+                    std::cout << "    Falling back on the default warmup run count (" << DEFAULT_WARMUP_RUNS << ")" << std::endl << std::endl;
+                }
+                i++;
+            }
+        } else if (isEqualsSwitch(argv[i], WARMUP_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            std::string runString{stripAllFromString(copyString.substr(copyString.find("=")+1), "\"")};
+            if (!parseUnsignedInteger(runString, warmupRuns)) {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(runString) << " is not a valid run count" << std::endl;
+                std::cout << "    Falling back on the default warmup run count (" << DEFAULT_WARMUP_RUNS << ")" << std::endl << std::endl;
+            }
+        } else if (isSwitch(argv[i], STABLE_RUN_SWITCHES)) {
+            stableRunRequested = true;
+            if ((argv[i+1]) && (ProcessLauncher::parseCpuList(static_cast<std::string>(argv[i+1]), launchSettings.cpus))) {
+                i++;
+            }
+        } else if (isEqualsSwitch(argv[i], STABLE_RUN_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            std::string cpuList{stripAllFromString(copyString.substr(copyString.find("=")+1), "\"")};
+            stableRunRequested = true;
+            if (!ProcessLauncher::parseCpuList(cpuList, launchSettings.cpus)) {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(cpuList) << " is not a valid CPU list (eg " << tQuoted("3") << " or " << tQuoted("2,4-7") << ")" << std::endl;
+                std::cout << "    Falling back on the highest numbered CPU" << std::endl << std::endl;
+            }
+        } else if (isSwitch(argv[i], TEST_TIMEOUT_SWITCHES)) {
+            if ((argv[i+1]) && (isUnsignedInteger(static_cast<std::string>(argv[i+1])))) {
+                if (!parseUnsignedInteger(static_cast<std::string>(argv[i+1]), testTimeoutSeconds)) {
+                    std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(argv[i+1]) << " is not a valid time limit in seconds" << std::endl;
+                    std::cout << "    Falling back on the default time limit (" << DEFAULT_TEST_TIMEOUT_SECONDS << " s)" << std::endl << std::endl;
+                }
+                i++;
+            } else {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but no time limit in seconds was specified, skipping option" << std::endl << std::endl;
+            }
+        } else if (isEqualsSwitch(argv[i], TEST_TIMEOUT_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            std::string limitString{stripAllFromString(copyString.substr(copyString.find("=")+1), "\"")};
+            if (!parseUnsignedInteger(limitString, testTimeoutSeconds)) {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(limitString) << " is not a valid time limit in seconds" << std::endl;
+                std::cout << "    Falling back on the default time limit (" << DEFAULT_TEST_TIMEOUT_SECONDS << " s)" << std::endl << std::endl;
+            }
+        } else if (isSwitch(argv[i], TEST_SWITCHES)) {
+            if (argv[i+1]) {
+                testDirectory = static_cast<std::string>(argv[i+1]);
+                i++;
+            } else {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but no test directory was specified, skipping option" << std::endl << std::endl;
+            }
+        } else if (isEqualsSwitch(argv[i], TEST_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            testDirectory = stripAllFromString(copyString.substr(copyString.find("=")+1), "\"");
+        } else if (isSwitch(argv[i], NO_ASLR_SWITCHES)) {
+            launchSettings.disableAddressRandomization = true;
+        } else if (isSwitch(argv[i], MEMORY_LIMIT_SWITCHES)) {
+            if ((argv[i+1]) && (isUnsignedInteger(static_cast<std::string>(argv[i+1])))) {
+                if (!parseUnsignedInteger(static_cast<std::string>(argv[i+1]), launchSettings.addressSpaceLimitMegabytes, MAXIMUM_MEMORY_LIMIT_MEGABYTES)) {
+                    std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(argv[i+1]) << " is not a valid limit in megabytes, skipping option" << std::endl << std::endl;
+                }
+                i++;
+            } else {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but no limit in megabytes was specified, skipping option" << std::endl << std::endl;
+            }
+        } else if (isEqualsSwitch(argv[i], MEMORY_LIMIT_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            std::string limitString{stripAllFromString(copyString.substr(copyString.find("=")+1), "\"")};
+            if (!parseUnsignedInteger(limitString, launchSettings.addressSpaceLimitMegabytes, MAXIMUM_MEMORY_LIMIT_MEGABYTES)) {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(limitString) << " is not a valid limit in megabytes, skipping option" << std::endl << std::endl;
+            }
+        } else if (isSwitch(argv[i], CPU_LIMIT_SWITCHES)) {
+            if ((argv[i+1]) && (isUnsignedInteger(static_cast<std::string>(argv[i+1])))) {
+                if (!parseUnsignedInteger(static_cast<std::string>(argv[i+1]), launchSettings.cpuTimeLimitSeconds, MAXIMUM_CPU_LIMIT_SECONDS)) {
+                    std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(argv[i+1]) << " is not a valid limit in seconds, skipping option" << std::endl << std::endl;
+                }
+                i++;
+            } else {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but no limit in seconds was specified, skipping option" << std::endl << std::endl;
+            }
+        } else if (isEqualsSwitch(argv[i], CPU_LIMIT_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            std::string limitString{stripAllFromString(copyString.substr(copyString.find("=")+1), "\"")};
+            if (!parseUnsignedInteger(limitString, launchSettings.cpuTimeLimitSeconds, MAXIMUM_CPU_LIMIT_SECONDS)) {
+                std::cout << "WARNING: Switch " << tQuoted(argv[i]) << " accepted, but " << tQuoted(limitString) << " is not a valid limit in seconds, skipping option" << std::endl << std::endl;
+            }
+        } else if (isSwitch(argv[i], TRACE_DRIVER_SWITCHES)) {
+            traceDriverRequested = true;
+        } else if (isEqualsSwitch(argv[i], TRACE_DRIVER_SWITCHES)) {
+            std::string copyString{static_cast<std::string>(argv[i])};
+            traceDriverRequested = true;
+            driverTracePath = stripAllFromString(copyString.substr(copyString.find("=")+1), "\"");
+        } else if (isSwitch(argv[i], REBUILD_SWITCHES)) {
+            forceRebuild = true;
+        } else if (isSwitch(argv[i], NO_PRECOMPILED_HEADER_SWITCHES)) {
+            usePrecompiledHeaders = false;
+        } else if (isSwitch(argv[i], COMPILE_CACHE_SWITCHES)) {
+            compileCacheRequested = true;
+        } else if (isSwitch(argv[i], NO_COMPILE_CACHE_SWITCHES)) {
+            compileCacheDisabled = true;
         } else if (isSwitch(argv[i], INCLUDE_PATH_SWITCHES)) {
             if (argv[i+1]) {
                 std::string tempSwitchDir{static_cast<std::string>(argv[i+1])};
@@ -294,6 +665,9 @@ int main(int argc, char *argv[])
         }
     }
     
+    argumentSpan.end();
+    
+    commandLineLibrarySwitches = librarySwitches;
     if (executableName == "") {
         if (sourceCodeFiles.empty()) {
             std::cout << "ERROR: No source code files specified, exiting " << PROGRAM_NAME << std::endl << std::endl;
@@ -333,7 +707,48 @@ int main(int argc, char *argv[])
         }
     }
     
+    if (profileName != "") {
+        configFileTask.wait();
+        if (!applyProfile()) {
+            return -1;
+        }
+    }
+
+    if (samplingFrequency != 0) {
+        //Stacks are followed through frame pointers, both by perf and by the
+        //fallback sampler, so optimized code has to keep them
+        generalSwitches.emplace_back(FRAME_POINTER_SWITCH);
+        if (!debugInformationEnabled()) {
+            std::cout << "WARNING: the program is built without debug information, so the profile can only show function names, not source lines" << std::endl << std::endl;
+        }
+    }
+
+    if ((microbenchExpression != "") && (!prepareMicrobench())) {
+        return -1;
+    }
+
+    if ((testDirectory != "") && (!directoryExists(testDirectory))) {
+        std::cout << "ERROR: the test directory " << tQuoted(testDirectory) << " does not exist, exiting " << PROGRAM_NAME << std::endl << std::endl;
+        return -1;
+    }
+
+    if (stableRunRequested) {
+        //Pinned to a single CPU unless told otherwise, so the program is
+        //never migrated and keeps its caches warm
+        if (launchSettings.cpus.empty()) {
+            launchSettings.cpus.emplace_back(ProcessLauncher::quietestCpu());
+        }
+        launchSettings.normalizeEnvironment = true;
+        for (auto &it : ProcessLauncher::governorWarnings(launchSettings.cpus)) {
+            std::cout << "WARNING: " << it << ", so the clock speed can change during and between runs" << std::endl;
+        }
+    }
+    if ((launchSettingsRequested()) && (verboseOutput)) {
+        std::cout << "NOTE: the compiled program will be run " << ProcessLauncher{launchSettings}.describe() << std::endl << std::endl;
+    }
+
     while (Pigs.movementState() != MovementState::Flying) {
+        DriverTrace::Span commandSpan{driverTrace.span("assemble command")};
         //compilerType is "g++" by default, but gets overriden by the -c switch
         //gnuDebugSwitch will be " -ggdb " by default unless overriden by the -nd switch
         //staticSwitch will be an empty string unless it is set using the -st switch
@@ -344,6 +759,7 @@ int main(int argc, char *argv[])
                                     + sanitize
                                     + recordGCCSwitches
                                     + gnuDebugSwitch 
+                                    + profileSwitches
                                     + staticSwitch 
                                     + staticLibGCCSwitch};
         if (gccFlag) {
@@ -388,22 +804,71 @@ int main(int argc, char *argv[])
                 std::cout << "WARNING: using the " << tQuoted("-static") << " switch can be very slow on some systems, consider removing it if it takes too long to compile your project" << std::endl << std::endl;
             }
         } 
-        if (configFileTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        commandSpan.end();
+        if (configFileTask.valid()) {
+            DriverTrace::Span configurationWaitSpan{driverTrace.span("wait for configuration file")};
             configFileTask.wait();
         }
-        if (!libraryOverride) {
-            doLibraryAdditions();
-        }
-        for (auto &it : librarySwitches) {
-            systemCommand += (" " + it);
-        }
         for (auto &it : configurationFileReader->output()) {
             std::cout << it << std::endl;
         }
-        std::cout << "Executing below statement:" << std::endl;
-        std::cout << "    " << systemCommand.command() << std::endl << std::endl;
-        systemCommand.executeWithoutPipe();
-        if (!systemCommand.hasError()) {
+        DriverTrace::Span linkerSpan{driverTrace.span("select linker")};
+        selectLinker();
+        linkerSpan.end();
+        if ((ltoRequested) && (!enableLinkTimeOptimization())) {
+            return -1;
+        }
+        if (autotuneRequested) {
+            std::vector<std::string> programArguments;
+            if ((buildAndRun) && (!promptForProgramArguments("benchmark every variant with", programArguments))) {
+                return -1;
+            }
+            return (autotuneSwitches(programArguments) ? 0 : -1);
+        }
+        if (compareToolchainsRequested) {
+            std::vector<std::string> programArguments;
+            if ((buildAndRun) && (!promptForProgramArguments("benchmark both builds with", programArguments))) {
+                return -1;
+            }
+            return (compareToolchains(programArguments) ? 0 : -1);
+        }
+        bool buildSucceeded{false};
+        if (perTranslationUnitBuild) {
+            DriverTrace::Span buildSpan{driverTrace.span("build per translation unit")};
+            buildSucceeded = (profileGuidedBuild ? buildWithProfileGuidance() : buildPerTranslationUnit());
+        } else {
+            if (profileGuidedBuild) {
+                std::cout << "WARNING: a profile guided build keeps its profile data beside the objects, so " << tQuoted("--pgo") << " is ignored with " << tQuoted("--single-command") << std::endl << std::endl;
+            }
+            if (timeReportRequested) {
+                std::cout << "WARNING: a compile time report needs each source file compiled on its own, so " << tQuoted("--time-report") << " is ignored with " << tQuoted("--single-command") << std::endl << std::endl;
+            }
+            if (remarksRequested) {
+                std::cout << "WARNING: optimization remarks are gathered per source file, so " << tQuoted("--remarks") << " is ignored with " << tQuoted("--single-command") << std::endl << std::endl;
+            }
+            if (!libraryOverride) {
+                doLibraryAdditions();
+            }
+            for (auto &it : librarySwitches) {
+                systemCommand += (" " + it);
+            }
+            systemCommand += (linkerSwitch + ltoLinkSwitches);
+            std::cout << "Executing below statement:" << std::endl;
+            std::cout << "    " << systemCommand.command() << std::endl << std::endl;
+            DriverTrace::Span singleCommandSpan{driverTrace.span("compile and link", true)};
+            systemCommand.executeWithoutPipe();
+            singleCommandSpan.end();
+            buildSucceeded = !systemCommand.hasError();
+        }
+        if (traceDriverRequested) {
+            std::cout << driverTrace.summary() << std::endl;
+            if ((driverTracePath != "") && (!driverTrace.write(driverTracePath))) {
+                std::cout << "WARNING: unable to write driver trace to " << tQuoted(driverTracePath) << std::endl << std::endl;
+            } else if (driverTracePath != "") {
+                std::cout << "Driver trace written to " << tQuoted(driverTracePath) << " (open it in chrome://tracing or Perfetto)" << std::endl << std::endl;
+            }
+        }
+        if (buildSucceeded) {
             std::string outputText{ ((sourceCodeFiles.size() > 1) ? "Source files: " : "Source file: ") };
             std::cout << outputText;
             for (auto &it : sourceCodeFiles) {
@@ -424,7 +889,57 @@ int main(int argc, char *argv[])
                 #endif
             }
             std::cout << std::endl;
-            if (buildAndRun) {
+            if (microbenchExpression != "") {
+                //The harness takes no arguments, and its report is its output
+                SystemCommand executeProgram{tQuoted(((executableName[0] == '/') ? "" : "./") + executableName)};
+                std::cout << "Executing below statement:" << std::endl;
+                std::cout << "    " << executeProgram.command() << std::endl << std::endl;
+                executeProgram.executeWithoutPipe();
+                std::cout << std::endl << executableName << " exited with a return value of " << executeProgram.returnValue() << std::endl << std::endl;
+            } else if (testDirectory != "") {
+                if (!runTestCases()) {
+                    return -1;
+                }
+            } else if (samplingFrequency != 0) {
+                std::vector<std::string> programArguments;
+                if (!promptForProgramArguments("profile the compiled program with", programArguments)) {
+                    return -1;
+                }
+                SamplingProfiler samplingProfiler{((executableName[0] == '/') ? "" : "./") + executableName, programArguments, samplingFrequency};
+                std::cout << "Profiling " << tQuoted(executableName) << " at " << samplingFrequency << " samples per second" << std::endl << std::endl;
+                if (!samplingProfiler.run(SAMPLER_DIRECTORY, compilerType)) {
+                    std::cout << "ERROR: perf_event_open is not allowed (see /proc/sys/kernel/perf_event_paranoid), and the fallback sampler could not be built in " << tQuoted(SAMPLER_DIRECTORY) << std::endl << std::endl;
+                    return -1;
+                }
+                std::cout << std::endl << executableName << " exited with a return value of " << samplingProfiler.returnValue() << std::endl << std::endl;
+                std::cout << samplingProfiler.report(PROFILE_RUN_TOP_COUNT) << std::endl;
+                std::string foldedStacksPath{buildDirectoryPath() + "/" + FOLDED_STACKS_NAME};
+                if ((samplingProfiler.sampleCount() != 0) && ((!makeDirectoryPath(buildDirectoryPath())) || (!samplingProfiler.writeFoldedStacks(foldedStacksPath)))) {
+                    std::cout << "WARNING: unable to write folded stacks to " << tQuoted(foldedStacksPath) << std::endl << std::endl;
+                } else if (samplingProfiler.sampleCount() != 0) {
+                    std::cout << "Folded stacks written to " << tQuoted(foldedStacksPath) << " (render a flame graph with " << tQuoted("flamegraph.pl " + foldedStacksPath + " > flamegraph.svg") << ")" << std::endl << std::endl;
+                }
+            } else if (cacheProfileRequested) {
+                std::vector<std::string> programArguments;
+                if ((!promptForProgramArguments("run the compiled program under cachegrind with", programArguments)) || (!runCacheProfile(programArguments))) {
+                    return -1;
+                }
+            } else if (benchmarkRuns != 0) {
+                std::vector<std::string> programArguments;
+                if ((buildAndRun) && (!promptForProgramArguments("benchmark the compiled program with", programArguments))) {
+                    return -1;
+                }
+                BenchmarkRunner benchmarkRunner{((executableName[0] == '/') ? "" : "./") + executableName, programArguments, launchSettings};
+                std::cout << "Benchmarking " << tQuoted(executableName) << " with " << warmupRuns << ((warmupRuns == 1) ? " warmup run" : " warmup runs") 
+                          << " and " << benchmarkRuns << ((benchmarkRuns == 1) ? " timed run" : " timed runs") << " (program output is discarded)" << std::endl << std::endl;
+                std::vector<RunSample> samples{benchmarkRunner.run(warmupRuns, benchmarkRuns)};
+                std::cout << benchmarkRunner.report(samples) << std::endl;
+                compareWithBenchmarkHistory(samples, programArguments);
+            } else if ((buildAndRun) && (launchSettingsRequested())) {
+                if (runWithLaunchSettings() < 0) {
+                    return -1;
+                }
+            } else if (buildAndRun) {
                 std::cout << "Either enter command line arguments to run compiled program (leave blank to run without args), or press CTRL+C to quit:" << std::endl;
                 std::cout << tQuoted("./" + executableName) << " ";
                 std::string commandLineArgs{""};
@@ -494,8 +1009,7 @@ int main(int argc, char *argv[])
         i = 1;
         std::vector<std::string> optionCopy;
         if (!editorProgramsRetrieved) {
-            editorProgramsTask.wait();
-            editorPrograms = editorProgramsTask.get();
+            editorPrograms = getEditorProgramPaths();
             editorProgramsRetrieved = true;
         }
         if (editorPrograms.empty()) {
@@ -567,6 +1081,46 @@ void displayHelp()
     std::cout << "    -h, --h, -no-record, --no-record: Do not include -frecord-gcc-switches switch" << std::endl;
     std::cout << "    -f, --f, -no-fsanitize, --no-fsanitize: Do not include -fsanitize=undefined switch" << std::endl;
     std::cout << "    -p, --p, -config-file, --config-file: List the configuration file paths" << std::endl;
+    std::cout << "    -j, --j, -jobs, --jobs: Set how many source files are compiled in parallel" << std::endl;
+    std::cout << "        Note: may be followed by a job count (eg " << tQuoted("-j 4") << "), the default is the number of online processors" << std::endl;
+    std::cout << "    -single-command, --single-command: Compile and link every source file using one compiler invocation, without keeping objects" << std::endl;
+    std::cout << "    -unity, --unity [N]: Compile source files in batches of about N (default " << DEFAULT_UNITY_BATCH_SIZE << ") included into one translation unit" << std::endl;
+    std::cout << "    -time-report, --time-report: Show which phases, headers, templates and source files take the longest to compile" << std::endl;
+    std::cout << "        Note: also writes a Chrome trace of every compile (" << tQuoted(TIME_TRACE_NAME) << " in the build directory), viewable in chrome://tracing or Perfetto" << std::endl;
+    std::cout << "    -remarks, --remarks[=FILES]: Show why loops were not vectorized and calls were not inlined, by file, function and line" << std::endl;
+    std::cout << "        Note: FILES are comma separated parts of file names to show remarks for (by default every file outside the system headers)" << std::endl;
+    std::cout << "    -trace-driver, --trace-driver[=FILE]: Show how long each phase of " << PROGRAM_NAME << " itself takes, optionally writing a Chrome trace to FILE" << std::endl;
+    std::cout << "    -profile, --profile NAME: Build with the switches of a named profile instead of the defaults, into a directory named after it" << std::endl;
+    std::cout << "        Note: built in profiles are debug, sanitize, release and native, and more can be added with AddProfile(name, switches) in the configuration file" << std::endl;
+    std::cout << "    -pgo, --pgo: Build with profile guidance: build an instrumented executable, run it once to train, then rebuild using the profile" << std::endl;
+    std::cout << "        Note: the profile is reused until the sources, switches or training run change" << std::endl;
+    std::cout << "    -pgo-args, --pgo-args ARGS: Command line arguments for the training run" << std::endl;
+    std::cout << "    -pgo-input, --pgo-input FILE: A file fed to the training run's standard input" << std::endl;
+    std::cout << "    -lto, --lto: Use link time optimization, in parallel (ThinLTO with clang) and with a cache in the build directory for faster relinks" << std::endl;
+    std::cout << "    -compare-toolchains, --compare-toolchains: Build with both " << GPP_COMPILER << " and " << CLANG_COMPILER << " at the same time, and compare compile time, compiler memory, binary size and runtime" << std::endl;
+    std::cout << "    -autotune, --autotune[=CHOICES]: Build every combination of the given switches in parallel, benchmark each and report the fastest" << std::endl;
+    std::cout << "        Note: CHOICES are comma separated, either alternatives (eg " << tQuoted("-O2/-O3") << ") or a switch tried with and without (eg " << tQuoted("-funroll-loops") << ")" << std::endl;
+    std::cout << "        Without CHOICES, AddTuneOption() lines from the configuration file are used, or else a default set" << std::endl;
+    std::cout << "    -autotune-save, --autotune-save NAME: Save the fastest switches found by " << tQuoted("--autotune") << " as profile NAME in the configuration file" << std::endl;
+    std::cout << "    -bench, --bench [N]: Run the compiled program N times (default " << DEFAULT_BENCHMARK_RUNS << ") and report its wall time, CPU time, peak memory and context switches" << std::endl;
+    std::cout << "        Note: combine with " << tQuoted("-r") << " to be asked for the program's command line arguments first" << std::endl;
+    std::cout << "    -test DIR, --test DIR, --test=DIR: Run the compiled program once for every NAME.in/NAME.out pair in DIR, in parallel, with NAME.in as its input, and check that it prints NAME.out" << std::endl;
+    std::cout << "    -test-timeout, --test-timeout SECONDS: Kill a test case that runs longer than SECONDS (default " << DEFAULT_TEST_TIMEOUT_SECONDS << ", 0 for no limit), --memory-limit and --cpu-limit also apply" << std::endl;
+    std::cout << "    -stable, --stable [CPUS]: Run the compiled program (with -r or --bench) pinned to CPUS (eg " << tQuoted("3") << " or " << tQuoted("2,4-7") << ", default the highest numbered CPU) with a fixed size environment, and warn about frequency governors other than performance" << std::endl;
+    std::cout << "    -no-aslr, --no-aslr: Run the compiled program with address space layout randomization turned off" << std::endl;
+    std::cout << "    -memory-limit, --memory-limit MB: Limit the address space of the compiled program to MB megabytes" << std::endl;
+    std::cout << "    -cpu-limit, --cpu-limit SECONDS: Stop the compiled program once it has used SECONDS of CPU time" << std::endl;
+    std::cout << "    -warmup, --warmup N: Run the compiled program N times (default " << DEFAULT_WARMUP_RUNS << ") before benchmarking it, without timing those runs" << std::endl;
+    std::cout << "    -profile-run, --profile-run [HZ]: Run the compiled program under a sampling profiler (default " << DEFAULT_SAMPLING_FREQUENCY << " samples per second) and show its hottest functions" << std::endl;
+    std::cout << "        Note: uses perf_event_open, or a preloaded SIGPROF sampler where perf is not allowed, and writes folded stacks for flame graphs to " << tQuoted(FOLDED_STACKS_NAME) << " in the build directory" << std::endl;
+    std::cout << "    -cache-profile, --cache-profile: Run the compiled program under valgrind's cachegrind and show instruction counts and D1/LL miss rates by function and line" << std::endl;
+    std::cout << "        Note: the results are kept in the build directory, and compared with the previous run's on the next one" << std::endl;
+    std::cout << "    -microbench FUNC, --microbench FUNC, --microbench=FUNC: Build a harness that calls FUNC (a name, or a call such as " << tQuoted("fib(30)") << ") in a loop instead of main(), and report the time per call" << std::endl;
+    std::cout << "    -rebuild, --rebuild: Recompile every source file, even if its object is up to date" << std::endl;
+    std::cout << "    -no-pch, --no-pch: Do not automatically precompile the headers every source file starts with" << std::endl;
+    std::cout << "    -cache, --cache: Reuse objects from the shared compile cache in " << tQuoted(COMPILE_CACHE_DIRECTORY) << std::endl;
+    std::cout << "    -no-cache, --no-cache: Do not use the shared compile cache, even if the configuration file enables it" << std::endl;
+    std::cout << "    -cache-stats, --cache-stats: Display the hit/miss statistics of the shared compile cache" << std::endl;
     std::cout << "Normal gcc and g++ switches can be included as well (-Werror, -03, etc)" << std::endl;
     std::cout << "Default g++ switches used: -Wall -std=c++14" << std::endl;
     std::cout << "Argument: Source code that you want to compile" << std::endl;
@@ -683,103 +1237,1464 @@ std::string determineOverrideStandard(const std::string &stringToDetermine)
 std::map<std::string, std::string> getEditorProgramPaths()
 {
     //Executabe Name, Path
-    std::map<std::string, std::string> returnMap;
-    std::string pathString{static_cast<std::string>(getenv("PATH"))};
-    std::vector<std::string> pathStringVector{parseToContainer<std::vector<std::string>>(pathString.begin(), pathString.end(), PATH_DELIMITER)};
-    if (pathStringVector.empty()) {
+    std::string pathString{(getenv("PATH") != nullptr) ? static_cast<std::string>(getenv("PATH")) : ""};
+    if (pathString.empty()) {
         return std::map<std::string, std::string>{};
     }
-    SystemCommand systemCommand;
-    std::vector<std::string> binaryNamesVector;
-    for (auto &it : pathStringVector) {
-        systemCommand.setCommand("ls " + tQuoted(it));
-        binaryNamesVector = systemCommand.executeAndWaitForOutputAsVector();
-        for (auto &binaryNamesIt : binaryNamesVector) {
-            if (matchesKnownEditorBinaries(binaryNamesIt)) {
-                returnMap.insert( std::make_pair(binaryNamesIt, (it + "/" + binaryNamesIt)) );
+    std::vector<std::string> candidateNames;
+    for (auto &it : KNOWN_EDITOR_BINARIES) {
+        candidateNames.emplace_back(static_cast<std::string>(it));
+        candidateNames.emplace_back(static_cast<std::string>(it) + ".exe");
+    }
+    for (auto &it : configurationFileReader->extraEditors()) {
+        candidateNames.emplace_back(it);
+        candidateNames.emplace_back(it + ".exe");
+    }
+    EditorLocator editorLocator{EDITOR_CACHE_FILE};
+    return editorLocator.findEditors(pathString, candidateNames);
+}
+
+void doLibraryAdditions()
+{
+    DriverTrace::Span librarySpan{driverTrace.span("detect libraries")};
+    leadingSystemIncludes.clear();
+    HeaderScanner headerScanner{configurationFileReader->libraryToHeaderMap()};
+    headerScanner.setIncludePaths(std::vector<std::string>{includePaths.begin(), includePaths.end()});
+    //The scan cache lives with the objects, so single command builds (which
+    //keep nothing on disk) always scan from scratch
+    std::string scanCachePath{perTranslationUnitBuild ? (buildDirectoryPath() + "/" + SCAN_CACHE_NAME) : ""};
+    if ((scanCachePath != "") && (!forceRebuild)) {
+        headerScanner.loadScanCache(scanCachePath);
+    }
+    std::vector<ScanResult> scanResults{headerScanner.scanFiles(sourceCodeFiles, ((jobCount == 0) ? BuildScheduler::defaultJobCount() : jobCount))};
+    if ((scanCachePath != "") && (makeDirectoryPath(buildDirectoryPath()))) {
+        headerScanner.saveScanCache(scanCachePath);
+    }
+    for (size_t i = 0; i < sourceCodeFiles.size(); i++) {
+        if (!scanResults[i].readable) {
+            if (verboseOutput) {
+                std::cout << "WARNING: could not open source file " << tQuoted(sourceCodeFiles[i]) << " for additional library matching, skipping search" << std::endl << std::endl;
+            }
+            continue;
+        }
+        //Only <angle bracket> includes that come before anything else in a file
+        //can be moved into a precompiled header without changing its meaning
+        std::vector<std::string> &leadingIncludes = leadingSystemIncludes[sourceCodeFiles[i]];
+        for (auto &it : scanResults[i].includes) {
+            if ((!it.leading) || (!it.angled)) {
+                break;
             }
+            leadingIncludes.emplace_back("<" + it.headerName + ">");
+        }
+        if (libraryOverride) {
+            continue;
+        }
+        //Libraries are also picked up from headers that the project's own
+        //"quoted" headers include, not just from the source file itself
+        std::vector<IncludeDirective> allIncludes{scanResults[i].includes};
+        allIncludes.insert(allIncludes.end(), scanResults[i].nestedIncludes.begin(), scanResults[i].nestedIncludes.end());
+        for (auto &it : allIncludes) {
+            for (auto &matchIt : headerScanner.librariesFor(it.headerName)) {
+                std::string librarySwitch{((matchIt.second.find("-l") != std::string::npos) || (matchIt.second[0] == '-')) ? matchIt.second : ("-l" + matchIt.second)};
+                auto result = librarySwitches.emplace(librarySwitch);
+                if ((result.second) && (verboseOutput)) {
+                    std::cout << "NOTE: library " << tQuoted(matchIt.second) << " was associated with header file " << tQuoted(matchIt.first) << " from configuration file, so the library has been added to the command line arguments (this behavior can be disabled with the " << tQuoted("--l") << " switch)" << std::endl << std::endl;
+                }
+            }
+            #ifdef __linux__
+                if (it.angled) {
+                    for (auto &pthreadIt : PTHREAD_IDENTIFIERS) {
+                        if (("<" + it.headerName + ">") == pthreadIt) {
+                            librarySwitches.emplace("-lpthread");
+                        }
+                    }
+                }
+            #endif
         }
-        binaryNamesVector.clear();
     }
-    return returnMap;
 }
 
-bool matchesKnownEditorBinaries(const std::string &binaryNameToCheck) 
+std::vector<std::string> commonLeadingIncludes()
 {
-    size_t foundPosition{0};
-    for (auto &iter : KNOWN_EDITOR_BINARIES) {
-        std::string it{static_cast<std::string>(iter)};
-        foundPosition = binaryNameToCheck.find(it);
-        if ((foundPosition != std::string::npos) && (it.length() == binaryNameToCheck.length())) {
-           return true;
-        } else {
-            std::string exeCheck = it + ".exe";
-            size_t foundPosition{binaryNameToCheck.find(exeCheck)};
-            if ((foundPosition != std::string::npos) && (exeCheck.length() == binaryNameToCheck.length())) {
-                return true;
+    //Headers every translation unit starts with, in the order the first
+    //translation unit includes them
+    std::vector<std::string> returnVector;
+    if (leadingSystemIncludes.empty()) {
+        return returnVector;
+    }
+    for (auto &it : leadingSystemIncludes.begin()->second) {
+        bool includedEverywhere{true};
+        for (auto &sourceIt : leadingSystemIncludes) {
+            if (std::find(sourceIt.second.begin(), sourceIt.second.end(), it) == sourceIt.second.end()) {
+                includedEverywhere = false;
+                break;
             }
         }
+        if ((includedEverywhere) && (std::find(returnVector.begin(), returnVector.end(), it) == returnVector.end())) {
+            returnVector.emplace_back(it);
+        }
     }
-    for (auto &it : configurationFileReader->extraEditors()) {
-        if ((foundPosition != std::string::npos) && (it.length() == binaryNameToCheck.length())) {
-           return true;
-        } else {
-            std::string exeCheck = it + ".exe";
-            size_t foundPosition = binaryNameToCheck.find(exeCheck);
-            if ((foundPosition != std::string::npos) && (exeCheck.length() == binaryNameToCheck.length())) {
-                return true;
-            }
+    return returnVector;
+}
+
+void selectLinker()
+{
+    //"auto" probes once for mold, lld or gold (remembered per compiler and
+    //PATH), while "default" leaves the choice to the compiler driver
+    std::string configuredLinker{configurationFileReader->linker()};
+    if (configuredLinker == AUTOMATIC_LINKER) {
+        LinkerDetector linkerDetector{LINKER_CACHE_FILE};
+        linkerName = linkerDetector.detectFastestLinker(compilerType, compilerStamp());
+    } else if (configuredLinker == "default") {
+        linkerName = "";
+    } else {
+        linkerName = configuredLinker;
+        if ((!LinkerDetector::linkerWorks(compilerType, linkerName)) && (verboseOutput)) {
+            std::cout << "WARNING: linker " << tQuoted(linkerName) << " was requested in the configuration file, but " << compilerType << " could not run it" << std::endl << std::endl;
         }
     }
-    return false;
+    linkerSwitch = ((linkerName == "") ? "" : (" -fuse-ld=" + linkerName));
+    if ((verboseOutput) && (linkerName != "")) {
+        std::cout << "NOTE: linking with " << tQuoted(linkerName) << " (this can be changed with SetLinker() in the configuration file)" << std::endl << std::endl;
+    }
 }
 
-void doLibraryAdditions()
+bool enableLinkTimeOptimization()
 {
-    for (auto &it : sourceCodeFiles) {
-        std::ifstream readFromFile;
-        readFromFile.open(it);
-        if (readFromFile.is_open()) {
-            std::string rawString{""};
-            while (std::getline(readFromFile, rawString)) {
-                for (auto &mapIt : configurationFileReader->libraryToHeaderMap()) {
-                    if (rawString.find(mapIt.first) != std::string::npos) {
-                        if ((mapIt.second.find("-l") != std::string::npos) || (mapIt.second[0] == '-')) {
-                            auto result = librarySwitches.emplace(mapIt.second);
-                            if (result.second) {
-                                if (verboseOutput) {
-                                    std::cout << "NOTE: library " << tQuoted(mapIt.second) << " was associated with header file " << tQuoted(mapIt.first) << " from configuration file, so the library has been added to the command line arguments (this behavior can be disabled with the " << tQuoted("--l") << " switch)" << std::endl << std::endl;
-                                }
-                            }
-                        } else {
-                            auto result = librarySwitches.emplace("-l" + mapIt.second);
-                            if (result.second) {
-                                if (verboseOutput) {
-                                    std::cout << "NOTE: library " << tQuoted(mapIt.second) << " was associated with header file " << tQuoted(mapIt.first) << " from configuration file, so the library has been added to the command line arguments (this behavior can be disabled with the " << tQuoted("--l") << " switch)" << std::endl << std::endl;
-                                }
-                            }
-                        }
-                    }
-                }
-                #ifdef __linux__
-                    for (auto &it : PTHREAD_IDENTIFIERS) {
-                        if (rawString.find(it) != std::string::npos) {
-                            librarySwitches.emplace("-lpthread");
-                        }
-                    }
-                #endif
-            }
-            readFromFile.close();
-        } else {
-            if (verboseOutput) {
-                std::cout << "WARNING: could not open source file " << tQuoted(it) << " for additional library matching, skipping search" << std::endl << std::endl;
-            }
+    //Objects only carry the intermediate representation, the optimization
+    //itself runs at link time, split over every core. Keeping the results of
+    //that split (the ThinLTO cache, or incremental LTO in gcc 15 and up) in the
+    //build directory means a relink after a small edit only redoes the parts
+    //that the edit touched
+    std::string cacheDirectory{buildDirectoryPath() + "/" + LTO_CACHE_NAME};
+    if (!makeDirectoryPath(cacheDirectory)) {
+        std::cout << "ERROR: unable to create link time optimization cache directory " << tQuoted(cacheDirectory) << std::endl << std::endl;
+        return false;
+    }
+    if (compilerType == CLANG_COMPILER) {
+        ltoCompileSwitches = CLANG_THIN_LTO_SWITCH;
+        ltoLinkSwitches = CLANG_THIN_LTO_SWITCH + LinkerDetector::thinLtoCacheSwitch(linkerName, tQuoted(cacheDirectory));
+        return true;
+    }
+    //"auto" joins the jobserver of a parent make when there is one, and
+    //otherwise uses every core, but an explicit job count still wins
+    ltoCompileSwitches = GCC_LTO_COMPILE_SWITCH;
+    ltoLinkSwitches = GCC_LTO_LINK_SWITCH + ((jobCount == 0) ? static_cast<std::string>("auto") : toString(jobCount));
+    //This is called on every pass, and once per toolchain when comparing
+    //toolchains, so each compiler is only probed (and warned about) once
+    static std::map<std::string, bool> incrementalSupport;
+    std::string incrementalSwitch{GCC_LTO_INCREMENTAL_SWITCH + tQuoted(cacheDirectory)};
+    auto foundSupport = incrementalSupport.find(compilerType);
+    if (foundSupport == incrementalSupport.end()) {
+        foundSupport = incrementalSupport.emplace(compilerType, (BuildScheduler::runCommand(compilerType + incrementalSwitch + " -E -x c++ /dev/null -o /dev/null").returnValue == 0)).first;
+        if ((!foundSupport->second) && (verboseOutput)) {
+            std::cout << "NOTE: " << compilerType << " has no incremental link time optimization (gcc 15 and up), so every relink redoes all of it" << std::endl << std::endl;
+        }
+    }
+    if (foundSupport->second) {
+        ltoLinkSwitches += incrementalSwitch;
+    }
+    return true;
+}
+
+bool applyProfile()
+{
+    //A profile takes the place of the default -mtune, -fsanitize, -ggdb and
+    //-frecord-gcc-switches switches, and builds into a directory of its own,
+    //so switching between profiles never throws away another one's objects
+    std::map<std::string, std::string> availableProfiles{configurationFileReader->profiles()};
+    availableProfiles.insert(BUILT_IN_PROFILES.begin(), BUILT_IN_PROFILES.end());
+    std::string lowercaseName{profileName};
+    std::transform(lowercaseName.begin(), lowercaseName.end(), lowercaseName.begin(), ::tolower);
+    auto foundProfile = availableProfiles.find(lowercaseName);
+    if (foundProfile == availableProfiles.end()) {
+        std::cout << "ERROR: no profile named " << tQuoted(profileName) << " exists, the available profiles are:" << std::endl;
+        for (auto &it : availableProfiles) {
+            std::cout << "    " << it.first << ": " << it.second << std::endl;
+        }
+        std::cout << "More can be added with AddProfile(name, switches) in the configuration file" << std::endl << std::endl;
+        return false;
+    }
+    profileName = foundProfile->first;
+    profileSwitches = ((foundProfile->second == "") ? "" : (" " + foundProfile->second));
+    mTune = "";
+    sanitize = "";
+    recordGCCSwitches = "";
+    gnuDebugSwitch = "";
+    if (directoryExists(executableName)) {
+        executableName += (((executableName.back() == '/') ? "" : "/") + profileName);
+    } else {
+        executableName = parentDirectory(executableName) + "/" + profileName + "/" + fileBaseName(executableName);
+    }
+    std::string outputDirectory{directoryExists(executableName) ? executableName : parentDirectory(executableName)};
+    if ((!directoryExists(outputDirectory)) && (!makeDirectoryPath(outputDirectory))) {
+        std::cout << "ERROR: unable to create output directory " << tQuoted(outputDirectory) << " for profile " << tQuoted(profileName) << std::endl << std::endl;
+        return false;
+    }
+    if (verboseOutput) {
+        std::cout << "NOTE: using profile " << tQuoted(profileName) << " (" << foundProfile->second << "), building into " << tQuoted(outputDirectory) << std::endl << std::endl;
+    }
+    return true;
+}
+
+bool debugInformationEnabled()
+{
+    if (gnuDebugSwitch != "") {
+        return true;
+    }
+    std::stringstream switchStream{profileSwitches};
+    std::string profileSwitch{""};
+    bool returnValue{false};
+    while (switchStream >> profileSwitch) {
+        if ((profileSwitch.find("-g") == 0) && (profileSwitch.find("-gz") != 0) && (profileSwitch.find("-gsplit") != 0)) {
+            returnValue = (profileSwitch != "-g0");
+        }
+    }
+    return returnValue;
+}
+
+std::string compilerStamp()
+{
+    FileStamp fileStamp{-1, -1};
+    std::string pathString{(getenv("PATH") != nullptr) ? static_cast<std::string>(getenv("PATH")) : ""};
+    for (auto &it : parseToContainer<std::vector<std::string>>(pathString.begin(), pathString.end(), PATH_DELIMITER)) {
+        if (getFileStamp(it + "/" + compilerType, fileStamp)) {
+            return ("@" + toString(fileStamp.modifiedTime) + ":" + toString(fileStamp.size));
+        }
+    }
+    return "";
+}
+
+std::string preparePrecompiledHeader()
+{
+    std::vector<std::string> precompiledHeaders;
+    for (auto &it : configurationFileReader->precompiledHeaders()) {
+        std::string headerName{((it[0] == '<') || (it[0] == '"')) ? it : ("<" + it + ">")};
+        if (std::find(precompiledHeaders.begin(), precompiledHeaders.end(), headerName) == precompiledHeaders.end()) {
+            precompiledHeaders.emplace_back(headerName);
+        }
+    }
+    for (auto &it : commonLeadingIncludes()) {
+        if (std::find(precompiledHeaders.begin(), precompiledHeaders.end(), it) == precompiledHeaders.end()) {
+            precompiledHeaders.emplace_back(it);
+        }
+    }
+    if (precompiledHeaders.empty()) {
+        return "";
+    }
+    std::string headerContents{""};
+    for (auto &it : precompiledHeaders) {
+        headerContents += ("#include " + it + "\n");
+    }
+    std::string precompiledHeaderKey{toHexString(fnv1a64(compileSwitches() + compilerStamp() + "\n" + headerContents))};
+    std::string precompiledHeaderDirectory{PRECOMPILED_HEADER_DIRECTORY + "/" + precompiledHeaderKey};
+    std::string headerPath{precompiledHeaderDirectory + "/" + PRECOMPILED_HEADER_NAME};
+    std::string binaryPath{headerPath + ((compilerType == CLANG_COMPILER) ? ".pch" : ".gch")};
+    if (fileExists(binaryPath)) {
+        return headerPath;
+    }
+    if (!makeDirectoryPath(precompiledHeaderDirectory)) {
+        return "";
+    }
+    std::ofstream writeToFile{headerPath};
+    writeToFile << headerContents;
+    writeToFile.close();
+    //Build beside the final name and rename, so a concurrent easyg++ never
+    //picks up a half written precompiled header
+    std::string temporaryPath{binaryPath + "." + toString(getpid()) + ".tmp"};
+    std::string precompileCommand{compileSwitches() + " -x " + (gccFlag ? "c-header " : "c++-header ") + tQuoted(headerPath) + " -o " + tQuoted(temporaryPath)};
+    std::cout << "Precompiling " << precompiledHeaders.size() << ((precompiledHeaders.size() == 1) ? " header" : " headers") << " into " << tQuoted(binaryPath) << std::endl;
+    if (verboseOutput) {
+        std::cout << "    " << precompileCommand << std::endl;
+    }
+    DriverTrace::Span precompileSpan{driverTrace.span("precompile headers", true)};
+    BuildResult precompileResult{BuildScheduler::runCommand(precompileCommand)};
+    precompileSpan.end();
+    if ((precompileResult.returnValue != 0) || (std::rename(temporaryPath.c_str(), binaryPath.c_str()) != 0)) {
+        std::remove(temporaryPath.c_str());
+        std::cout << "WARNING: unable to precompile headers, continuing without a precompiled header" << std::endl;
+        if (verboseOutput) {
+            std::cout << precompileResult.output;
         }
+        std::cout << std::endl;
+        return "";
+    }
+    return headerPath;
+}
+
+std::string precompiledHeaderSwitch(const std::string &headerPath)
+{
+    if (headerPath == "") {
+        return "";
+    } else if (compilerType == CLANG_COMPILER) {
+        return (" -include-pch " + tQuoted(headerPath + ".pch"));
+    }
+    return (" -include " + tQuoted(headerPath));
+}
+
+std::string buildDirectoryPath()
+{
+    if (buildDirectoryOverride != "") {
+        return buildDirectoryOverride;
+    }
+    return parentDirectory(executableName) + "/" + BUILD_DIRECTORY_NAME + "/" + fileBaseName(executableName);
+}
+
+std::string objectFilePath(const std::string &sourceFile)
+{
+    return buildDirectoryPath() + "/" + flattenPath(sourceFile) + OBJECT_FILE_EXTENSION;
+}
+
+std::string compileSwitches()
+{
+    std::string returnString{compilerType 
+                             + WARNING_LEVEL 
+                             + mTune
+                             + sanitize
+                             + recordGCCSwitches
+                             + gnuDebugSwitch
+                             + profileSwitches
+                             + profileGuidedSwitches
+                             + ltoCompileSwitches
+                             + splitDwarfSwitches};
+    for (auto &it : generalSwitches) {
+        returnString += (" " + it);
+    }
+    for (auto &it : includePaths) {
+        returnString += (" -I " + tQuoted(it));
+    }
+    return returnString + " " + compilerStandard;
+}
+
+std::string linkSwitches()
+{
+    std::string returnString{compilerType 
+                             + sanitize
+                             + gnuDebugSwitch 
+                             + profileSwitches
+                             + profileGuidedSwitches
+                             + staticSwitch 
+                             + staticLibGCCSwitch
+                             + linkerSwitch
+                             + ltoLinkSwitches
+                             + linkDebugSwitches};
+    for (auto &it : generalSwitches) {
+        returnString += (" " + it);
+    }
+    for (auto &it : libraryPaths) {
+        returnString += (" -L " + tQuoted(it));
+    }
+    return returnString;
+}
+
+std::string sourceContentsHash()
+{
+    std::vector<std::string> sortedFiles{sourceCodeFiles};
+    std::sort(sortedFiles.begin(), sortedFiles.end());
+    uint64_t returnHash{fnv1a64("")};
+    for (auto &it : sortedFiles) {
+        std::ifstream readFromFile{it};
+        std::stringstream fileContents;
+        fileContents << readFromFile.rdbuf();
+        returnHash = fnv1a64(it + '\n' + fileContents.str() + '\n', returnHash);
+    }
+    return toHexString(returnHash);
+}
+
+void compareWithBenchmarkHistory(const std::vector<RunSample> &samples, const std::vector<std::string> &programArguments)
+{
+    //Runs are only comparable when the same compiler built the program with
+    //the same flags, and it was given the same arguments
+    BenchmarkEntry benchmarkEntry{static_cast<long long>(time(nullptr)), fileBaseName(executableName), sourceContentsHash(),
+                                  compilerType + compilerStamp(), toHexString(fnv1a64(compileSwitches() + '\n' + linkSwitches())), "", {}};
+    uint64_t argumentsHash{fnv1a64("")};
+    for (auto &it : programArguments) {
+        argumentsHash = fnv1a64(it + '\0', argumentsHash);
+    }
+    benchmarkEntry.argumentsHash = toHexString(argumentsHash);
+    for (auto &it : samples) {
+        if (it.returnValue == 0) {
+            benchmarkEntry.wallMilliseconds.emplace_back(it.wallSeconds * 1000.0);
+        }
+    }
+    if (benchmarkEntry.wallMilliseconds.empty()) {
+        return;
+    }
+    std::string historyPath{buildDirectoryPath() + "/" + BENCHMARK_HISTORY_NAME};
+    BenchmarkHistory benchmarkHistory{historyPath, BENCHMARK_HISTORY_LIMIT};
+    benchmarkHistory.load();
+    const BenchmarkEntry *baseline{benchmarkHistory.baselineFor(benchmarkEntry)};
+    if (baseline) {
+        std::cout << BenchmarkHistory::compare(*baseline, benchmarkEntry, BENCHMARK_SIGNIFICANCE_LEVEL) << std::endl;
+    } else {
+        std::cout << "NOTE: no earlier benchmark of " << tQuoted(executableName) << " with this compiler, these flags and these arguments, so this run becomes the baseline" << std::endl << std::endl;
+    }
+    benchmarkHistory.addEntry(benchmarkEntry);
+    if ((!makeDirectoryPath(buildDirectoryPath())) || (!benchmarkHistory.save())) {
+        std::cout << "WARNING: unable to write benchmark history to " << tQuoted(historyPath) << std::endl << std::endl;
+    }
+}
+
+bool runCacheProfile(const std::vector<std::string> &programArguments)
+{
+    if (BuildScheduler::runCommand(static_cast<std::string>(VALGRIND_PROGRAM) + " --version").returnValue != 0) {
+        std::cout << "ERROR: " << tQuoted("--cache-profile") << " runs the program under valgrind's cachegrind, but " << tQuoted(VALGRIND_PROGRAM) << " was not found on the PATH" << std::endl << std::endl;
+        return false;
+    }
+    if (!makeDirectoryPath(buildDirectoryPath())) {
+        std::cout << "ERROR: unable to create build directory " << tQuoted(buildDirectoryPath()) << std::endl << std::endl;
+        return false;
+    }
+    std::string cachegrindOutput{buildDirectoryPath() + "/" + CACHEGRIND_OUTPUT_NAME};
+    std::remove(cachegrindOutput.c_str());
+    SystemCommand cachegrindCommand{VALGRIND_PROGRAM + static_cast<std::string>(CACHEGRIND_SWITCHES) + " --cachegrind-out-file=" + tQuoted(cachegrindOutput) 
+                                    + " " + tQuoted(((executableName[0] == '/') ? "" : "./") + executableName)};
+    for (auto &it : programArguments) {
+        cachegrindCommand += (" " + tQuoted(it));
+    }
+    std::cout << "Executing below statement:" << std::endl;
+    std::cout << "    " << cachegrindCommand.command() << std::endl << std::endl;
+    cachegrindCommand.executeWithoutPipe();
+    std::cout << std::endl << executableName << " exited with a return value of " << cachegrindCommand.returnValue() << std::endl << std::endl;
+    CacheProfile cacheProfile;
+    if (!cacheProfile.readCachegrindOutput(cachegrindOutput)) {
+        std::cout << "ERROR: unable to read the cachegrind output " << tQuoted(cachegrindOutput) << std::endl << std::endl;
+        return false;
+    }
+    std::cout << cacheProfile.report(CACHE_PROFILE_TOP_COUNT) << std::endl;
+    //The previous run's profile (usually from the previous build) is the
+    //one compared against, and this one replaces it
+    std::string profilePath{buildDirectoryPath() + "/" + CACHE_PROFILE_NAME};
+    CacheProfile previousProfile;
+    if ((previousProfile.load(profilePath)) && (!previousProfile.empty())) {
+        std::cout << cacheProfile.compare(previousProfile, CACHE_PROFILE_TOP_COUNT) << std::endl;
+    } else {
+        std::cout << "NOTE: no earlier cache profile of " << tQuoted(executableName) << ", so this one will be compared against by the next build" << std::endl << std::endl;
+    }
+    if (!cacheProfile.save(profilePath)) {
+        std::cout << "WARNING: unable to write cache profile to " << tQuoted(profilePath) << std::endl << std::endl;
+    }
+    return true;
+}
+
+bool prepareMicrobench()
+{
+    if (gccFlag) {
+        std::cout << "ERROR: " << tQuoted("--microbench") << " generates a C++ harness, so it cannot be used with the gcc switch" << std::endl << std::endl;
+        return false;
+    }
+    //The harness includes the file that defines main(), renaming that main()
+    //out of the way, so everything the file defines stays callable
+    auto mainSource = std::find_if(sourceCodeFiles.begin(), sourceCodeFiles.end(), MicrobenchHarness::definesMain);
+    if (mainSource == sourceCodeFiles.end()) {
+        mainSource = sourceCodeFiles.begin();
+        if (verboseOutput) {
+            std::cout << "WARNING: no source file appears to define main(), so the harness includes " << tQuoted(*mainSource) << std::endl << std::endl;
+        }
+    }
+    //A separate executable, so a harness build never replaces the program
+    //or shares its build directory
+    if (directoryExists(executableName)) {
+        executableName += (((executableName.back() == '/') ? "" : "/") + stripExtension(fileBaseName(*mainSource)));
+    }
+    executableName += MICROBENCH_SUFFIX;
+    if (!makeDirectoryPath(buildDirectoryPath())) {
+        std::cout << "ERROR: unable to create build directory " << tQuoted(buildDirectoryPath()) << std::endl << std::endl;
+        return false;
+    }
+    MicrobenchHarness microbenchHarness{microbenchExpression, MICROBENCH_SAMPLE_COUNT, MICROBENCH_TARGET_SECONDS, MICROBENCH_WARMUP_SECONDS};
+    std::string harnessPath{buildDirectoryPath() + "/" + MICROBENCH_SOURCE_NAME};
+    std::unique_ptr<char, void (*)(void *)> canonicalPath{realpath(mainSource->c_str(), nullptr), free};
+    if (!microbenchHarness.write(harnessPath, (canonicalPath ? static_cast<std::string>(canonicalPath.get()) : *mainSource))) {
+        std::cout << "ERROR: unable to write micro-benchmark harness " << tQuoted(harnessPath) << std::endl << std::endl;
+        return false;
+    }
+    *mainSource = harnessPath;
+    buildAndRun = true;
+
+    bool optimizationSwitch{false};
+    std::stringstream switchStream{profileSwitches};
+    std::string profileSwitch{""};
+    while (switchStream >> profileSwitch) {
+        optimizationSwitch |= (profileSwitch.find("-O") == 0);
+    }
+    for (auto &it : generalSwitches) {
+        optimizationSwitch |= (it.find("-O") == 0);
+    }
+    if (!optimizationSwitch) {
+        std::cout << "NOTE: no optimization switch was given, so " << tQuoted(microbenchHarness.callExpression()) << " is timed unoptimized (add eg " << tQuoted("-O2") << " or use " << tQuoted("--profile release") << ")" << std::endl << std::endl;
+    }
+    if (sanitize != "") {
+        std::cout << "NOTE: the harness is built with" << sanitize << ", whose checks are included in the timings (use " << tQuoted("--no-fsanitize") << " to leave them out)" << std::endl << std::endl;
+    }
+    return true;
+}
+
+bool launchSettingsRequested()
+{
+    return ((!launchSettings.cpus.empty()) || (launchSettings.disableAddressRandomization) || (launchSettings.normalizeEnvironment)
+            || (launchSettings.addressSpaceLimitMegabytes != 0) || (launchSettings.cpuTimeLimitSeconds != 0));
+}
+
+int runWithLaunchSettings()
+{
+    std::vector<std::string> programArguments;
+    if (!promptForProgramArguments("run the compiled program with", programArguments)) {
+        return -1;
+    }
+    ProcessLauncher processLauncher{launchSettings};
+    std::string programPath{((executableName[0] == '/') ? "" : "./") + executableName};
+    std::cout << "Running " << tQuoted(programPath) << " " << processLauncher.describe() << std::endl << std::endl;
+    pid_t childPid{processLauncher.spawn(programPath, programArguments, -1, -1, -1)};
+    if (childPid < 0) {
+        std::cout << "ERROR: unable to start " << tQuoted(programPath) << ": " << strerror(errno) << std::endl << std::endl;
+        return -1;
+    }
+    struct rusage resourceUsage;
+    int returnValue{ProcessLauncher::waitForExit(childPid, &resourceUsage)};
+    std::cout << std::endl << executableName << " exited with a return value of " << returnValue << std::endl;
+    if ((launchSettings.cpuTimeLimitSeconds != 0) && ((returnValue == 128 + SIGXCPU) || (returnValue == 128 + SIGKILL))) {
+        std::cout << "NOTE: the program was stopped at its CPU time limit of " << launchSettings.cpuTimeLimitSeconds << " s" << std::endl;
+    }
+    return returnValue;
+}
+
+bool runTestCases()
+{
+    std::vector<std::string> unpairedInputs;
+    std::vector<TestCase> testCases{TestRunner::findTestCases(testDirectory, unpairedInputs)};
+    for (auto &it : unpairedInputs) {
+        std::cout << "WARNING: " << tQuoted(it) << " has no expected output file next to it, so it is skipped" << std::endl;
+    }
+    if (testCases.empty()) {
+        std::cout << "ERROR: no NAME.in/NAME.out pairs were found in " << tQuoted(testDirectory) << std::endl << std::endl;
+        return false;
+    }
+    //Every case is its own job, so as many run at once as there are cores.
+    //When the program is pinned (--stable) each running case gets a CPU of
+    //its own instead, so cases never share one, and with a single pinned
+    //CPU (the default) they run one at a time
+    std::string programPath{((executableName[0] == '/') ? "" : "./") + executableName};
+    std::vector<int> freeCpus{launchSettings.cpus};
+    std::mutex freeCpusMutex;
+    std::vector<TestResult> testResults(testCases.size());
+    std::vector<BuildJob> testJobs;
+    for (size_t i = 0; i < testCases.size(); i++) {
+        testJobs.emplace_back(BuildJob{testCases[i].name, "", [&programPath, &freeCpus, &freeCpusMutex, &testCases, &testResults, i]() {
+            LaunchSettings caseSettings{launchSettings};
+            if (!caseSettings.cpus.empty()) {
+                std::lock_guard<std::mutex> lock{freeCpusMutex};
+                caseSettings.cpus = std::vector<int>{freeCpus.back()};
+                freeCpus.pop_back();
+            }
+            testResults[i] = TestRunner{programPath, std::vector<std::string>{}, caseSettings, testTimeoutSeconds}.run(testCases[i]);
+            if (!caseSettings.cpus.empty()) {
+                std::lock_guard<std::mutex> lock{freeCpusMutex};
+                freeCpus.emplace_back(caseSettings.cpus.front());
+            }
+            return BuildResult{(testResults[i].passed ? 0 : 1), "", testResults[i].wallSeconds, testResults[i].peakMemoryKilobytes, false, 0.0};
+        }});
+    }
+    BuildScheduler buildScheduler{launchSettings.cpus.empty() ? jobCount : static_cast<unsigned int>(launchSettings.cpus.size())};
+    std::cout << "Testing " << tQuoted(executableName) << " against " << testCases.size() << ((testCases.size() == 1) ? " case" : " cases") << " in " << tQuoted(testDirectory)
+              << " (" << buildScheduler.jobCount() << " at a time";
+    if (testTimeoutSeconds != 0) {
+        std::cout << ", " << testTimeoutSeconds << " s time limit";
+    }
+    if (launchSettings.addressSpaceLimitMegabytes != 0) {
+        std::cout << ", " << launchSettings.addressSpaceLimitMegabytes << " MB memory limit";
+    }
+    if (!launchSettings.cpus.empty()) {
+        std::cout << ", one pinned CPU per case";
+    }
+    std::cout << ")" << std::endl << std::endl;
+    buildScheduler.run(testJobs, [&](size_t jobIndex, const BuildJob &, const BuildResult &) {
+        std::cout << TestRunner::describe(testCases[jobIndex], testResults[jobIndex]) << std::endl;
+    });
+    std::cout << std::endl << TestRunner::summary(testCases, testResults) << std::endl << std::endl;
+    return std::all_of(testResults.begin(), testResults.end(), [](const TestResult &testResult) { return testResult.passed; });
+}
+
+bool promptForProgramArguments(const std::string &purpose, std::vector<std::string> &programArguments)
+{
+    std::cout << "Either enter command line arguments to " << purpose << " (leave blank to run without args), or press CTRL+C to quit:" << std::endl;
+    std::cout << tQuoted("./" + executableName) << " ";
+    std::string commandLineArgs{""};
+    std::getline(std::cin, commandLineArgs);
+    if (!BenchmarkRunner::splitArguments(commandLineArgs, programArguments)) {
+        std::cout << "ERROR: unable to split " << tQuoted(commandLineArgs) << " into arguments, exiting " << PROGRAM_NAME << std::endl << std::endl;
+        return false;
+    }
+    std::cout << std::endl;
+    return true;
+}
+
+std::string singleCommandBuild(const std::string &extraSwitches, const std::string &outputFile)
+{
+    std::string buildCommand{compileSwitches() + extraSwitches + linkerSwitch + ltoLinkSwitches + staticSwitch + staticLibGCCSwitch};
+    for (auto &it : libraryPaths) {
+        buildCommand += (" -L " + tQuoted(it));
+    }
+    buildCommand += (" -o " + tQuoted(outputFile));
+    for (auto &it : sourceCodeFiles) {
+        buildCommand += (" " + tQuoted(it));
+    }
+    for (auto &it : librarySwitches) {
+        buildCommand += (" " + it);
+    }
+    return buildCommand;
+}
+
+std::vector<std::vector<RunSample>> benchmarkInterleaved(const std::vector<std::string> &executables, const std::vector<std::string> &programArguments)
+{
+    //Runs are interleaved (one of every executable per round), so a slow
+    //drift in the machine's state is spread evenly over all of them
+    unsigned int timedRuns{(benchmarkRuns == 0) ? DEFAULT_BENCHMARK_RUNS : benchmarkRuns};
+    std::cout << "Benchmarking " << executables.size() << " builds with " << warmupRuns << ((warmupRuns == 1) ? " warmup run" : " warmup runs") 
+              << " and " << timedRuns << ((timedRuns == 1) ? " timed run" : " timed runs") << " each (program output is discarded)" << std::endl << std::endl;
+    std::vector<BenchmarkRunner> benchmarkRunners;
+    for (auto &it : executables) {
+        benchmarkRunners.emplace_back(BenchmarkRunner{it, programArguments, launchSettings});
+    }
+    for (unsigned int run = 0; run < warmupRuns; run++) {
+        for (auto &it : benchmarkRunners) {
+            it.runOnce();
+        }
+    }
+    std::vector<std::vector<RunSample>> runSamples(benchmarkRunners.size());
+    for (unsigned int run = 0; run < timedRuns; run++) {
+        for (size_t i = 0; i < benchmarkRunners.size(); i++) {
+            runSamples[i].emplace_back(benchmarkRunners[i].runOnce());
+        }
+    }
+    return runSamples;
+}
+
+bool compareToolchains(const std::vector<std::string> &programArguments)
+{
+    //Both toolchains get the same switches, so the gcc-only defaults are
+    //dropped the same way the clang switch drops them
+    mTune = "";
+    sanitize = "";
+    recordGCCSwitches = "";
+    gnuDebugSwitch = "";
+    if (!libraryOverride) {
+        doLibraryAdditions();
+    }
+    //The gcc switch means C sources and a C standard, which clang takes too
+    std::vector<std::string> toolchains{(gccFlag ? GCC_COMPILER : GPP_COMPILER), CLANG_COMPILER};
+    std::string originalCompilerType{compilerType};
+    std::string toolchainDirectory{buildDirectoryPath() + TOOLCHAINS_DIRECTORY_SUFFIX};
+    std::vector<BuildJob> buildJobs;
+    std::vector<std::string> toolchainExecutables;
+    for (auto &it : toolchains) {
+        std::string outputDirectory{toolchainDirectory + "/" + it};
+        if (!makeDirectoryPath(outputDirectory)) {
+            std::cout << "ERROR: unable to create build directory " << tQuoted(outputDirectory) << std::endl << std::endl;
+            compilerType = originalCompilerType;
+            return false;
+        }
+        //The linker is probed per compiler, as not every linker works with both
+        compilerType = it;
+        selectLinker();
+        if ((ltoRequested) && (!enableLinkTimeOptimization())) {
+            compilerType = originalCompilerType;
+            return false;
+        }
+        toolchainExecutables.emplace_back(outputDirectory + "/" + fileBaseName(executableName));
+        buildJobs.emplace_back(BuildJob{it, singleCommandBuild("", toolchainExecutables.back()), nullptr});
+    }
+    compilerType = originalCompilerType;
+    std::cout << "Comparing toolchains: building with " << toolchains[0] << " and " << toolchains[1] << " at the same time into " << tQuoted(toolchainDirectory) << std::endl;
+    BuildScheduler buildScheduler{static_cast<unsigned int>(toolchains.size())};
+    std::vector<BuildResult> buildResults{buildScheduler.run(buildJobs, [&](size_t jobIndex, const BuildJob &buildJob, const BuildResult &buildResult) {
+        std::cout << "[" << jobIndex + 1 << "/" << buildJobs.size() << "] " << buildJob.description << ((buildResult.returnValue == 0) ? "" : " (failed)") << std::endl;
+        if ((verboseOutput) || (buildResult.returnValue != 0)) {
+            std::cout << buildResult.output;
+        }
+    })};
+    std::cout << std::endl;
+    std::vector<size_t> builtToolchains;
+    for (size_t i = 0; i < buildResults.size(); i++) {
+        if (buildResults[i].returnValue == 0) {
+            builtToolchains.emplace_back(i);
+        }
+    }
+    if (builtToolchains.empty()) {
+        std::cout << "ERROR: neither toolchain could build the project" << std::endl << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> builtExecutables;
+    for (auto &it : builtToolchains) {
+        builtExecutables.emplace_back(toolchainExecutables[it]);
+    }
+    std::vector<std::vector<RunSample>> runSamples{benchmarkInterleaved(builtExecutables, programArguments)};
+    std::vector<std::vector<std::string>> rows{{"", toolchains[0], toolchains[1]},
+                                               {"compile wall time (s)", "", ""},
+                                               {"peak compiler memory (MB)", "", ""},
+                                               {"binary size (KB)", "", ""},
+                                               {"runtime mean (ms)", "", ""},
+                                               {"runtime median (ms)", "", ""},
+                                               {"peak runtime memory (MB)", "", ""}};
+    for (size_t i = 0; i < toolchains.size(); i++) {
+        auto foundToolchain = std::find(builtToolchains.begin(), builtToolchains.end(), i);
+        if (foundToolchain == builtToolchains.end()) {
+            for (size_t row = 1; row < rows.size(); row++) {
+                rows[row][i + 1] = "build failed";
+            }
+            continue;
+        }
+        const std::vector<RunSample> &toolchainSamples{runSamples[static_cast<size_t>(foundToolchain - builtToolchains.begin())]};
+        //A binary that crashes straight away looks fast, so failed runs are
+        //left out of the runtime figures, and counted next to them instead
+        std::vector<double> wallMilliseconds;
+        long peakMemoryKilobytes{0};
+        size_t failedRuns{0};
+        for (auto &it : toolchainSamples) {
+            if (it.returnValue != 0) {
+                failedRuns++;
+                continue;
+            }
+            wallMilliseconds.emplace_back(it.wallSeconds * 1000.0);
+            peakMemoryKilobytes = std::max(peakMemoryKilobytes, it.peakMemoryKilobytes);
+        }
+        std::string failedRunsText{toString(failedRuns) + " of " + toString(toolchainSamples.size()) + " runs failed"};
+        SampleSummary sampleSummary{BenchmarkRunner::summarize(wallMilliseconds)};
+        FileStamp fileStamp{-1, -1};
+        getFileStamp(toolchainExecutables[i], fileStamp);
+        std::vector<std::stringstream> cells(rows.size() - 1);
+        for (auto &it : cells) {
+            it << std::fixed << std::setprecision(2);
+        }
+        cells[0] << buildResults[i].elapsedSeconds;
+        cells[1] << static_cast<double>(buildResults[i].peakMemoryKilobytes) / 1024.0;
+        cells[2] << static_cast<double>(fileStamp.size) / 1024.0;
+        if (wallMilliseconds.empty()) {
+            cells[3] << failedRunsText;
+            cells[4] << failedRunsText;
+            cells[5] << failedRunsText;
+        } else {
+            cells[3] << std::setprecision(3) << sampleSummary.mean << " +/- " << BenchmarkRunner::confidenceHalfWidth95(wallMilliseconds);
+            cells[4] << std::setprecision(3) << sampleSummary.median;
+            cells[5] << static_cast<double>(peakMemoryKilobytes) / 1024.0;
+            if (failedRuns != 0) {
+                cells[3] << " (" << failedRunsText << ")";
+            }
+        }
+        for (size_t row = 1; row < rows.size(); row++) {
+            rows[row][i + 1] = cells[row - 1].str();
+        }
+    }
+    size_t columnWidth{22};
+    for (auto &it : rows) {
+        columnWidth = std::max(columnWidth, it[1].length() + 2);
+    }
+    std::cout << "Toolchain comparison:" << std::endl;
+    for (auto &it : rows) {
+        std::stringstream rowLine;
+        rowLine << "    " << std::left << std::setw(28) << it[0] << std::setw(static_cast<int>(columnWidth)) << it[1] << it[2];
+        std::cout << rowLine.str() << std::endl;
+    }
+    std::cout << std::endl;
+    return true;
+}
+
+bool autotuneSwitches(const std::vector<std::string> &programArguments)
+{
+    //Every choice is either a list of alternatives ("-O2/-O3") or a single
+    //switch tried with and without, and every combination is one variant
+    std::vector<std::string> tuneOptions{autotuneOptions};
+    if (tuneOptions.empty()) {
+        tuneOptions = configurationFileReader->tuneOptions();
+    }
+    if (tuneOptions.empty()) {
+        tuneOptions.assign(DEFAULT_TUNE_OPTIONS.begin(), DEFAULT_TUNE_OPTIONS.end());
+    }
+    std::vector<std::string> variants{""};
+    for (auto &it : tuneOptions) {
+        std::vector<std::string> alternatives;
+        for (auto &alternativeIt : splitOnCharacter(it, '/')) {
+            alternatives.emplace_back(trimWhitespace(alternativeIt));
+        }
+        if (alternatives.size() == 1) {
+            alternatives.insert(alternatives.begin(), "");
+        }
+        std::vector<std::string> combinedVariants;
+        for (auto &variantIt : variants) {
+            for (auto &alternativeIt : alternatives) {
+                combinedVariants.emplace_back(variantIt + ((alternativeIt == "") ? "" : (" " + alternativeIt)));
+            }
+        }
+        variants = std::move(combinedVariants);
+        if (variants.size() > AUTOTUNE_VARIANT_LIMIT) {
+            std::cout << "ERROR: the search space has more than " << AUTOTUNE_VARIANT_LIMIT << " combinations, narrow it down with fewer choices" << std::endl << std::endl;
+            return false;
+        }
+    }
+
+    //The variants stand in for the default switches (like a profile does),
+    //so a sanitizer never skews the measurements
+    mTune = "";
+    sanitize = "";
+    recordGCCSwitches = "";
+    gnuDebugSwitch = "";
+    if (!libraryOverride) {
+        doLibraryAdditions();
+    }
+    std::string autotuneDirectory{buildDirectoryPath() + AUTOTUNE_DIRECTORY_SUFFIX};
+    std::vector<BuildJob> buildJobs;
+    std::vector<std::string> variantExecutables;
+    for (size_t i = 0; i < variants.size(); i++) {
+        std::string variantDirectory{autotuneDirectory + "/" + toString(i + 1)};
+        if (!makeDirectoryPath(variantDirectory)) {
+            std::cout << "ERROR: unable to create build directory " << tQuoted(variantDirectory) << std::endl << std::endl;
+            return false;
+        }
+        variantExecutables.emplace_back(variantDirectory + "/" + fileBaseName(executableName));
+        buildJobs.emplace_back(BuildJob{(variants[i] == "") ? "(no extra switches)" : variants[i].substr(1), singleCommandBuild(variants[i], variantExecutables.back()), nullptr});
+    }
+    BuildScheduler buildScheduler{jobCount};
+    std::cout << "Autotuning: building " << variants.size() << " variants into " << tQuoted(autotuneDirectory) << " using " 
+              << std::min<size_t>(buildScheduler.jobCount(), variants.size()) << ((buildScheduler.jobCount() == 1) ? " job" : " jobs") << std::endl;
+    std::vector<size_t> builtVariants;
+    buildScheduler.run(buildJobs, [&](size_t jobIndex, const BuildJob &buildJob, const BuildResult &buildResult) {
+        std::stringstream elapsedTime;
+        elapsedTime << std::fixed << std::setprecision(2) << buildResult.elapsedSeconds;
+        std::cout << "[" << jobIndex + 1 << "/" << buildJobs.size() << "] " << buildJob.description << " (" << elapsedTime.str() << "s" 
+                  << ((buildResult.returnValue == 0) ? "" : ", failed, leaving it out") << ")" << std::endl;
+        if ((verboseOutput) || ((buildResult.returnValue != 0) && (jobIndex == 0))) {
+            std::cout << buildResult.output;
+        }
+        if (buildResult.returnValue == 0) {
+            builtVariants.emplace_back(jobIndex);
+        }
+    });
+    std::cout << std::endl;
+    if (builtVariants.empty()) {
+        std::cout << "ERROR: none of the variants could be built" << std::endl << std::endl;
+        return false;
+    }
+    std::sort(builtVariants.begin(), builtVariants.end());
+
+    std::vector<std::string> builtExecutables;
+    for (auto &it : builtVariants) {
+        builtExecutables.emplace_back(variantExecutables[it]);
+    }
+    std::vector<std::vector<RunSample>> runSamples{benchmarkInterleaved(builtExecutables, programArguments)};
+    //A failed run (a crash at startup, say, from a miscompile) is fast for
+    //the wrong reason, so it never counts towards a variant's time, and a
+    //variant with any failed run ranks below every variant without one
+    std::vector<std::vector<double>> wallMilliseconds(runSamples.size());
+    std::vector<size_t> failedRuns(runSamples.size(), 0);
+    for (size_t i = 0; i < runSamples.size(); i++) {
+        for (auto &it : runSamples[i]) {
+            if (it.returnValue != 0) {
+                failedRuns[i]++;
+            } else {
+                wallMilliseconds[i].emplace_back(it.wallSeconds * 1000.0);
+            }
+        }
+    }
+
+    std::vector<size_t> ranking(runSamples.size());
+    std::vector<double> means(runSamples.size());
+    std::vector<double> halfWidths(runSamples.size());
+    for (size_t i = 0; i < runSamples.size(); i++) {
+        ranking[i] = i;
+        means[i] = BenchmarkRunner::summarize(wallMilliseconds[i]).mean;
+        halfWidths[i] = BenchmarkRunner::confidenceHalfWidth95(wallMilliseconds[i]);
+    }
+    std::sort(ranking.begin(), ranking.end(), [&means, &failedRuns, &wallMilliseconds](size_t lhs, size_t rhs) {
+        if ((failedRuns[lhs] == 0) != (failedRuns[rhs] == 0)) {
+            return (failedRuns[lhs] == 0);
+        }
+        if (wallMilliseconds[lhs].empty() != wallMilliseconds[rhs].empty()) {
+            return wallMilliseconds[rhs].empty();
+        }
+        return (means[lhs] < means[rhs]);
+    });
+    std::cout << "Autotuning results (mean wall time with its 95% confidence interval):" << std::endl;
+    for (size_t i = 0; i < ranking.size(); i++) {
+        size_t variantIndex{builtVariants[ranking[i]]};
+        std::stringstream resultLine;
+        resultLine << std::fixed << std::setprecision(3) << "    " << std::setw(2) << i + 1 << ". ";
+        if (wallMilliseconds[ranking[i]].empty()) {
+            resultLine << std::setw(26) << std::left << "every run failed" << std::right;
+        } else {
+            resultLine << std::setw(10) << means[ranking[i]] << " ms +/- " << std::setw(8) << std::left << halfWidths[ranking[i]] << std::right;
+        }
+        resultLine << "  " << buildJobs[variantIndex].description;
+        if (failedRuns[ranking[i]] != 0) {
+            resultLine << " (" << failedRuns[ranking[i]] << " of " << runSamples[ranking[i]].size() << " runs exited with a non-zero return value)";
+        }
+        std::cout << resultLine.str() << std::endl;
+    }
+    size_t winner{ranking.front()};
+    if (failedRuns[winner] != 0) {
+        std::cout << std::endl << "ERROR: every variant had runs that exited with a non-zero return value, so none of them can be called the fastest" 
+                  << ((autotuneProfileName != "") ? " (and no profile was saved)" : "") << std::endl << std::endl;
+        return false;
+    }
+    std::string winningSwitches{trimWhitespace(profileSwitches + variants[builtVariants[winner]])};
+    std::cout << std::endl << "Fastest: " << ((winningSwitches == "") ? "(no extra switches)" : winningSwitches) << std::endl;
+    if ((ranking.size() > 1) && (failedRuns[ranking[1]] == 0) && (means[winner] + halfWidths[winner] >= means[ranking[1]] - halfWidths[ranking[1]])) {
+        std::cout << "NOTE: the confidence intervals of the two fastest variants overlap, so more runs (eg " << tQuoted("--bench 30") << ") are needed to tell them apart" << std::endl;
+    }
+    std::cout << std::endl;
+
+    if (autotuneProfileName != "") {
+        std::string profileLine{"AddProfile(" + autotuneProfileName + ", " + winningSwitches + ")"};
+        std::ofstream writeToFile;
+        if (fileExists(DEFAULT_CONFIGURATION_FILE)) {
+            writeToFile.open(DEFAULT_CONFIGURATION_FILE, std::ios::app);
+        }
+        if (!writeToFile.is_open()) {
+            std::cout << "WARNING: unable to add the winning switches to " << tQuoted(DEFAULT_CONFIGURATION_FILE) << ", add this line to use them as a profile:" << std::endl;
+            std::cout << "    " << profileLine << std::endl << std::endl;
+            return true;
+        }
+        writeToFile << profileLine << std::endl;
+        std::cout << "Saved the winning switches to " << tQuoted(DEFAULT_CONFIGURATION_FILE) << " as profile " << tQuoted(autotuneProfileName) 
+                  << ", build with them using " << tQuoted("--profile " + autotuneProfileName) << std::endl << std::endl;
+    }
+    return true;
+}
+
+uint64_t configurationStampHash()
+{
+    //Libraries are detected from the configuration file, so any change to
+    //which one exists (or to its contents) invalidates the remembered set
+    uint64_t returnHash{fnv1a64("")};
+    for (auto &it : {DEFAULT_CONFIGURATION_FILE, BACKUP_CONFIGURATION_FILE, LAST_CHANCE_CONFIGURATION_FILE}) {
+        FileStamp fileStamp{-1, -1};
+        getFileStamp(it, fileStamp);
+        returnHash = fnv1a64(it + ":" + toString(fileStamp.modifiedTime) + ":" + toString(fileStamp.size), returnHash);
+    }
+    return returnHash;
+}
+
+std::string normalizedCompileFlags()
+{
+    //Everything that can change the object made from already preprocessed
+    //source. Include paths and macro definitions have done their work by the
+    //time the preprocessor is finished, so they are left out of the key
+    std::string returnString{compilerType + compilerStamp()};
+    returnString += (static_cast<std::string>(WARNING_LEVEL) + mTune + sanitize + recordGCCSwitches + gnuDebugSwitch + profileSwitches + ltoCompileSwitches + splitDwarfSwitches + " " + compilerStandard);
+    for (auto &it : generalSwitches) {
+        if ((it.find("-D") == 0) || (it.find("-U") == 0) || (it.find("-I") == 0)) {
+            continue;
+        }
+        returnString += (" " + it);
+    }
+    //Debug information records the working directory, so (like ccache)
+    //objects built with it are only shared between builds from the same one
+    if (debugInformationEnabled()) {
+        std::unique_ptr<char, void (*)(void *)> workingDirectory{getcwd(nullptr, 0), free};
+        returnString += (" @" + static_cast<std::string>(workingDirectory ? workingDirectory.get() : ""));
+    }
+    return returnString;
+}
+
+BuildResult compileWithCache(const std::string &sourceFile, const std::string &objectFile, const std::string &compileCommand, const std::string &headerPath)
+{
+    //The dependency file is written during preprocessing, because on a hit
+    //the compiler never runs, but the manifest still needs the inputs
+    auto startTime = std::chrono::steady_clock::now();
+    std::string preprocessedFile{objectFile + (gccFlag ? ".i" : ".ii")};
+    std::string preprocessCommand{compileSwitches() + ((headerPath == "") ? "" : (" -include " + tQuoted(headerPath))) + " -E -MMD -MF " + tQuoted(objectFile + ".d") + " -MT " + tQuoted(objectFile) 
+                                  + " " + tQuoted(sourceFile) + " -o " + tQuoted(preprocessedFile)};
+    BuildResult preprocessResult{BuildScheduler::runCommand(preprocessCommand)};
+    if (preprocessResult.returnValue != 0) {
+        std::remove(preprocessedFile.c_str());
+        return BuildScheduler::runCommand(compileCommand);
+    }
+    std::string cacheKey{CompileCache::makeKey(preprocessedFile, normalizedCompileFlags())};
+    std::remove(preprocessedFile.c_str());
+    BuildResult buildResult{0, "", 0.0, 0, true, 0.0};
+    if ((cacheKey != "") && (compileCache->fetch(cacheKey, objectFile, buildResult.output))) {
+        buildResult.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return buildResult;
+    }
+    buildResult = BuildScheduler::runCommand(compileCommand);
+    if ((buildResult.returnValue == 0) && (cacheKey != "")) {
+        compileCache->store(cacheKey, objectFile, buildResult.output);
+    }
+    buildResult.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return buildResult;
+}
+
+bool buildPerTranslationUnit()
+{
+    if (!makeDirectoryPath(buildDirectoryPath())) {
+        std::cout << "ERROR: unable to create build directory " << tQuoted(buildDirectoryPath()) << std::endl << std::endl;
+        return false;
+    }
+    DriverTrace::Span manifestSpan{driverTrace.span("load build manifest")};
+    BuildManifest buildManifest{buildDirectoryPath() + "/" + BUILD_MANIFEST_NAME};
+    if (!forceRebuild) {
+        buildManifest.load();
+    }
+    manifestSpan.end();
+    //Objects restored from the compile cache were not timed, so the cache is
+    //left out while a time report is being gathered
+    std::unique_ptr<TimeReport> timeReport{timeReportRequested ? new TimeReport{compilerType == CLANG_COMPILER} : nullptr};
+    //Remarks are printed while compiling, so the same goes for them
+    std::unique_ptr<OptimizationRemarks> optimizationRemarks{remarksRequested ? new OptimizationRemarks{compilerType == CLANG_COMPILER, remarkFileFilters} : nullptr};
+    //The profile data is an input the compile cache's key knows nothing about
+    if ((!compileCacheDisabled) && (!timeReport) && (!optimizationRemarks) && (!profileGuidedBuild) && ((compileCacheRequested) || (configurationFileReader->compileCacheEnabled()))) {
+        if (!compileCache) {
+            compileCache = std::unique_ptr<CompileCache>{new CompileCache{COMPILE_CACHE_DIRECTORY, 
+                                                                          configurationFileReader->compileCacheSize(),
+                                                                          configurationFileReader->compileCacheCompression()}};
+            if ((configurationFileReader->compileCacheCompression()) && (!compileCache->compressionAvailable()) && (verboseOutput)) {
+                std::cout << "WARNING: compile cache compression was requested, but " << PROGRAM_NAME << " was built without zlib, so objects will be stored uncompressed" << std::endl << std::endl;
+            }
+        }
+    }
+    //A unity batch that failed to compile (usually two of its files defining
+    //the same internal name) stays split apart while its members are unchanged
+    std::set<std::string> splitBatches{buildManifest.splitUnityBatches()};
+    std::set<std::string> currentBatches;
+    std::vector<CompileUnit> compileUnits;
+    auto collectCompileUnits = [&]() {
+        compileUnits.clear();
+        currentBatches.clear();
+        if (!unityBuild) {
+            for (auto &it : sourceCodeFiles) {
+                compileUnits.emplace_back(CompileUnit{it, it, objectFilePath(it), {it}});
+            }
+            return;
+        }
+        for (auto &it : unityBatches()) {
+            std::string unitySource{unitySourcePath(it)};
+            std::string batchName{stripExtension(fileBaseName(unitySource))};
+            currentBatches.emplace(batchName);
+            if ((it.size() == 1) || (splitBatches.find(batchName) != splitBatches.end())) {
+                for (auto &memberIt : it) {
+                    compileUnits.emplace_back(CompileUnit{memberIt, memberIt, objectFilePath(memberIt), {memberIt}});
+                }
+                continue;
+            }
+            if (!writeUnitySource(unitySource, it)) {
+                std::cout << "WARNING: unable to write unity source " << tQuoted(unitySource) << ", compiling its files separately" << std::endl << std::endl;
+                for (auto &memberIt : it) {
+                    compileUnits.emplace_back(CompileUnit{memberIt, memberIt, objectFilePath(memberIt), {memberIt}});
+                }
+                continue;
+            }
+            std::string description{batchName + " ("};
+            for (auto &memberIt : it) {
+                description += (((&memberIt == &it.front()) ? "" : ", ") + memberIt);
+            }
+            compileUnits.emplace_back(CompileUnit{description + ")", unitySource, buildDirectoryPath() + "/" + fileBaseName(unitySource) + OBJECT_FILE_EXTENSION, it});
+        }
+    };
+    collectCompileUnits();
+
+    //Objects restored from the compile cache come without their .dwo files,
+    //so debug information is only split out when the cache is not in use
+    //(and never with link time optimization, which cannot split it)
+    if ((configurationFileReader->splitDwarf()) && (debugInformationEnabled()) && (!compileCache) && (ltoCompileSwitches == "")) {
+        splitDwarfSwitches = SPLIT_DWARF_SWITCHES;
+        linkDebugSwitches = static_cast<std::string>(COMPRESSED_DEBUG_SWITCH) + (LinkerDetector::supportsGdbIndex(linkerName) ? GDB_INDEX_SWITCH : "");
+    }
+
+    std::vector<BuildJob> compileJobs;
+    std::vector<size_t> compiledUnits;
+    std::vector<uint64_t> compiledHashes;
+    std::set<std::string> allObjects;
+    auto queueStaleObjects = [&](const std::string &headerPath) {
+        DriverTrace::Span staleObjectSpan{driverTrace.span("check objects")};
+        compileJobs.clear();
+        compiledUnits.clear();
+        compiledHashes.clear();
+        std::string baseCommand{compileSwitches() + precompiledHeaderSwitch(headerPath) + (timeReport ? timeReport->compileSwitches() : "") + (optimizationRemarks ? optimizationRemarks->compileSwitches() : "")};
+        for (size_t i = 0; i < compileUnits.size(); i++) {
+            std::string sourceFile{compileUnits[i].sourceFile};
+            std::string objectFile{compileUnits[i].objectFile};
+            std::string compileCommand{baseCommand + " -MMD -MF " + tQuoted(objectFile + ".d") + " -c " + tQuoted(sourceFile) + " -o " + tQuoted(objectFile)};
+            uint64_t commandHash{fnv1a64(compileCommand)};
+            allObjects.emplace(objectFile);
+            if (!buildManifest.objectIsUpToDate(objectFile, commandHash)) {
+                compileJobs.emplace_back(BuildJob{compileUnits[i].description, compileCommand, nullptr});
+                if (compileCache) {
+                    compileJobs.back().action = [sourceFile, objectFile, compileCommand, headerPath]() {
+                        return compileWithCache(sourceFile, objectFile, compileCommand, headerPath);
+                    };
+                }
+                compiledUnits.emplace_back(i);
+                compiledHashes.emplace_back(commandHash);
+            }
+        }
+    };
+
+    //Scanning the sources (for libraries and for headers worth precompiling)
+    //means reading every one of them, but when no input of any object changed
+    //(and neither did the configuration file) the results from last time are
+    //still correct, so only stat() calls are needed
+    uint64_t configurationHash{configurationStampHash()};
+    bool configurationUnchanged{buildManifest.configurationHash() == configurationHash};
+    std::string headerPath{((configurationUnchanged) && (usePrecompiledHeaders)) ? buildManifest.precompiledHeader() : ""};
+    if ((headerPath != "") && (!fileExists(headerPath + ((compilerType == CLANG_COMPILER) ? ".pch" : ".gch")))) {
+        configurationUnchanged = false;
+        headerPath = "";
+    }
+    queueStaleObjects(headerPath);
+    buildManifest.forgetObjectsExcept(allObjects);
+    librarySwitches = commandLineLibrarySwitches;
+    if ((compileJobs.empty()) && (configurationUnchanged)) {
+        if (!libraryOverride) {
+            librarySwitches.insert(buildManifest.libraries().begin(), buildManifest.libraries().end());
+        }
+    } else {
+        doLibraryAdditions();
+        std::string previousHeaderPath{headerPath};
+        headerPath = (usePrecompiledHeaders ? preparePrecompiledHeader() : "");
+        if (headerPath != previousHeaderPath) {
+            queueStaleObjects(headerPath);
+        }
+    }
+    buildManifest.setPrecompiledHeader(headerPath);
+    std::set<std::string> detectedLibraries;
+    std::set_difference(librarySwitches.begin(), librarySwitches.end(),
+                        commandLineLibrarySwitches.begin(), commandLineLibrarySwitches.end(),
+                        std::inserter(detectedLibraries, detectedLibraries.begin()));
+    buildManifest.setLibraries(detectedLibraries);
+    buildManifest.setConfigurationHash(configurationHash);
+
+    auto makeLinkCommand = [&]() {
+        std::string returnString{linkSwitches() + " -o " + tQuoted(executableName)};
+        for (auto &it : compileUnits) {
+            returnString += (" " + tQuoted(it.objectFile));
+        }
+        for (auto &it : librarySwitches) {
+            returnString += (" " + it);
+        }
+        return returnString;
+    };
+    std::string linkCommand{makeLinkCommand()};
+    uint64_t linkHash{fnv1a64(linkCommand)};
+    if ((compileJobs.empty()) && (buildManifest.linkIsUpToDate(executableName, linkHash))) {
+        std::cout << "Project " << tQuoted(executableName) << " is up to date, nothing to compile" << std::endl << std::endl;
+        if (timeReport) {
+            std::cout << "NOTE: no source files were compiled, so there is no compile time report (use " << tQuoted("--rebuild") << " to time every source file)" << std::endl << std::endl;
+        }
+        if (optimizationRemarks) {
+            std::cout << "NOTE: no source files were compiled, so there are no optimization remarks (use " << tQuoted("--rebuild") << " to see them for every source file)" << std::endl << std::endl;
+        }
+        buildManifest.save();
+        return true;
+    }
+
+    bool compileFailed{false};
+    //Failed unity batches by name, with their members
+    std::map<std::string, std::vector<std::string>> failedBatches;
+    std::set<std::string> failedSources;
+    auto compileStaleObjects = [&]() {
+        BuildScheduler buildScheduler{jobCount};
+        size_t usedJobs{std::min<size_t>(buildScheduler.jobCount(), compileJobs.size())};
+        std::string unitName{unityBuild ? " translation unit" : " source file"};
+        std::cout << "Compiling " << compileJobs.size() << " of " << compileUnits.size() << unitName << ((compileUnits.size() == 1) ? "" : "s") 
+                  << " using " << usedJobs << ((usedJobs == 1) ? " job" : " jobs") << std::endl;
+        long long compileStartTime{currentFileSystemTime()};
+        DriverTrace::Span compileSpan{driverTrace.span("compile", true)};
+        buildScheduler.run(compileJobs, [&](size_t jobIndex, const BuildJob &buildJob, const BuildResult &buildResult) {
+            const CompileUnit &compileUnit = compileUnits[compiledUnits[jobIndex]];
+            std::stringstream elapsedTime;
+            elapsedTime << std::fixed << std::setprecision(2) << buildResult.elapsedSeconds;
+            std::cout << "[" << jobIndex + 1 << "/" << compileJobs.size() << "] " << buildJob.description 
+                      << " (" << elapsedTime.str() << "s" << (buildResult.fromCache ? ", cached" : "") << ")" << std::endl;
+            if (verboseOutput) {
+                std::cout << "    " << buildJob.command << std::endl;
+            }
+            if ((buildResult.returnValue != 0) && (compileUnit.members.size() > 1)) {
+                //The real errors (if any) are shown when the files are
+                //compiled on their own, which also points at the right file
+                failedBatches.emplace(stripExtension(fileBaseName(compileUnit.sourceFile)), compileUnit.members);
+                std::cout << "NOTE: unity batch failed to compile, its " << compileUnit.members.size() << " source files will be compiled separately" << std::endl;
+                if (verboseOutput) {
+                    std::cout << buildResult.output;
+                }
+                return;
+            }
+            BuildResult reportedResult{buildResult};
+            if (optimizationRemarks) {
+                reportedResult.output = optimizationRemarks->addTranslationUnit(compileUnit.objectFile, buildResult.output);
+            }
+            std::cout << (timeReport ? timeReport->addTranslationUnit(compileUnit.description, compileUnit.objectFile, reportedResult) : reportedResult.output);
+            if (buildResult.returnValue == 0) {
+                buildManifest.recordObject(compileUnit.objectFile, compiledHashes[jobIndex], compileUnit.objectFile + ".d", compileStartTime);
+            } else {
+                compileFailed = true;
+                failedSources.insert(compileUnit.members.begin(), compileUnit.members.end());
+            }
+        });
+        std::cout << std::endl;
+    };
+    if (!compileJobs.empty()) {
+        compileStaleObjects();
+    }
+    if (!failedBatches.empty()) {
+        for (auto &it : failedBatches) {
+            splitBatches.emplace(it.first);
+        }
+        collectCompileUnits();
+        queueStaleObjects(headerPath);
+        if (!compileJobs.empty()) {
+            compileStaleObjects();
+        }
+        linkCommand = makeLinkCommand();
+        linkHash = fnv1a64(linkCommand);
+        //A batch is only kept split when its members compile on their own,
+        //otherwise it was an ordinary compile error and the batch goes back
+        //to being built as one unit once that is fixed
+        for (auto &it : failedBatches) {
+            if (std::any_of(it.second.begin(), it.second.end(), [&](const std::string &member) { return (failedSources.find(member) != failedSources.end()); })) {
+                splitBatches.erase(it.first);
+            }
+        }
+    }
+    std::set<std::string> remainingSplitBatches;
+    std::set_intersection(splitBatches.begin(), splitBatches.end(),
+                          currentBatches.begin(), currentBatches.end(),
+                          std::inserter(remainingSplitBatches, remainingSplitBatches.begin()));
+    buildManifest.setSplitUnityBatches(remainingSplitBatches);
+    if ((timeReport) && (timeReport->translationUnitCount() == 0)) {
+        std::cout << "NOTE: no source files were compiled, so there is no compile time report (use " << tQuoted("--rebuild") << " to time every source file)" << std::endl << std::endl;
+    } else if (timeReport) {
+        std::string tracePath{buildDirectoryPath() + "/" + TIME_TRACE_NAME};
+        std::cout << timeReport->summary(TIME_REPORT_TOP_COUNT) << std::endl;
+        if (timeReport->writeTrace(tracePath)) {
+            std::cout << "Compile time trace written to " << tQuoted(tracePath) << " (open it in chrome://tracing or Perfetto)" << std::endl << std::endl;
+        } else {
+            std::cout << "WARNING: unable to write compile time trace to " << tQuoted(tracePath) << std::endl << std::endl;
+        }
+    }
+    if ((optimizationRemarks) && (optimizationRemarks->remarkCount() == 0)) {
+        std::cout << "NOTE: the compiler made no optimization remarks about these files (remarks need optimization turned on, eg " << tQuoted("--profile release") << ")" << std::endl << std::endl;
+    } else if (optimizationRemarks) {
+        std::cout << optimizationRemarks->summary() << std::endl;
+    }
+    if (compileFailed) {
+        buildManifest.save();
+        return false;
+    }
+    std::cout << "Executing below statement:" << std::endl;
+    std::cout << "    " << linkCommand << std::endl << std::endl;
+    DriverTrace::Span linkSpan{driverTrace.span("link", true)};
+    BuildResult linkResult{BuildScheduler::runCommand(linkCommand)};
+    linkSpan.end();
+    std::cout << linkResult.output;
+    if (linkResult.returnValue == 0) {
+        buildManifest.recordLink(executableName, linkHash);
+    }
+    if ((!buildManifest.save()) && (verboseOutput)) {
+        std::cout << "WARNING: unable to write build manifest to " << tQuoted(buildDirectoryPath()) << ", the next build will recompile everything" << std::endl << std::endl;
+    }
+    return (linkResult.returnValue == 0);
+}
+
+bool buildWithProfileGuidance()
+{
+    //Instrumented and optimized objects share one build directory of their
+    //own, so gcc finds each .gcda file beside the object it belongs to
+    bool clangProfile{compilerType == CLANG_COMPILER};
+    buildDirectoryOverride = buildDirectoryPath() + PGO_BUILD_DIRECTORY_SUFFIX;
+    std::string profileDirectory{buildDirectoryOverride};
+    if (!makeDirectoryPath(profileDirectory)) {
+        std::cout << "ERROR: unable to create build directory " << tQuoted(profileDirectory) << std::endl << std::endl;
+        buildDirectoryOverride = "";
+        return false;
+    }
+    std::string mergedProfile{profileDirectory + "/" + CLANG_MERGED_PROFILE_NAME};
+    std::string keyPath{profileDirectory + "/" + PGO_KEY_NAME};
+
+    //The profile is reused until the sources, the headers they include, the
+    //switches, the compiler or the training run change. The headers come
+    //from the dependency files the last build here left beside its objects,
+    //so the key is written after the final build, once they are current
+    auto computeProfileKey = [&]() {
+        uint64_t returnKey{fnv1a64(sourceContentsHash() + '\n' + compileSwitches() + '\n' + linkSwitches() + '\n' + compilerStamp() + '\n' + trainingArguments + '\n')};
+        if (trainingInputFile != "") {
+            std::ifstream readFromFile{trainingInputFile};
+            std::stringstream inputContents;
+            inputContents << readFromFile.rdbuf();
+            returnKey = fnv1a64(inputContents.str(), returnKey);
+        }
+        std::set<std::string> dependencies;
+        for (auto &it : filesWithExtension(profileDirectory, ".d")) {
+            for (auto &dependencyIt : BuildManifest::parseDependencyFile(it)) {
+                dependencies.emplace(dependencyIt);
+            }
+        }
+        for (auto &it : dependencies) {
+            std::ifstream readFromFile{it};
+            std::stringstream dependencyContents;
+            dependencyContents << readFromFile.rdbuf();
+            returnKey = fnv1a64(it + '\n' + dependencyContents.str() + '\n', returnKey);
+        }
+        return returnKey;
+    };
+    uint64_t profileKey{computeProfileKey()};
+    std::string storedKey{""};
+    std::ifstream readKeyFile{keyPath};
+    std::getline(readKeyFile, storedKey);
+    readKeyFile.close();
+    bool profileReady{(storedKey == toHexString(profileKey)) && ((!clangProfile) || (fileExists(mergedProfile)))};
+
+    auto finishProfileGuidedBuild = [&](bool buildSucceeded) {
+        profileGuidedSwitches = "";
+        buildDirectoryOverride = "";
+        return buildSucceeded;
+    };
+    if (profileReady) {
+        std::cout << "Profile guided build: reusing the profile from an earlier training run (the sources, switches and training input are unchanged)" << std::endl << std::endl;
+    } else {
+        std::remove(keyPath.c_str());
+        //gcc adds to the counts already in a .gcda file, so old ones would skew the new profile
+        for (auto &it : filesWithExtension(profileDirectory, clangProfile ? ".profraw" : ".gcda")) {
+            std::remove(it.c_str());
+        }
+        std::remove(mergedProfile.c_str());
+
+        std::cout << "Profile guided build, step 1 of 3: building an instrumented executable" << std::endl << std::endl;
+        std::string finalExecutable{executableName};
+        executableName = profileDirectory + "/" + fileBaseName(finalExecutable) + PGO_INSTRUMENTED_SUFFIX;
+        profileGuidedSwitches = (clangProfile ? CLANG_PROFILE_GENERATE_SWITCHES : GCC_PROFILE_GENERATE_SWITCHES);
+        bool instrumentedBuilt{buildPerTranslationUnit()};
+        std::string instrumentedExecutable{executableName};
+        executableName = finalExecutable;
+        if (!instrumentedBuilt) {
+            return finishProfileGuidedBuild(false);
+        }
+
+        std::cout << "Profile guided build, step 2 of 3: training run" << std::endl;
+        //Only the training run writes its profile here, so the variable is
+        //put back afterwards, before anything else is run
+        const char *previousProfileFile{getenv("LLVM_PROFILE_FILE")};
+        std::string savedProfileFile{(previousProfileFile == nullptr) ? "" : previousProfileFile};
+        if (clangProfile) {
+            setenv("LLVM_PROFILE_FILE", (profileDirectory + "/" + CLANG_RAW_PROFILE_NAME).c_str(), 1);
+        }
+        SystemCommand trainingCommand{tQuoted(instrumentedExecutable) + ((trainingArguments == "") ? "" : (" " + trainingArguments))
+                                      + ((trainingInputFile == "") ? "" : (" < " + tQuoted(trainingInputFile)))};
+        std::cout << "    " << trainingCommand.command() << std::endl << std::endl;
+        trainingCommand.executeWithoutPipe();
+        std::cout << std::endl;
+        if ((clangProfile) && (previousProfileFile == nullptr)) {
+            unsetenv("LLVM_PROFILE_FILE");
+        } else if (clangProfile) {
+            setenv("LLVM_PROFILE_FILE", savedProfileFile.c_str(), 1);
+        }
+        if (trainingCommand.returnValue() != 0) {
+            std::cout << "WARNING: the training run exited with a return value of " << trainingCommand.returnValue() << ", so the profile may not represent a normal run" << std::endl << std::endl;
+        }
+        bool profileWritten{false};
+        if (clangProfile) {
+            std::vector<std::string> rawProfiles{filesWithExtension(profileDirectory, ".profraw")};
+            if (!rawProfiles.empty()) {
+                std::string mergeCommand{static_cast<std::string>(LLVM_PROFDATA_PROGRAM) + " merge -output=" + tQuoted(mergedProfile)};
+                for (auto &it : rawProfiles) {
+                    mergeCommand += (" " + tQuoted(it));
+                }
+                BuildResult mergeResult{BuildScheduler::runCommand(mergeCommand)};
+                profileWritten = (mergeResult.returnValue == 0);
+                if ((!profileWritten) || (verboseOutput)) {
+                    std::cout << "    " << mergeCommand << std::endl << mergeResult.output << std::endl;
+                }
+            }
+        } else {
+            profileWritten = (!filesWithExtension(profileDirectory, ".gcda").empty());
+        }
+        if (!profileWritten) {
+            std::cout << "WARNING: the training run did not leave any profile data, building without profile guidance" << std::endl << std::endl;
+            profileGuidedSwitches = "";
+            return finishProfileGuidedBuild(buildPerTranslationUnit());
+        }
+    }
+
+    std::cout << "Profile guided build, step 3 of 3: building with the profile" << std::endl << std::endl;
+    profileGuidedSwitches = (clangProfile ? (CLANG_PROFILE_USE_SWITCH + tQuoted(mergedProfile)) : static_cast<std::string>(GCC_PROFILE_USE_SWITCHES));
+    bool optimizedBuilt{buildPerTranslationUnit()};
+    if ((optimizedBuilt) && (!profileReady)) {
+        profileGuidedSwitches = "";
+        std::ofstream writeKeyFile{keyPath};
+        writeKeyFile << toHexString(computeProfileKey()) << '\n';
+    }
+    return finishProfileGuidedBuild(optimizedBuilt);
+}
+
+std::vector<std::vector<std::string>> unityBatches()
+{
+    //Files are sorted, then a batch ends after any file whose name hashes to
+    //zero modulo the batch size (or when it reaches twice that size), so a
+    //file being added or removed only changes the one batch it belongs to
+    size_t batchSize{(unityBatchSize == 0) ? static_cast<size_t>(DEFAULT_UNITY_BATCH_SIZE) : static_cast<size_t>(unityBatchSize)};
+    std::vector<std::string> sortedFiles{sourceCodeFiles};
+    std::sort(sortedFiles.begin(), sortedFiles.end());
+    sortedFiles.erase(std::unique(sortedFiles.begin(), sortedFiles.end()), sortedFiles.end());
+    std::vector<std::vector<std::string>> returnVector;
+    std::vector<std::string> currentBatch;
+    for (auto &it : sortedFiles) {
+        currentBatch.emplace_back(it);
+        if (((fnv1a64(it) % batchSize) == 0) || (currentBatch.size() >= 2 * batchSize)) {
+            returnVector.emplace_back(std::move(currentBatch));
+            currentBatch.clear();
+        }
+    }
+    if (!currentBatch.empty()) {
+        returnVector.emplace_back(std::move(currentBatch));
+    }
+    return returnVector;
+}
+
+std::string unitySourcePath(const std::vector<std::string> &batch)
+{
+    uint64_t batchHash{fnv1a64("")};
+    for (auto &it : batch) {
+        batchHash = fnv1a64(it + '\n', batchHash);
+    }
+    return buildDirectoryPath() + "/" + UNITY_SOURCE_PREFIX + toHexString(batchHash) + (gccFlag ? ".c" : ".cpp");
+}
+
+bool writeUnitySource(const std::string &unitySource, const std::vector<std::string> &batch)
+{
+    //Only rewritten when its contents change, since its modification time
+    //is one of the inputs that decides whether the batch is rebuilt
+    std::string unityContents{""};
+    for (auto &it : batch) {
+        std::unique_ptr<char, void (*)(void *)> canonicalPath{realpath(it.c_str(), nullptr), free};
+        unityContents += ("#include " + tQuoted(canonicalPath ? static_cast<std::string>(canonicalPath.get()) : it) + "\n");
+    }
+    std::ifstream readFromFile{unitySource};
+    if (readFromFile.is_open()) {
+        std::stringstream existingContents;
+        existingContents << readFromFile.rdbuf();
+        if (existingContents.str() == unityContents) {
+            return true;
+        }
+        readFromFile.close();
+    }
+    std::ofstream writeToFile{unitySource};
+    if (!writeToFile.is_open()) {
+        return false;
+    }
+    writeToFile << unityContents;
+    writeToFile.close();
+    if (!writeToFile) {
+        return false;
     }
+    //The name is a hash of the contents, so a fixed (old) modification time
+    //is safe, and keeps a just written batch from looking modified mid-build
+    struct timeval fixedTimes[2]{{1, 0}, {1, 0}};
+    utimes(unitySource.c_str(), fixedTimes);
+    return true;
 }
 
 void readConfigurationFile()
 {
+    DriverTrace::Span configurationSpan{driverTrace.span("read configuration file")};
     configurationFileReader = std::unique_ptr<ConfigurationFileReader>(new ConfigurationFileReader{});
 }
 
@@ -16,6 +16,8 @@
 
 #include "easygppstrings.h"
 
+#include <climits>
+
 namespace EasyGppStrings
 {
 	const char PATH_DELIMITER = ':';
@@ -38,6 +40,36 @@ namespace EasyGppStrings
 	const std::list<const char *> NO_RECORD_GCC_SWITCHES_SWITCHES{"-h", "--h", "-no-record", "--no-record"};
 	const std::list<const char *> NO_F_SANITIZE_SWITCHES{"-f", "--f", "-no-fsanitize", "--no-fsanitize"};
 	const std::list<const char *> CONFIGURATION_FILE_SWITCHES{"-p", "--p", "-config-file", "--config-file"};
+	const std::list<const char *> JOBS_SWITCHES{"-j", "--j", "-jobs", "--jobs"};
+	const std::list<const char *> SINGLE_COMMAND_SWITCHES{"-single-command", "--single-command"};
+	const std::list<const char *> UNITY_SWITCHES{"-unity", "--unity"};
+	const std::list<const char *> REBUILD_SWITCHES{"-rebuild", "--rebuild"};
+	const std::list<const char *> NO_PRECOMPILED_HEADER_SWITCHES{"-no-pch", "--no-pch"};
+	const std::list<const char *> COMPILE_CACHE_SWITCHES{"-cache", "--cache"};
+	const std::list<const char *> NO_COMPILE_CACHE_SWITCHES{"-no-cache", "--no-cache"};
+	const std::list<const char *> CACHE_STATISTICS_SWITCHES{"-cache-stats", "--cache-stats"};
+	const std::list<const char *> TIME_REPORT_SWITCHES{"-time-report", "--time-report"};
+	const std::list<const char *> REMARKS_SWITCHES{"-remarks", "--remarks"};
+	const std::list<const char *> TRACE_DRIVER_SWITCHES{"-trace-driver", "--trace-driver"};
+	const std::list<const char *> PROFILE_SWITCHES{"-profile", "--profile"};
+	const std::list<const char *> PGO_SWITCHES{"-pgo", "--pgo"};
+	const std::list<const char *> PGO_ARGUMENTS_SWITCHES{"-pgo-args", "--pgo-args"};
+	const std::list<const char *> PGO_INPUT_SWITCHES{"-pgo-input", "--pgo-input"};
+	const std::list<const char *> AUTOTUNE_SWITCHES{"-autotune", "--autotune"};
+	const std::list<const char *> AUTOTUNE_SAVE_SWITCHES{"-autotune-save", "--autotune-save"};
+	const std::list<const char *> COMPARE_TOOLCHAINS_SWITCHES{"-compare-toolchains", "--compare-toolchains"};
+	const std::list<const char *> LTO_SWITCHES{"-lto", "--lto"};
+	const std::list<const char *> BENCHMARK_SWITCHES{"-bench", "--bench"};
+	const std::list<const char *> WARMUP_SWITCHES{"-warmup", "--warmup"};
+	const std::list<const char *> STABLE_RUN_SWITCHES{"-stable", "--stable"};
+	const std::list<const char *> NO_ASLR_SWITCHES{"-no-aslr", "--no-aslr"};
+	const std::list<const char *> MEMORY_LIMIT_SWITCHES{"-memory-limit", "--memory-limit"};
+	const std::list<const char *> CPU_LIMIT_SWITCHES{"-cpu-limit", "--cpu-limit"};
+	const std::list<const char *> TEST_SWITCHES{"-test", "--test"};
+	const std::list<const char *> TEST_TIMEOUT_SWITCHES{"-test-timeout", "--test-timeout"};
+	const std::list<const char *> PROFILE_RUN_SWITCHES{"-profile-run", "--profile-run"};
+	const std::list<const char *> CACHE_PROFILE_SWITCHES{"-cache-profile", "--cache-profile"};
+	const std::list<const char *> MICROBENCH_SWITCHES{"-microbench", "--microbench"};
 	const char *WARNING_LEVEL{" -Wall -Wextra -Wpedantic"};
 	const char *STANDARD_PROMPT_STRING{"enter a selection: "};
 	const char *DEFAULT_CPP_COMPILER_STANDARD{"-std=c++14"};
@@ -58,6 +90,88 @@ namespace EasyGppStrings
 
 	const char *EDITOR_IDENTIFIER{"addeditor("};
 	const char *LIBRARY_IDENTIFIER{"addlibrary("};
+	const char *COMPILE_CACHE_IDENTIFIER{"usecompilecache("};
+	const char *CACHE_SIZE_IDENTIFIER{"setcachesize("};
+	const char *CACHE_COMPRESSION_IDENTIFIER{"setcachecompression("};
+	const long long DEFAULT_COMPILE_CACHE_SIZE{5LL * 1024LL * 1024LL * 1024LL};
+	const std::string COMPILE_CACHE_DIRECTORY{static_cast<std::string>(getenv("HOME")) + "/.easygpp/cache"};
+	const char *PRECOMPILED_HEADER_IDENTIFIER{"addprecompiledheader("};
+	const char *LINKER_IDENTIFIER{"setlinker("};
+	const char *SPLIT_DWARF_IDENTIFIER{"usesplitdwarf("};
+	const char *PROFILE_IDENTIFIER{"addprofile("};
+	const char *TUNE_OPTION_IDENTIFIER{"addtuneoption("};
+	//Each entry is one choice: alternatives separated by '/', or a single
+	//switch that is tried both with and without
+	const std::vector<const char *> DEFAULT_TUNE_OPTIONS{"-O2/-O3", "-march=native", "-funroll-loops", "-fno-plt"};
+	const unsigned int AUTOTUNE_VARIANT_LIMIT{64};
+	const char *AUTOTUNE_DIRECTORY_SUFFIX{"-autotune"};
+	const char *TOOLCHAINS_DIRECTORY_SUFFIX{"-toolchains"};
+	//Each replaces the default -mtune, -fsanitize, -ggdb and -frecord-gcc-switches
+	//switches, and can be overridden by an AddProfile() of the same name
+	const std::map<std::string, std::string> BUILT_IN_PROFILES{{"debug", "-Og -ggdb3"},
+	                                                           {"sanitize", "-O1 -ggdb -fsanitize=address,undefined -fno-omit-frame-pointer"},
+	                                                           {"release", "-O2 -DNDEBUG"},
+	                                                           {"native", "-O3 -march=native -DNDEBUG"}};
+	const char *AUTOMATIC_LINKER{"auto"};
+	const std::list<const char *> KNOWN_LINKERS{"auto", "mold", "lld", "gold", "bfd", "default"};
+	const std::string LINKER_CACHE_FILE{static_cast<std::string>(getenv("HOME")) + "/.easygpp/linker"};
+	const char *SPLIT_DWARF_SWITCHES{" -gsplit-dwarf -gz"};
+	const char *COMPRESSED_DEBUG_SWITCH{" -gz"};
+	const char *GDB_INDEX_SWITCH{" -Wl,--gdb-index"};
+	const char *GCC_LTO_COMPILE_SWITCH{" -flto"};
+	const char *GCC_LTO_LINK_SWITCH{" -flto="};
+	const char *GCC_LTO_INCREMENTAL_SWITCH{" -flto-incremental="};
+	const char *CLANG_THIN_LTO_SWITCH{" -flto=thin"};
+	const char *LTO_CACHE_NAME{"lto-cache"};
+	const char *PRECOMPILED_HEADER_NAME{"easygpp-pch.h"};
+	const std::string PRECOMPILED_HEADER_DIRECTORY{static_cast<std::string>(getenv("HOME")) + "/.easygpp/pch"};
+	const std::string EDITOR_CACHE_FILE{static_cast<std::string>(getenv("HOME")) + "/.easygpp/editors"};
+	const char *COMPILED_CONFIGURATION_EXTENSION{".compiled"};
+	const char *BUILD_DIRECTORY_NAME{".easygpp-build"};
+	const char *OBJECT_FILE_EXTENSION{".o"};
+	const char *BUILD_MANIFEST_NAME{"manifest"};
+	const char *UNITY_SOURCE_PREFIX{"unity-"};
+	const unsigned int DEFAULT_UNITY_BATCH_SIZE{8};
+	const char *SCAN_CACHE_NAME{"scancache"};
+	const char *TIME_TRACE_NAME{"time-trace.json"};
+	const unsigned int TIME_REPORT_TOP_COUNT{10};
+	const unsigned int DEFAULT_BENCHMARK_RUNS{10};
+	const unsigned int DEFAULT_WARMUP_RUNS{1};
+	const char *BENCHMARK_HISTORY_NAME{"benchhistory"};
+	//Just off 1000 Hz, so sampling does not run in lockstep with timers in the program
+	const unsigned int DEFAULT_SAMPLING_FREQUENCY{999};
+	const unsigned int PROFILE_RUN_TOP_COUNT{20};
+	const char *FRAME_POINTER_SWITCH{"-fno-omit-frame-pointer"};
+	const char *FOLDED_STACKS_NAME{"profile.folded"};
+	const std::string SAMPLER_DIRECTORY{static_cast<std::string>(getenv("HOME")) + "/.easygpp/sampler"};
+	const char *VALGRIND_PROGRAM{"valgrind"};
+	//Since valgrind 3.21 cachegrind only counts instructions unless told to simulate the caches
+	const char *CACHEGRIND_SWITCHES{" --tool=cachegrind --cache-sim=yes -q"};
+	const char *CACHEGRIND_OUTPUT_NAME{"cachegrind.out"};
+	const char *CACHE_PROFILE_NAME{"cacheprofile"};
+	const unsigned int CACHE_PROFILE_TOP_COUNT{15};
+	const char *MICROBENCH_SUFFIX{"-microbench"};
+	const char *MICROBENCH_SOURCE_NAME{"microbench-harness.cpp"};
+	const unsigned int MICROBENCH_SAMPLE_COUNT{50};
+	const double MICROBENCH_TARGET_SECONDS{1.0};
+	const double MICROBENCH_WARMUP_SECONDS{0.2};
+	const unsigned int DEFAULT_TEST_TIMEOUT_SECONDS{10};
+	//So the limit in bytes, and the hard CPU limit one second past the soft
+	//one, still fit in an rlim_t
+	const unsigned long MAXIMUM_MEMORY_LIMIT_MEGABYTES{ULONG_MAX / (1024 * 1024)};
+	const unsigned long MAXIMUM_CPU_LIMIT_SECONDS{ULONG_MAX - 1};
+	const char *PGO_BUILD_DIRECTORY_SUFFIX{"-pgo"};
+	const char *PGO_KEY_NAME{"pgokey"};
+	const char *PGO_INSTRUMENTED_SUFFIX{"-instrumented"};
+	const char *GCC_PROFILE_GENERATE_SWITCHES{" -fprofile-generate -fprofile-update=prefer-atomic"};
+	const char *GCC_PROFILE_USE_SWITCHES{" -fprofile-use -fprofile-correction -Wno-missing-profile"};
+	const char *CLANG_PROFILE_GENERATE_SWITCHES{" -fprofile-instr-generate"};
+	const char *CLANG_PROFILE_USE_SWITCH{" -fprofile-instr-use="};
+	const char *CLANG_RAW_PROFILE_NAME{"pgo-%p.profraw"};
+	const char *CLANG_MERGED_PROFILE_NAME{"pgo.profdata"};
+	const char *LLVM_PROFDATA_PROGRAM{"llvm-profdata"};
+	const unsigned int BENCHMARK_HISTORY_LIMIT{200};
+	const double BENCHMARK_SIGNIFICANCE_LEVEL{0.05};
 	const char *CONFIGURATION_FILE_NAME{"easygpp.config"};
 	const std::string DEFAULT_CONFIGURATION_FILE{static_cast<std::string>(getenv("HOME"))
 		                                            + "/.easygpp/" 
@@ -89,5 +203,10 @@ namespace EasyGppStrings
     const char *CONFIG_EXPRESSION_MALFORMED_STRING{"    expression is malformed/has invalid syntax, ignoring option"};
     const char *NO_H_EXTENSION_FOUND_STRING{"    No .h extension found, but one was expected, ignoring option"};
     const char *NO_LIBRARY_NAME_SPECIFIED_STRING{"    No library name specified after header file, ignoring option"};
+    const char *NO_ARGUMENT_SPECIFIED_STRING{"    No argument specified between the parenthesis, ignoring option"};
+    const char *INVALID_BOOLEAN_STRING{"    Expected one of true/false, on/off, yes/no, ignoring option"};
+    const char *INVALID_SIZE_STRING{"    Expected a size in bytes, optionally followed by K, M or G, ignoring option"};
+    const char *INVALID_LINKER_STRING{"    Expected one of auto, mold, lld, gold, bfd or default, ignoring option"};
+    const char *INVALID_PROFILE_NAME_STRING{"    Expected a profile name made of letters, digits, '-' and '_' followed by a comma and the profile's switches, ignoring option"};
 	const char *STANDARD_EXCEPTION_CAUGHT_IN_CONSTRUCTOR_STRING{"Standard exception caught in ReadConfigurationFile() constructor: "};
 }
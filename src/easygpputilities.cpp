@@ -0,0 +1,266 @@
+/***********************************************************************
+*    easygpputilities.cpp:                                             *
+*    Small filesystem and string helpers used throughout EasyGpp       *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of helper functions that do    *
+*    not belong to any one part of EasyGpp, in the EasyGppUtilities    *
+*    namespace                                                         *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "easygpputilities.h"
+
+#include <cerrno>
+#include <exception>
+#include <cctype>
+
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace EasyGppUtilities
+{
+    bool getFileStamp(const std::string &filePath, FileStamp &fileStamp)
+    {
+        struct stat fileStat;
+        if (stat(filePath.c_str(), &fileStat) != 0) {
+            fileStamp = FileStamp{-1, -1};
+            return false;
+        }
+        fileStamp.modifiedTime = static_cast<long long>(fileStat.st_mtim.tv_sec) * 1000000000LL + fileStat.st_mtim.tv_nsec;
+        fileStamp.size = static_cast<long long>(fileStat.st_size);
+        return true;
+    }
+
+    bool operator==(const FileStamp &lhs, const FileStamp &rhs)
+    {
+        return ((lhs.modifiedTime == rhs.modifiedTime) && (lhs.size == rhs.size));
+    }
+
+    bool operator!=(const FileStamp &lhs, const FileStamp &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    long long currentFileSystemTime()
+    {
+        //File system timestamps come from a coarse clock that can trail the
+        //real time by a tick, so back off a little to stay on the safe side
+        static const long long COARSE_CLOCK_MARGIN{20000000LL};
+        struct timespec currentTime;
+        clock_gettime(CLOCK_REALTIME, &currentTime);
+        return static_cast<long long>(currentTime.tv_sec) * 1000000000LL + currentTime.tv_nsec - COARSE_CLOCK_MARGIN;
+    }
+
+    bool parseFileStamp(const std::string &modifiedTime, const std::string &size, FileStamp &fileStamp)
+    {
+        try {
+            fileStamp.modifiedTime = std::stoll(modifiedTime);
+            fileStamp.size = std::stoll(size);
+        } catch (std::exception &e) {
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<std::string> splitOnTabs(const std::string &line)
+    {
+        return splitOnCharacter(line, '\t');
+    }
+
+    std::vector<std::string> splitOnCharacter(const std::string &line, char delimiter)
+    {
+        //Unlike parseToContainer(), keeps empty fields, so "a::b" has three
+        std::vector<std::string> returnVector;
+        size_t startPosition{0};
+        while (true) {
+            size_t foundPosition{line.find(delimiter, startPosition)};
+            returnVector.emplace_back(line.substr(startPosition, foundPosition - startPosition));
+            if (foundPosition == std::string::npos) {
+                return returnVector;
+            }
+            startPosition = foundPosition + 1;
+        }
+    }
+
+    uint64_t fnv1a64(const std::string &stringToHash, uint64_t seed)
+    {
+        return fnv1a64(stringToHash.data(), stringToHash.length(), seed);
+    }
+
+    uint64_t fnv1a64(const char *data, size_t length, uint64_t seed)
+    {
+        uint64_t hash{seed};
+        for (size_t i = 0; i < length; i++) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    std::string toHexString(uint64_t value)
+    {
+        static const char *HEX_DIGITS{"0123456789abcdef"};
+        std::string returnString(16, '0');
+        for (int i = 15; i >= 0; i--) {
+            returnString[static_cast<size_t>(i)] = HEX_DIGITS[value & 0xF];
+            value >>= 4;
+        }
+        return returnString;
+    }
+
+    bool fromHexString(const std::string &hexString, uint64_t &value)
+    {
+        if ((hexString.empty()) || (hexString.length() > 16)) {
+            return false;
+        }
+        value = 0;
+        for (auto &it : hexString) {
+            value <<= 4;
+            if ((it >= '0') && (it <= '9')) {
+                value |= static_cast<uint64_t>(it - '0');
+            } else if ((it >= 'a') && (it <= 'f')) {
+                value |= static_cast<uint64_t>(it - 'a' + 10);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool makeDirectoryPath(const std::string &directoryPath)
+    {
+        if (directoryPath.empty()) {
+            return false;
+        }
+        std::string currentPath{""};
+        size_t position{0};
+        while (position != std::string::npos) {
+            position = directoryPath.find('/', position + 1);
+            currentPath = directoryPath.substr(0, position);
+            if (currentPath.empty()) {
+                continue;
+            }
+            if ((mkdir(currentPath.c_str(), 0755) != 0) && (errno != EEXIST)) {
+                return false;
+            }
+        }
+        struct stat fileStat;
+        return ((stat(directoryPath.c_str(), &fileStat) == 0) && S_ISDIR(fileStat.st_mode));
+    }
+
+    std::string parentDirectory(const std::string &filePath)
+    {
+        size_t foundPosition{filePath.find_last_of('/')};
+        if (foundPosition == std::string::npos) {
+            return ".";
+        } else if (foundPosition == 0) {
+            return "/";
+        }
+        return filePath.substr(0, foundPosition);
+    }
+
+    std::string fileBaseName(const std::string &filePath)
+    {
+        size_t foundPosition{filePath.find_last_of('/')};
+        if (foundPosition == std::string::npos) {
+            return filePath;
+        }
+        return filePath.substr(foundPosition + 1);
+    }
+
+    std::string stripExtension(const std::string &fileName)
+    {
+        size_t foundPosition{fileName.find_last_of('.')};
+        if ((foundPosition == std::string::npos) || (foundPosition == 0)) {
+            return fileName;
+        }
+        return fileName.substr(0, foundPosition);
+    }
+
+    std::string flattenPath(const std::string &filePath)
+    {
+        //Turns "../src/main.cpp" into "___src_main.cpp-" followed by a short
+        //hash of the path, so objects from identically named sources in
+        //different directories do not collide, and neither do paths that only
+        //flatten to the same name, like "a/b.cpp" and "a_b.cpp"
+        std::string returnString{""};
+        for (auto &it : filePath) {
+            if ((it == '/') || (it == '\\')) {
+                returnString += '_';
+            } else if (it == '.') {
+                returnString += ((returnString.empty() || (returnString.back() == '_')) ? '_' : '.');
+            } else {
+                returnString += it;
+            }
+        }
+        return returnString + "-" + toHexString(fnv1a64(filePath)).substr(0, 8);
+    }
+
+    std::vector<std::string> filesWithExtension(const std::string &directoryPath, const std::string &extension)
+    {
+        std::vector<std::string> returnVector;
+        DIR *directory{opendir(directoryPath.c_str())};
+        if (directory == nullptr) {
+            return returnVector;
+        }
+        while (struct dirent *directoryEntry = readdir(directory)) {
+            std::string entryName{directoryEntry->d_name};
+            struct stat fileStat;
+            if ((entryName.length() > extension.length()) && (entryName.compare(entryName.length() - extension.length(), extension.length(), extension) == 0)
+                && (stat((directoryPath + "/" + entryName).c_str(), &fileStat) == 0) && (S_ISREG(fileStat.st_mode))) {
+                returnVector.emplace_back(directoryPath + "/" + entryName);
+            }
+        }
+        closedir(directory);
+        return returnVector;
+    }
+
+    bool isUnsignedInteger(const std::string &stringToCheck)
+    {
+        if (stringToCheck.empty()) {
+            return false;
+        }
+        for (auto &it : stringToCheck) {
+            if (!isdigit(static_cast<unsigned char>(it))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool parseUnsignedInteger(const std::string &stringToParse, unsigned long &value, unsigned long maximumValue)
+    {
+        if (!isUnsignedInteger(stringToParse)) {
+            return false;
+        }
+        unsigned long parsedValue{0};
+        for (auto &it : stringToParse) {
+            unsigned long digit{static_cast<unsigned long>(it - '0')};
+            if ((digit > maximumValue) || (parsedValue > (maximumValue - digit) / 10)) {
+                return false;
+            }
+            parsedValue = parsedValue * 10 + digit;
+        }
+        value = parsedValue;
+        return true;
+    }
+
+    bool parseUnsignedInteger(const std::string &stringToParse, unsigned int &value, unsigned int maximumValue)
+    {
+        unsigned long parsedValue{0};
+        if (!parseUnsignedInteger(stringToParse, parsedValue, static_cast<unsigned long>(maximumValue))) {
+            return false;
+        }
+        value = static_cast<unsigned int>(parsedValue);
+        return true;
+    }
+}
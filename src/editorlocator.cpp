@@ -0,0 +1,154 @@
+/***********************************************************************
+*    editorlocator.cpp:                                                *
+*    Finds the text editors installed on the PATH for EasyGpp          *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of an EditorLocator class. This*
+*    class looks for a fixed set of editor names in every PATH         *
+*    directory, and remembers what it found in a small cache file that *
+*    is thrown away when PATH or any directory on it changes           *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "editorlocator.h"
+#include "easygpputilities.h"
+
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace EasyGppUtilities;
+
+static const char *EDITOR_CACHE_HEADER{"EasyGppEditorCache\t1"};
+
+EditorLocator::EditorLocator(const std::string &cachePath) :
+    m_cachePath{cachePath}
+{
+
+}
+
+std::map<std::string, std::string> EditorLocator::findEditors(const std::string &pathString, const std::vector<std::string> &candidateNames) const
+{
+    std::map<std::string, std::string> returnMap;
+    uint64_t candidatesHash{fnv1a64("")};
+    for (auto &it : candidateNames) {
+        candidatesHash = fnv1a64(it + '\n', candidatesHash);
+    }
+    if (this->loadCache(pathString, candidatesHash, returnMap)) {
+        return returnMap;
+    }
+    //Only the handful of candidate names are looked up in each directory,
+    //rather than listing every directory (which can hold thousands of files)
+    long long searchStartTime{currentFileSystemTime()};
+    std::vector<std::string> pathDirectories{splitOnCharacter(pathString, ':')};
+    bool directoryChangedDuringSearch{false};
+    for (auto &it : pathDirectories) {
+        if (it.empty()) {
+            continue;
+        }
+        if (directoryModifiedTime(it) >= searchStartTime) {
+            directoryChangedDuringSearch = true;
+        }
+        for (auto &candidateIt : candidateNames) {
+            if (returnMap.find(candidateIt) != returnMap.end()) {
+                continue;
+            }
+            std::string candidatePath{it + "/" + candidateIt};
+            struct stat fileStat;
+            if ((stat(candidatePath.c_str(), &fileStat) == 0) && (S_ISREG(fileStat.st_mode)) && (access(candidatePath.c_str(), X_OK) == 0)) {
+                returnMap.emplace(candidateIt, candidatePath);
+            }
+        }
+    }
+    if (!directoryChangedDuringSearch) {
+        this->saveCache(pathString, candidatesHash, pathDirectories, returnMap);
+    }
+    return returnMap;
+}
+
+long long EditorLocator::directoryModifiedTime(const std::string &directoryPath)
+{
+    FileStamp fileStamp{-1, -1};
+    getFileStamp(directoryPath, fileStamp);
+    return fileStamp.modifiedTime;
+}
+
+bool EditorLocator::loadCache(const std::string &pathString, uint64_t candidatesHash, std::map<std::string, std::string> &editorPaths) const
+{
+    //An editor installed or removed changes its directory's modification
+    //time, so one stat() per PATH entry is enough to trust the cache
+    std::ifstream readFromFile{this->m_cachePath};
+    if (!readFromFile.is_open()) {
+        return false;
+    }
+    std::string line{""};
+    if ((!std::getline(readFromFile, line)) || (line != EDITOR_CACHE_HEADER)) {
+        return false;
+    }
+    bool pathMatched{false};
+    bool candidatesMatched{false};
+    std::map<std::string, std::string> cachedPaths;
+    while (std::getline(readFromFile, line)) {
+        std::vector<std::string> fields{splitOnTabs(line)};
+        if ((fields[0] == "path") && (fields.size() == 2)) {
+            if (fields[1] != pathString) {
+                return false;
+            }
+            pathMatched = true;
+        } else if ((fields[0] == "candidates") && (fields.size() == 2)) {
+            uint64_t cachedHash{0};
+            if ((!fromHexString(fields[1], cachedHash)) || (cachedHash != candidatesHash)) {
+                return false;
+            }
+            candidatesMatched = true;
+        } else if ((fields[0] == "directory") && (fields.size() == 3)) {
+            if (std::to_string(directoryModifiedTime(fields[1])) != fields[2]) {
+                return false;
+            }
+        } else if ((fields[0] == "editor") && (fields.size() == 3)) {
+            cachedPaths.emplace(fields[1], fields[2]);
+        }
+    }
+    if ((!pathMatched) || (!candidatesMatched)) {
+        return false;
+    }
+    editorPaths = cachedPaths;
+    return true;
+}
+
+bool EditorLocator::saveCache(const std::string &pathString, uint64_t candidatesHash, const std::vector<std::string> &pathDirectories, const std::map<std::string, std::string> &editorPaths) const
+{
+    if ((pathString.find('\n') != std::string::npos) || (!makeDirectoryPath(parentDirectory(this->m_cachePath)))) {
+        return false;
+    }
+    std::string temporaryPath{this->m_cachePath + ".tmp"};
+    std::ofstream writeToFile{temporaryPath};
+    if (!writeToFile.is_open()) {
+        return false;
+    }
+    writeToFile << EDITOR_CACHE_HEADER << '\n';
+    writeToFile << "path\t" << pathString << '\n';
+    writeToFile << "candidates\t" << toHexString(candidatesHash) << '\n';
+    for (auto &it : pathDirectories) {
+        if (!it.empty()) {
+            writeToFile << "directory\t" << it << '\t' << directoryModifiedTime(it) << '\n';
+        }
+    }
+    for (auto &it : editorPaths) {
+        writeToFile << "editor\t" << it.first << '\t' << it.second << '\n';
+    }
+    writeToFile.close();
+    if (!writeToFile) {
+        return false;
+    }
+    return (std::rename(temporaryPath.c_str(), this->m_cachePath.c_str()) == 0);
+}
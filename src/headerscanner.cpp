@@ -0,0 +1,451 @@
+/***********************************************************************
+*    headerscanner.cpp:                                                *
+*    Finds the #include directives of source files for EasyGpp        *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a HeaderScanner class. This *
+*    class memory maps source files and lexes them just far enough to  *
+*    find real #include directives (skipping comments, string and      *
+*    character literals), then matches the included header names       *
+*    against a hashed index of the AddLibrary() configuration entries. *
+*    Included headers that can be found next to the including file or  *
+*    in an include path are followed, and every file's include list is *
+*    remembered on disk so unchanged headers are not read again        *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "headerscanner.h"
+#include "easygpputilities.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <unordered_set>
+#include <cctype>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace EasyGppUtilities;
+
+static const char *SCAN_CACHE_HEADER{"EasyGppScanCache\t1"};
+
+namespace {
+    template <typename Function>
+    void runInParallel(size_t itemCount, unsigned int jobCount, Function function)
+    {
+        std::atomic<size_t> nextItem{0};
+        auto worker = [&]() {
+            for (size_t itemIndex = nextItem++; itemIndex < itemCount; itemIndex = nextItem++) {
+                function(itemIndex);
+            }
+        };
+        size_t workerCount{std::min<size_t>(std::max<unsigned int>(jobCount, 1), itemCount)};
+        if (workerCount <= 1) {
+            worker();
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < workerCount; i++) {
+            workers.emplace_back(worker);
+        }
+        for (auto &it : workers) {
+            it.join();
+        }
+    }
+
+    bool isIdentifierCharacter(char characterToCheck)
+    {
+        return ((isalnum(static_cast<unsigned char>(characterToCheck))) || (characterToCheck == '_'));
+    }
+
+    //Returns the position just past a backslash-newline pair (either line
+    //ending style) starting at position, or position itself if there is none
+    size_t skipLineContinuation(const char *buffer, size_t length, size_t position)
+    {
+        if ((position < length) && (buffer[position] == '\\')) {
+            if ((position + 1 < length) && (buffer[position + 1] == '\n')) {
+                return position + 2;
+            } else if ((position + 2 < length) && (buffer[position + 1] == '\r') && (buffer[position + 2] == '\n')) {
+                return position + 3;
+            }
+        }
+        return position;
+    }
+
+    size_t skipHorizontalWhitespace(const char *buffer, size_t length, size_t position)
+    {
+        while (position < length) {
+            size_t continued{skipLineContinuation(buffer, length, position)};
+            if (continued != position) {
+                position = continued;
+            } else if ((buffer[position] == ' ') || (buffer[position] == '\t') || (buffer[position] == '\f') || (buffer[position] == '\v')) {
+                position++;
+            } else if ((position + 1 < length) && (buffer[position] == '/') && (buffer[position + 1] == '*')) {
+                const char *foundEnd{static_cast<const char *>(memmem(buffer + position + 2, length - position - 2, "*/", 2))};
+                position = ((foundEnd == nullptr) ? length : static_cast<size_t>(foundEnd - buffer) + 2);
+            } else {
+                break;
+            }
+        }
+        return position;
+    }
+}
+
+HeaderScanner::HeaderScanner(const std::map<std::string, std::string> &libraryToHeaderMap) :
+    m_headerIndex{},
+    m_includePaths{},
+    m_scanCache{},
+    m_resolvedPaths{}
+{
+    //Indexed by the last path component, so both <tjlutils.h> and
+    //<tjlutils/tjlutils.h> find the entry for tjlutils.h with one lookup
+    for (auto &it : libraryToHeaderMap) {
+        this->m_headerIndex[EasyGppUtilities::fileBaseName(it.first)].emplace_back(it.first, it.second);
+    }
+}
+
+std::vector<std::pair<std::string, std::string>> HeaderScanner::librariesFor(const std::string &headerName) const
+{
+    std::vector<std::pair<std::string, std::string>> returnVector;
+    auto foundEntries = this->m_headerIndex.find(EasyGppUtilities::fileBaseName(headerName));
+    if (foundEntries == this->m_headerIndex.end()) {
+        return returnVector;
+    }
+    for (auto &it : foundEntries->second) {
+        if ((headerName == it.first) 
+            || ((headerName.length() > it.first.length()) 
+                && (headerName[headerName.length() - it.first.length() - 1] == '/')
+                && (headerName.compare(headerName.length() - it.first.length(), it.first.length(), it.first) == 0))) {
+            returnVector.emplace_back(it);
+        }
+    }
+    return returnVector;
+}
+
+ScanResult HeaderScanner::scanFile(const std::string &filePath)
+{
+    ScanResult scanResult{false, {}, {}};
+    int fileDescriptor{open(filePath.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fileDescriptor < 0) {
+        return scanResult;
+    }
+    struct stat fileStat;
+    if ((fstat(fileDescriptor, &fileStat) != 0) || (!S_ISREG(fileStat.st_mode))) {
+        close(fileDescriptor);
+        return scanResult;
+    }
+    scanResult.readable = true;
+    size_t length{static_cast<size_t>(fileStat.st_size)};
+    if (length == 0) {
+        close(fileDescriptor);
+        return scanResult;
+    }
+    void *mappedFile{mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fileDescriptor, 0)};
+    close(fileDescriptor);
+    if (mappedFile == MAP_FAILED) {
+        scanResult.readable = false;
+        return scanResult;
+    }
+    madvise(mappedFile, length, MADV_SEQUENTIAL);
+    scanBuffer(static_cast<const char *>(mappedFile), length, scanResult.includes);
+    munmap(mappedFile, length);
+    return scanResult;
+}
+
+void HeaderScanner::scanBuffer(const char *buffer, size_t length, std::vector<IncludeDirective> &includes)
+{
+    bool atLineStart{true};
+    bool inDirective{false};
+    bool sawCode{false};
+    size_t position{0};
+    while (position < length) {
+        char currentChar{buffer[position]};
+        size_t continued{skipLineContinuation(buffer, length, position)};
+        if (continued != position) {
+            position = continued;
+            continue;
+        }
+        if (currentChar == '\n') {
+            atLineStart = true;
+            inDirective = false;
+            position++;
+        } else if ((currentChar == ' ') || (currentChar == '\t') || (currentChar == '\r') || (currentChar == '\f') || (currentChar == '\v')) {
+            position++;
+        } else if ((currentChar == '/') && (position + 1 < length) && (buffer[position + 1] == '/')) {
+            //A line comment ends at the first newline that is not escaped
+            position += 2;
+            while (position < length) {
+                size_t continuedComment{skipLineContinuation(buffer, length, position)};
+                if (continuedComment != position) {
+                    position = continuedComment;
+                } else if (buffer[position] == '\n') {
+                    break;
+                } else {
+                    position++;
+                }
+            }
+        } else if ((currentChar == '/') && (position + 1 < length) && (buffer[position + 1] == '*')) {
+            const char *foundEnd{static_cast<const char *>(memmem(buffer + position + 2, length - position - 2, "*/", 2))};
+            position = ((foundEnd == nullptr) ? length : static_cast<size_t>(foundEnd - buffer) + 2);
+        } else if ((currentChar == '#') && (atLineStart)) {
+            atLineStart = false;
+            inDirective = true;
+            position = skipHorizontalWhitespace(buffer, length, position + 1);
+            size_t nameStart{position};
+            while ((position < length) && (isIdentifierCharacter(buffer[position]))) {
+                position++;
+            }
+            std::string directiveName{buffer + nameStart, position - nameStart};
+            if ((directiveName == "include") || (directiveName == "include_next") || (directiveName == "import")) {
+                position = skipHorizontalWhitespace(buffer, length, position);
+                if ((position < length) && ((buffer[position] == '<') || (buffer[position] == '"'))) {
+                    char closingChar{(buffer[position] == '<') ? '>' : '"'};
+                    size_t headerStart{position + 1};
+                    size_t headerEnd{headerStart};
+                    while ((headerEnd < length) && (buffer[headerEnd] != closingChar) && (buffer[headerEnd] != '\n')) {
+                        headerEnd++;
+                    }
+                    if ((headerEnd < length) && (buffer[headerEnd] == closingChar)) {
+                        includes.emplace_back(IncludeDirective{std::string{buffer + headerStart, headerEnd - headerStart}, (closingChar == '>'), !sawCode});
+                        position = headerEnd + 1;
+                    }
+                }
+            } else if (directiveName == "pragma") {
+                size_t argumentStart{skipHorizontalWhitespace(buffer, length, position)};
+                if (!((length - argumentStart >= 4) && (memcmp(buffer + argumentStart, "once", 4) == 0))) {
+                    sawCode = true;
+                }
+            } else if (!directiveName.empty()) {
+                //Anything else (#define, #if, ...) can change what the
+                //following headers mean, so they stop being "leading"
+                sawCode = true;
+            }
+        } else if ((currentChar == '"') || (currentChar == '\'')) {
+            atLineStart = false;
+            //A quote right after a digit is a C++14 digit separator
+            if ((currentChar == '\'') && (position > 0) && (isalnum(static_cast<unsigned char>(buffer[position - 1])))) {
+                position++;
+                continue;
+            }
+            if (!inDirective) {
+                sawCode = true;
+            }
+            //R"delimiter( ... )delimiter" (with an optional u8/u/U/L prefix)
+            if ((currentChar == '"') && (position > 0) && (buffer[position - 1] == 'R') 
+                && ((position < 2) || (!isIdentifierCharacter(buffer[position - 2])) 
+                    || (buffer[position - 2] == '8') || (buffer[position - 2] == 'u') || (buffer[position - 2] == 'U') || (buffer[position - 2] == 'L'))) {
+                size_t delimiterStart{position + 1};
+                size_t delimiterEnd{delimiterStart};
+                while ((delimiterEnd < length) && (buffer[delimiterEnd] != '(') && (delimiterEnd - delimiterStart <= 16)) {
+                    delimiterEnd++;
+                }
+                if ((delimiterEnd < length) && (buffer[delimiterEnd] == '(')) {
+                    std::string closingSequence{")" + std::string{buffer + delimiterStart, delimiterEnd - delimiterStart} + "\""};
+                    const char *foundEnd{static_cast<const char *>(memmem(buffer + delimiterEnd + 1, length - delimiterEnd - 1, closingSequence.data(), closingSequence.length()))};
+                    position = ((foundEnd == nullptr) ? length : static_cast<size_t>(foundEnd - buffer) + closingSequence.length());
+                    continue;
+                }
+            }
+            position++;
+            while ((position < length) && (buffer[position] != currentChar) && (buffer[position] != '\n')) {
+                position += ((buffer[position] == '\\') ? 2 : 1);
+            }
+            position++;
+        } else {
+            atLineStart = false;
+            if (!inDirective) {
+                sawCode = true;
+            }
+            position++;
+        }
+    }
+}
+
+void HeaderScanner::setIncludePaths(const std::vector<std::string> &includePaths)
+{
+    this->m_includePaths = includePaths;
+    this->m_resolvedPaths.clear();
+}
+
+bool HeaderScanner::loadScanCache(const std::string &scanCachePath)
+{
+    std::ifstream readFromFile{scanCachePath};
+    if (!readFromFile.is_open()) {
+        return false;
+    }
+    std::string line{""};
+    if ((!std::getline(readFromFile, line)) || (line != SCAN_CACHE_HEADER)) {
+        return false;
+    }
+    CachedScan *currentScan{nullptr};
+    while (std::getline(readFromFile, line)) {
+        std::vector<std::string> fields{splitOnTabs(line)};
+        if ((fields[0] == "file") && (fields.size() == 4)) {
+            CachedScan cachedScan{FileStamp{-1, -1}, true, false, {}, {}};
+            if (!parseFileStamp(fields[2], fields[3], cachedScan.fileStamp)) {
+                currentScan = nullptr;
+                continue;
+            }
+            currentScan = &(this->m_scanCache[fields[1]] = cachedScan);
+        } else if ((fields[0] == "include") && (fields.size() == 4) && (currentScan)) {
+            currentScan->includes.emplace_back(IncludeDirective{fields[3], (fields[1] == "<"), (fields[2] == "1")});
+        }
+    }
+    return true;
+}
+
+bool HeaderScanner::saveScanCache(const std::string &scanCachePath) const
+{
+    //Only files reached by the last scan are kept, so headers that are no
+    //longer included by anything drop out of the cache
+    std::string temporaryPath{scanCachePath + ".tmp"};
+    std::ofstream writeToFile{temporaryPath};
+    if (!writeToFile.is_open()) {
+        return false;
+    }
+    writeToFile << SCAN_CACHE_HEADER << '\n';
+    for (auto &it : this->m_scanCache) {
+        if ((!it.second.used) || (!it.second.readable) || (it.second.fileStamp.modifiedTime < 0)) {
+            continue;
+        }
+        writeToFile << "file\t" << it.first << '\t' << it.second.fileStamp.modifiedTime << '\t' << it.second.fileStamp.size << '\n';
+        for (auto &includeIt : it.second.includes) {
+            writeToFile << "include\t" << (includeIt.angled ? '<' : '"') << '\t' << (includeIt.leading ? '1' : '0') << '\t' << includeIt.headerName << '\n';
+        }
+    }
+    writeToFile.close();
+    if (!writeToFile) {
+        return false;
+    }
+    return (std::rename(temporaryPath.c_str(), scanCachePath.c_str()) == 0);
+}
+
+std::string HeaderScanner::resolveInclude(const std::string &includingFile, const IncludeDirective &includeDirective)
+{
+    //"quoted" headers are looked for next to the including file first, while
+    //<angled> ones only come from include paths; system headers are never
+    //found here, which keeps the walk inside of the project
+    std::string includingDirectory{includeDirective.angled ? "" : parentDirectory(includingFile)};
+    std::string resolutionKey{includingDirectory + '\t' + (includeDirective.angled ? '<' : '"') + includeDirective.headerName};
+    auto foundResolution = this->m_resolvedPaths.find(resolutionKey);
+    if (foundResolution != this->m_resolvedPaths.end()) {
+        return foundResolution->second;
+    }
+    std::vector<std::string> candidatePaths;
+    if (includeDirective.headerName[0] == '/') {
+        candidatePaths.emplace_back(includeDirective.headerName);
+    } else {
+        if (!includeDirective.angled) {
+            candidatePaths.emplace_back(includingDirectory + "/" + includeDirective.headerName);
+        }
+        for (auto &it : this->m_includePaths) {
+            candidatePaths.emplace_back(it + "/" + includeDirective.headerName);
+        }
+    }
+    std::string resolvedPath{""};
+    for (auto &it : candidatePaths) {
+        struct stat fileStat;
+        if ((stat(it.c_str(), &fileStat) == 0) && (S_ISREG(fileStat.st_mode))) {
+            char canonicalPath[PATH_MAX];
+            resolvedPath = ((realpath(it.c_str(), canonicalPath) != nullptr) ? static_cast<std::string>(canonicalPath) : it);
+            break;
+        }
+    }
+    this->m_resolvedPaths.emplace(resolutionKey, resolvedPath);
+    return resolvedPath;
+}
+
+void HeaderScanner::refreshScans(const std::vector<std::string> &filePaths, unsigned int jobCount)
+{
+    //Files whose modification time and size still match the cache are not
+    //opened at all; the map is only read while the workers run
+    long long scanStartTime{currentFileSystemTime()};
+    std::vector<CachedScan> freshScans(filePaths.size(), CachedScan{FileStamp{-1, -1}, false, true, {}, {}});
+    std::vector<char> needsUpdate(filePaths.size(), 0);
+    runInParallel(filePaths.size(), jobCount, [&](size_t fileIndex) {
+        FileStamp fileStamp{-1, -1};
+        bool statSucceeded{getFileStamp(filePaths[fileIndex], fileStamp)};
+        auto foundScan = this->m_scanCache.find(filePaths[fileIndex]);
+        if ((statSucceeded) && (foundScan != this->m_scanCache.end()) && (foundScan->second.readable) 
+            && (foundScan->second.fileStamp.modifiedTime >= 0) && (foundScan->second.fileStamp == fileStamp)) {
+            return;
+        }
+        ScanResult scanResult{scanFile(filePaths[fileIndex])};
+        CachedScan &freshScan = freshScans[fileIndex];
+        freshScan.readable = scanResult.readable;
+        freshScan.includes = std::move(scanResult.includes);
+        //A file written during this same clock tick could change again
+        //without its stamp changing, so it is not trusted next time
+        freshScan.fileStamp = ((fileStamp.modifiedTime < scanStartTime) ? fileStamp : FileStamp{-1, -1});
+        needsUpdate[fileIndex] = 1;
+    });
+    for (size_t i = 0; i < filePaths.size(); i++) {
+        if (needsUpdate[i]) {
+            this->m_scanCache[filePaths[i]] = std::move(freshScans[i]);
+        } else {
+            this->m_scanCache[filePaths[i]].used = true;
+        }
+    }
+}
+
+std::vector<ScanResult> HeaderScanner::scanFiles(const std::vector<std::string> &filePaths, unsigned int jobCount)
+{
+    //Breadth first over the include graph, so every level of headers is
+    //scanned in parallel and each header only once, however often included
+    std::unordered_set<std::string> visitedFiles;
+    std::vector<std::string> pendingFiles;
+    for (auto &it : filePaths) {
+        if (visitedFiles.emplace(it).second) {
+            pendingFiles.emplace_back(it);
+        }
+    }
+    while (!pendingFiles.empty()) {
+        this->refreshScans(pendingFiles, jobCount);
+        std::vector<std::string> nextFiles;
+        for (auto &it : pendingFiles) {
+            CachedScan &cachedScan = this->m_scanCache[it];
+            cachedScan.resolvedIncludes.clear();
+            for (auto &includeIt : cachedScan.includes) {
+                std::string resolvedPath{this->resolveInclude(it, includeIt)};
+                if ((!resolvedPath.empty()) && (visitedFiles.emplace(resolvedPath).second)) {
+                    nextFiles.emplace_back(resolvedPath);
+                }
+                cachedScan.resolvedIncludes.emplace_back(std::move(resolvedPath));
+            }
+        }
+        pendingFiles.swap(nextFiles);
+    }
+    std::vector<ScanResult> scanResults;
+    for (auto &it : filePaths) {
+        const CachedScan &cachedScan = this->m_scanCache[it];
+        ScanResult scanResult{cachedScan.readable, cachedScan.includes, {}};
+        std::unordered_set<std::string> reachedFiles{it};
+        std::vector<std::string> filesToVisit{cachedScan.resolvedIncludes};
+        while (!filesToVisit.empty()) {
+            std::string currentFile{std::move(filesToVisit.back())};
+            filesToVisit.pop_back();
+            if ((currentFile.empty()) || (!reachedFiles.emplace(currentFile).second)) {
+                continue;
+            }
+            const CachedScan &nestedScan = this->m_scanCache[currentFile];
+            scanResult.nestedIncludes.insert(scanResult.nestedIncludes.end(), nestedScan.includes.begin(), nestedScan.includes.end());
+            filesToVisit.insert(filesToVisit.end(), nestedScan.resolvedIncludes.begin(), nestedScan.resolvedIncludes.end());
+        }
+        scanResults.emplace_back(std::move(scanResult));
+    }
+    return scanResults;
+}
@@ -0,0 +1,110 @@
+/***********************************************************************
+*    linkerdetector.cpp:                                               *
+*    Picks the fastest linker the compiler can use for EasyGpp         *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a LinkerDetector class. This*
+*    class asks the compiler driver to use mold, lld and gold (in that *
+*    order) and remembers the first one that works, so the probe only  *
+*    runs again when the compiler or PATH changes                      *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "linkerdetector.h"
+#include "easygpputilities.h"
+#include "buildscheduler.h"
+
+#include <fstream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace EasyGppUtilities;
+
+static const char *LINKER_CACHE_HEADER{"EasyGppLinkerCache\t1"};
+static const std::vector<const char *> FAST_LINKERS{"mold", "lld", "gold"};
+
+LinkerDetector::LinkerDetector(const std::string &cachePath) :
+    m_cachePath{cachePath}
+{
+
+}
+
+std::string LinkerDetector::detectFastestLinker(const std::string &compilerCommand, const std::string &compilerIdentity) const
+{
+    std::string pathString{(getenv("PATH") != nullptr) ? static_cast<std::string>(getenv("PATH")) : ""};
+    std::string cacheKey{toHexString(fnv1a64(compilerCommand + "\n" + compilerIdentity + "\n" + pathString))};
+    std::ifstream readFromFile{this->m_cachePath};
+    if (readFromFile.is_open()) {
+        std::string line{""};
+        std::string cachedKey{""};
+        bool linkerFound{false};
+        std::string cachedLinker{""};
+        if ((std::getline(readFromFile, line)) && (line == LINKER_CACHE_HEADER)) {
+            while (std::getline(readFromFile, line)) {
+                std::vector<std::string> fields{splitOnTabs(line)};
+                if ((fields[0] == "key") && (fields.size() == 2)) {
+                    cachedKey = fields[1];
+                } else if ((fields[0] == "linker") && (fields.size() == 2)) {
+                    cachedLinker = fields[1];
+                    linkerFound = true;
+                }
+            }
+        }
+        if ((linkerFound) && (cachedKey == cacheKey)) {
+            return cachedLinker;
+        }
+        readFromFile.close();
+    }
+    std::string returnString{""};
+    for (auto &it : FAST_LINKERS) {
+        if (linkerWorks(compilerCommand, it)) {
+            returnString = it;
+            break;
+        }
+    }
+    if (makeDirectoryPath(parentDirectory(this->m_cachePath))) {
+        std::string temporaryPath{this->m_cachePath + ".tmp"};
+        std::ofstream writeToFile{temporaryPath};
+        if (writeToFile.is_open()) {
+            writeToFile << LINKER_CACHE_HEADER << '\n';
+            writeToFile << "key\t" << cacheKey << '\n';
+            writeToFile << "linker\t" << returnString << '\n';
+            writeToFile.close();
+            if (writeToFile) {
+                std::rename(temporaryPath.c_str(), this->m_cachePath.c_str());
+            }
+        }
+    }
+    return returnString;
+}
+
+bool LinkerDetector::linkerWorks(const std::string &compilerCommand, const std::string &linkerName)
+{
+    //The driver runs the linker with only --version, which fails quickly
+    //when the linker is missing or the driver does not know about it
+    BuildResult buildResult{BuildScheduler::runCommand(compilerCommand + " -fuse-ld=" + linkerName + " -Wl,--version")};
+    return ((buildResult.returnValue == 0) && (buildResult.output.find("cannot find") == std::string::npos));
+}
+
+bool LinkerDetector::supportsGdbIndex(const std::string &linkerName)
+{
+    //GNU ld (bfd) has no --gdb-index
+    return ((linkerName == "mold") || (linkerName == "lld") || (linkerName == "gold"));
+}
+
+std::string LinkerDetector::thinLtoCacheSwitch(const std::string &linkerName, const std::string &cacheDirectory)
+{
+    //lld runs the ThinLTO backends itself, the others hand them to the
+    //LLVMgold plugin, which takes its options through -plugin-opt
+    if (linkerName == "lld") {
+        return (" -Wl,--thinlto-cache-dir=" + cacheDirectory);
+    }
+    return (" -Wl,-plugin-opt,cache-dir=" + cacheDirectory);
+}
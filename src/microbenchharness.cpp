@@ -0,0 +1,318 @@
+/***********************************************************************
+*    microbenchharness.cpp:                                            *
+*    Generates a micro-benchmark harness for one function for EasyGpp  *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a MicrobenchHarness class.  *
+*    This class writes a translation unit that includes the source     *
+*    file holding the program's main() (renaming that main() out of    *
+*    the way) and replaces it with one that calls a single function in *
+*    a tight loop, scaling the iteration count to a target runtime and *
+*    reporting the time per call with a confidence interval            *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "microbenchharness.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <cctype>
+
+//The rest of the harness, after the included source. The call goes through
+//a lambda so a void function and one returning a value are timed the same
+//way, and a value that is returned is passed to an empty asm statement,
+//which the compiler has to assume reads it (so the call cannot be removed).
+//The arguments are evaluated once, into a tuple, and every one of them goes
+//through an empty asm statement that the compiler has to assume changes it
+//before each call, so a call with constant arguments (eg "fibonacci(30)")
+//can neither be folded at compile time nor hoisted out of the loop
+static const char *HARNESS_BODY{R"(
+namespace easygpp_microbench
+{
+    template <typename Value> inline void doNotOptimize(Value &&value)
+    {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+#if EASYGPP_MICROBENCH_OPAQUE_ARGUMENTS
+    template <typename Value> inline auto makeOpaque(Value &value) -> typename std::enable_if<std::is_scalar<Value>::value && (sizeof(Value) <= sizeof(void *))>::type
+    {
+        asm volatile("" : "+r"(value) : : "memory");
+    }
+
+    template <typename Value> inline auto makeOpaque(Value &value) -> typename std::enable_if<!(std::is_scalar<Value>::value && (sizeof(Value) <= sizeof(void *)))>::type
+    {
+        asm volatile("" : "+m"(value) : : "memory");
+    }
+
+    //std::index_sequence is C++14, and the harness builds with the project's standard
+    template <size_t... Indices> struct IndexList { };
+    template <size_t Count, size_t... Indices> struct MakeIndexList : MakeIndexList<Count - 1, Count - 1, Indices...> { };
+    template <size_t... Indices> struct MakeIndexList<0, Indices...> { typedef IndexList<Indices...> type; };
+
+    template <typename Arguments, size_t... Indices> inline auto callWith(Arguments &arguments, IndexList<Indices...>) -> decltype(EASYGPP_MICROBENCH_FUNCTION(std::get<Indices>(arguments)...))
+    {
+        typedef int Expand[];
+        (void)Expand{0, (makeOpaque(std::get<Indices>(arguments)), 0)...};
+        return EASYGPP_MICROBENCH_FUNCTION(std::get<Indices>(arguments)...);
+    }
+#endif
+
+    template <typename Function> inline auto invoke(Function &function, int) -> typename std::enable_if<!std::is_void<decltype(function())>::value>::type
+    {
+        auto &&result = function();
+        doNotOptimize(result);
+    }
+
+    template <typename Function> inline void invoke(Function &function, long)
+    {
+        function();
+        asm volatile("" : : : "memory");
+    }
+
+    template <typename Function> double timeBatch(Function &function, unsigned long long iterations)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        for (unsigned long long i = 0; i < iterations; i++) {
+            invoke(function, 0);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    double tCriticalValue(size_t degreesOfFreedom)
+    {
+        static const double T_CRITICAL_VALUES[]{12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                                2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                                2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+        return (((degreesOfFreedom >= 1) && (degreesOfFreedom <= 30)) ? T_CRITICAL_VALUES[degreesOfFreedom - 1] : 1.96);
+    }
+}
+
+int main()
+{
+    using namespace easygpp_microbench;
+#if EASYGPP_MICROBENCH_OPAQUE_ARGUMENTS
+    auto arguments = std::make_tuple(EASYGPP_MICROBENCH_ARGUMENTS);
+    auto benchmarkedCall = [&arguments]() { return callWith(arguments, typename MakeIndexList<std::tuple_size<decltype(arguments)>::value>::type{}); };
+#else
+    auto benchmarkedCall = []() { return (EASYGPP_MICROBENCH_CALL); };
+#endif
+    const double sampleNanoseconds{EASYGPP_MICROBENCH_TARGET_SECONDS * 1.0e9 / EASYGPP_MICROBENCH_SAMPLES};
+
+    //Grow the batch until one takes as long as a sample should, which also
+    //warms the caches and the branch predictors up
+    unsigned long long iterations{1};
+    double elapsedNanoseconds{timeBatch(benchmarkedCall, iterations)};
+    while ((elapsedNanoseconds < sampleNanoseconds) && (iterations < (1ULL << 40))) {
+        double scale{(elapsedNanoseconds <= 0.0) ? 10.0 : (1.2 * sampleNanoseconds / elapsedNanoseconds)};
+        scale = std::min(10.0, std::max(2.0, scale));
+        iterations = static_cast<unsigned long long>(static_cast<double>(iterations) * scale);
+        elapsedNanoseconds = timeBatch(benchmarkedCall, iterations);
+    }
+    auto warmupStart = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - warmupStart).count() < EASYGPP_MICROBENCH_WARMUP_SECONDS) {
+        timeBatch(benchmarkedCall, iterations);
+    }
+
+    std::vector<double> samples;
+    for (unsigned int i = 0; i < EASYGPP_MICROBENCH_SAMPLES; i++) {
+        samples.push_back(timeBatch(benchmarkedCall, iterations) / static_cast<double>(iterations));
+    }
+    std::vector<double> sortedSamples{samples};
+    std::sort(sortedSamples.begin(), sortedSamples.end());
+    double total{0.0};
+    for (auto &it : samples) {
+        total += it;
+    }
+    double mean{total / static_cast<double>(samples.size())};
+    double squaredDeviations{0.0};
+    for (auto &it : samples) {
+        squaredDeviations += (it - mean) * (it - mean);
+    }
+    double standardDeviation{(samples.size() > 1) ? std::sqrt(squaredDeviations / static_cast<double>(samples.size() - 1)) : 0.0};
+    double halfWidth{tCriticalValue(samples.size() - 1) * standardDeviation / std::sqrt(static_cast<double>(samples.size()))};
+    double median{(sortedSamples.size() % 2 == 1) ? sortedSamples[sortedSamples.size() / 2]
+                                                  : ((sortedSamples[sortedSamples.size() / 2 - 1] + sortedSamples[sortedSamples.size() / 2]) / 2.0)};
+    std::printf("Microbenchmark of %s\n", EASYGPP_MICROBENCH_DESCRIPTION);
+    std::printf("    %u samples of %llu calls each\n", EASYGPP_MICROBENCH_SAMPLES, iterations);
+    std::printf("    %-12s %14.3f ns +/- %.3f ns (95%% confidence interval)\n", "mean", mean, halfWidth);
+    std::printf("    %-12s %14.3f ns\n", "median", median);
+    std::printf("    %-12s %14.3f ns\n", "stddev", standardDeviation);
+    std::printf("    %-12s %14.3f ns\n", "min", sortedSamples.front());
+    std::printf("    %-12s %14.3f ns\n", "max", sortedSamples.back());
+    std::printf("    %-12s %14.0f calls per second\n", "throughput", (mean > 0.0) ? (1.0e9 / mean) : 0.0);
+    return 0;
+}
+)"};
+
+MicrobenchHarness::MicrobenchHarness(const std::string &functionCall, unsigned int sampleCount, double targetSeconds, double warmupSeconds) :
+    m_callExpression{(functionCall.find('(') == std::string::npos) ? (functionCall + "()") : functionCall},
+    m_sampleCount{(sampleCount < 2) ? 2 : sampleCount},
+    m_targetSeconds{targetSeconds},
+    m_warmupSeconds{warmupSeconds}
+{
+
+}
+
+std::string MicrobenchHarness::callExpression() const
+{
+    return this->m_callExpression;
+}
+
+std::string MicrobenchHarness::stringLiteral(const std::string &text)
+{
+    std::string returnString{"\""};
+    for (auto &it : text) {
+        if ((it == '"') || (it == '\\')) {
+            returnString += '\\';
+        }
+        returnString += it;
+    }
+    return returnString + "\"";
+}
+
+bool MicrobenchHarness::splitCall(const std::string &callExpression, std::string &function, std::string &arguments)
+{
+    //The arguments are the last parenthesized group at the top level, which
+    //has to end the expression, eg "solve(grid, 3)" or "std::max<int>(a, b)"
+    size_t callEnd{callExpression.find_last_not_of(" \t")};
+    if ((callEnd == std::string::npos) || (callExpression[callEnd] != ')')) {
+        return false;
+    }
+    int depth{0};
+    size_t argumentsStart{std::string::npos};
+    for (size_t i = 0; i <= callEnd; i++) {
+        char character{callExpression[i]};
+        if ((character == '"') || (character == '\'')) {
+            for (i++; (i < callEnd) && (callExpression[i] != character); i++) {
+                if (callExpression[i] == '\\') {
+                    i++;
+                }
+            }
+        } else if ((character == '(') || (character == '[') || (character == '{')) {
+            if ((depth == 0) && (character == '(')) {
+                argumentsStart = i;
+            }
+            depth++;
+        } else if ((character == ')') || (character == ']') || (character == '}')) {
+            if (--depth < 0) {
+                return false;
+            }
+        }
+    }
+    if ((depth != 0) || (argumentsStart == std::string::npos) || (callExpression.find_first_not_of(" \t") >= argumentsStart)) {
+        return false;
+    }
+    function = callExpression.substr(0, argumentsStart);
+    arguments = callExpression.substr(argumentsStart + 1, callEnd - argumentsStart - 1);
+    return true;
+}
+
+std::string MicrobenchHarness::source(const std::string &includedSource) const
+{
+    std::stringstream returnStream;
+    returnStream << "//Generated by easyg++ --microbench, changes are overwritten" << std::endl;
+    returnStream << "#include <algorithm>" << std::endl;
+    returnStream << "#include <chrono>" << std::endl;
+    returnStream << "#include <cmath>" << std::endl;
+    returnStream << "#include <cstdio>" << std::endl;
+    returnStream << "#include <tuple>" << std::endl;
+    returnStream << "#include <type_traits>" << std::endl;
+    returnStream << "#include <vector>" << std::endl << std::endl;
+    //The included main() is never called, so one that falls off its end
+    //(which only main() may do), or the static functions only it used, are
+    //not worth a warning
+    returnStream << "#pragma GCC diagnostic push" << std::endl;
+    returnStream << "#pragma GCC diagnostic ignored \"-Wreturn-type\"" << std::endl;
+    returnStream << "#pragma GCC diagnostic ignored \"-Wunused-function\"" << std::endl;
+    returnStream << "#define main easygpp_microbench_replaced_main" << std::endl;
+    returnStream << "#include " << stringLiteral(includedSource) << std::endl;
+    returnStream << "#undef main" << std::endl;
+    returnStream << "#pragma GCC diagnostic pop" << std::endl << std::endl;
+    std::string function{""};
+    std::string arguments{""};
+    bool opaqueArguments{splitCall(this->m_callExpression, function, arguments)};
+    returnStream << "#define EASYGPP_MICROBENCH_CALL " << this->m_callExpression << std::endl;
+    returnStream << "#define EASYGPP_MICROBENCH_OPAQUE_ARGUMENTS " << (opaqueArguments ? 1 : 0) << std::endl;
+    if (opaqueArguments) {
+        returnStream << "#define EASYGPP_MICROBENCH_FUNCTION " << function << std::endl;
+        returnStream << "#define EASYGPP_MICROBENCH_ARGUMENTS " << arguments << std::endl;
+    }
+    returnStream << "#define EASYGPP_MICROBENCH_DESCRIPTION " << stringLiteral(this->m_callExpression) << std::endl;
+    returnStream << "#define EASYGPP_MICROBENCH_SAMPLES " << this->m_sampleCount << "u" << std::endl;
+    returnStream << std::fixed << std::setprecision(3);
+    returnStream << "#define EASYGPP_MICROBENCH_TARGET_SECONDS " << this->m_targetSeconds << std::endl;
+    returnStream << "#define EASYGPP_MICROBENCH_WARMUP_SECONDS " << this->m_warmupSeconds << std::endl;
+    returnStream << HARNESS_BODY;
+    return returnStream.str();
+}
+
+bool MicrobenchHarness::write(const std::string &harnessPath, const std::string &includedSource) const
+{
+    std::string harnessContents{this->source(includedSource)};
+    std::ifstream readFromFile{harnessPath};
+    if (readFromFile.is_open()) {
+        std::stringstream existingContents;
+        existingContents << readFromFile.rdbuf();
+        if (existingContents.str() == harnessContents) {
+            return true;
+        }
+        readFromFile.close();
+    }
+    std::ofstream writeToFile{harnessPath};
+    if (!writeToFile.is_open()) {
+        return false;
+    }
+    writeToFile << harnessContents;
+    writeToFile.close();
+    return static_cast<bool>(writeToFile);
+}
+
+bool MicrobenchHarness::definesMain(const std::string &sourceFile)
+{
+    std::ifstream readFromFile{sourceFile};
+    if (!readFromFile.is_open()) {
+        return false;
+    }
+    std::stringstream fileContents;
+    fileContents << readFromFile.rdbuf();
+    const std::string contents{fileContents.str()};
+    for (size_t i = 0; i < contents.length(); ) {
+        if (contents.compare(i, 2, "//") == 0) {
+            size_t lineEnd{contents.find('\n', i)};
+            i = ((lineEnd == std::string::npos) ? contents.length() : lineEnd);
+        } else if (contents.compare(i, 2, "/*") == 0) {
+            size_t commentEnd{contents.find("*/", i + 2)};
+            i = ((commentEnd == std::string::npos) ? contents.length() : (commentEnd + 2));
+        } else if ((contents[i] == '"') || (contents[i] == '\'')) {
+            char quote{contents[i]};
+            for (i++; (i < contents.length()) && (contents[i] != quote) && (contents[i] != '\n'); i++) {
+                if (contents[i] == '\\') {
+                    i++;
+                }
+            }
+            i++;
+        } else if ((std::isalpha(static_cast<unsigned char>(contents[i]))) || (contents[i] == '_')) {
+            size_t identifierStart{i};
+            while ((i < contents.length()) && ((std::isalnum(static_cast<unsigned char>(contents[i]))) || (contents[i] == '_'))) {
+                i++;
+            }
+            if (contents.compare(identifierStart, i - identifierStart, "main") == 0) {
+                size_t nextCharacter{contents.find_first_not_of(" \t\r\n", i)};
+                if ((nextCharacter != std::string::npos) && (contents[nextCharacter] == '(')) {
+                    return true;
+                }
+            }
+        } else {
+            i++;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,416 @@
+/***********************************************************************
+*    optimizationremarks.cpp:                                          *
+*    Collects the compiler's optimization remarks for EasyGpp          *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of an OptimizationRemarks      *
+*    class. This class adds the compiler's remark switches to every    *
+*    compile, gathers what each translation unit reported about        *
+*    vectorization and inlining (gcc's -fopt-info output, or clang's   *
+*    saved optimization record), and turns it into one summary sorted  *
+*    by file, function and line                                        *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "optimizationremarks.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <cstdlib>
+#include <cctype>
+
+#include <cxxabi.h>
+#include <unistd.h>
+
+static const char *GCC_REMARK_SWITCHES{" -fopt-info-vec-missed -fopt-info-inline-optimized-missed"};
+static const char *CLANG_REMARK_SWITCHES{" -Rpass-missed=loop-vectorize -fsave-optimization-record -foptimization-record-passes='loop-vectorize|inline'"};
+static const char *UNKNOWN_FUNCTION{"(function not reported by the compiler)"};
+
+namespace {
+    std::vector<std::string> splitLines(const std::string &text)
+    {
+        std::vector<std::string> returnVector;
+        std::stringstream textStream{text};
+        std::string line{""};
+        while (std::getline(textStream, line)) {
+            returnVector.emplace_back(line);
+        }
+        return returnVector;
+    }
+
+    bool startsWith(const std::string &stringToCheck, const std::string &prefix)
+    {
+        return (stringToCheck.compare(0, prefix.length(), prefix) == 0);
+    }
+
+    std::string trimmed(const std::string &stringToTrim)
+    {
+        size_t firstCharacter{stringToTrim.find_first_not_of(" \t")};
+        if (firstCharacter == std::string::npos) {
+            return "";
+        }
+        return stringToTrim.substr(firstCharacter, stringToTrim.find_last_not_of(" \t") - firstCharacter + 1);
+    }
+
+    bool isNumber(const std::string &stringToCheck)
+    {
+        return ((!stringToCheck.empty()) && (std::all_of(stringToCheck.begin(), stringToCheck.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; })));
+    }
+
+    //gcc tags every function in its inlining remarks with a call graph node
+    //number ("int f()/12"), which means nothing to the reader
+    std::string stripNodeNumbers(const std::string &message)
+    {
+        std::string returnString{""};
+        for (size_t i = 0; i < message.length(); i++) {
+            if ((message[i] == '/') && (i + 1 < message.length()) && (std::isdigit(static_cast<unsigned char>(message[i + 1])))) {
+                size_t numberEnd{message.find_first_not_of("0123456789", i + 1)};
+                if ((numberEnd == std::string::npos) || (std::string{" .,-"}.find(message[numberEnd]) != std::string::npos)) {
+                    i = ((numberEnd == std::string::npos) ? message.length() : numberEnd) - 1;
+                    continue;
+                }
+            }
+            returnString += message[i];
+        }
+        return returnString;
+    }
+
+    //"Inlining g()/3 into f()/2.", "Inlined g()/3 into f()/2 which now has ..."
+    //and "will not early inline: f()/2->g()/3, ..." all name the function the
+    //remark is about (the caller)
+    std::string gccRemarkFunction(const std::string &message)
+    {
+        size_t foundInto{message.rfind(" into ")};
+        if (((startsWith(message, "Inlining ")) || (startsWith(message, "Inlined "))) && (foundInto != std::string::npos)) {
+            std::string function{message.substr(foundInto + 6)};
+            size_t foundWhich{function.find(" which ")};
+            if (foundWhich != std::string::npos) {
+                function.erase(foundWhich);
+            }
+            if ((!function.empty()) && (function.back() == '.')) {
+                function.pop_back();
+            }
+            return stripNodeNumbers(function);
+        }
+        size_t foundArrow{message.find("->")};
+        if (foundArrow != std::string::npos) {
+            std::string caller{message.substr(0, foundArrow)};
+            size_t foundColon{caller.find(": ")};
+            if (foundColon != std::string::npos) {
+                caller.erase(0, foundColon + 2);
+            }
+            return trimmed(stripNodeNumbers(caller));
+        }
+        return "";
+    }
+
+    std::string demangled(const std::string &symbolName)
+    {
+        int status{0};
+        std::unique_ptr<char, void (*)(void *)> demangledName{abi::__cxa_demangle(symbolName.c_str(), nullptr, nullptr, &status), free};
+        return (((status == 0) && (demangledName)) ? static_cast<std::string>(demangledName.get()) : symbolName);
+    }
+
+    //The optimization record is YAML written by LLVM, where a value is
+    //either plain, 'single quoted' (with '' for a quote) or "double quoted"
+    std::string yamlValue(const std::string &rawValue)
+    {
+        std::string value{trimmed(rawValue)};
+        if ((value.length() >= 2) && (value.front() == '\'') && (value.back() == '\'')) {
+            std::string returnString{""};
+            for (size_t i = 1; i + 1 < value.length(); i++) {
+                returnString += value[i];
+                if ((value[i] == '\'') && (value[i + 1] == '\'')) {
+                    i++;
+                }
+            }
+            return returnString;
+        }
+        if ((value.length() >= 2) && (value.front() == '"') && (value.back() == '"')) {
+            std::string returnString{""};
+            for (size_t i = 1; i + 1 < value.length(); i++) {
+                if ((value[i] == '\\') && (i + 2 < value.length())) {
+                    i++;
+                    returnString += ((value[i] == 'n') ? '\n' : value[i]);
+                } else {
+                    returnString += value[i];
+                }
+            }
+            return returnString;
+        }
+        return value;
+    }
+
+    //"{ File: a.cpp, Line: 10, Column: 5 }"
+    bool parseDebugLoc(const std::string &rawValue, std::string &file, int &line, int &column)
+    {
+        std::string value{trimmed(rawValue)};
+        if ((value.length() < 2) || (value.front() != '{') || (value.back() != '}')) {
+            return false;
+        }
+        value = value.substr(1, value.length() - 2);
+        bool foundLine{false};
+        size_t position{0};
+        while (position < value.length()) {
+            size_t foundColon{value.find(':', position)};
+            if (foundColon == std::string::npos) {
+                break;
+            }
+            std::string key{trimmed(value.substr(position, foundColon - position))};
+            size_t valueStart{value.find_first_not_of(' ', foundColon + 1)};
+            if (valueStart == std::string::npos) {
+                break;
+            }
+            size_t valueEnd{value.find(',', valueStart)};
+            if ((value[valueStart] == '\'') || (value[valueStart] == '"')) {
+                size_t closingQuote{value.find(value[valueStart], valueStart + 1)};
+                while ((closingQuote != std::string::npos) && (value[valueStart] == '\'') && (closingQuote + 1 < value.length()) && (value[closingQuote + 1] == '\'')) {
+                    closingQuote = value.find('\'', closingQuote + 2);
+                }
+                valueEnd = ((closingQuote == std::string::npos) ? std::string::npos : value.find(',', closingQuote));
+            }
+            std::string entry{yamlValue(value.substr(valueStart, (valueEnd == std::string::npos) ? std::string::npos : valueEnd - valueStart))};
+            if (key == "File") {
+                file = entry;
+            } else if ((key == "Line") && (isNumber(entry))) {
+                line = std::stoi(entry);
+                foundLine = true;
+            } else if ((key == "Column") && (isNumber(entry))) {
+                column = std::stoi(entry);
+            }
+            position = ((valueEnd == std::string::npos) ? value.length() : valueEnd + 1);
+        }
+        return ((file != "") && (foundLine));
+    }
+}
+
+OptimizationRemarks::OptimizationRemarks(bool clangRemarks, const std::vector<std::string> &fileFilters) :
+    m_clangRemarks{clangRemarks},
+    m_fileFilters{fileFilters},
+    m_workingDirectory{""},
+    m_filteredCount{0}
+{
+    std::unique_ptr<char, void (*)(void *)> workingDirectory{getcwd(nullptr, 0), free};
+    if (workingDirectory) {
+        this->m_workingDirectory = static_cast<std::string>(workingDirectory.get()) + "/";
+    }
+}
+
+std::string OptimizationRemarks::compileSwitches() const
+{
+    return (this->m_clangRemarks ? CLANG_REMARK_SWITCHES : GCC_REMARK_SWITCHES);
+}
+
+bool OptimizationRemarks::keepFile(const std::string &file) const
+{
+    if (this->m_fileFilters.empty()) {
+        return ((file.front() != '/') || ((this->m_workingDirectory != "") && (startsWith(file, this->m_workingDirectory))));
+    }
+    for (auto &it : this->m_fileFilters) {
+        if (file.find(it) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void OptimizationRemarks::addRemark(const Remark &remark)
+{
+    if ((remark.file == "") || (!this->keepFile(remark.file))) {
+        this->m_filteredCount++;
+        return;
+    }
+    //A header included by several translation units reports the same
+    //remark once for each of them
+    std::stringstream remarkKey;
+    remarkKey << remark.file << ':' << remark.line << ':' << remark.column << ':' << remark.kind << ':' << remark.message;
+    if (this->m_seenRemarks.emplace(remarkKey.str()).second) {
+        this->m_remarks.emplace_back(remark);
+    }
+}
+
+std::string OptimizationRemarks::addTranslationUnit(const std::string &objectFile, const std::string &output)
+{
+    if (this->m_clangRemarks) {
+        this->readClangRecord(objectFile);
+        return this->stripClangRemarks(output);
+    }
+    return this->readGccRemarks(output);
+}
+
+size_t OptimizationRemarks::remarkCount() const
+{
+    return this->m_remarks.size();
+}
+
+std::string OptimizationRemarks::readGccRemarks(const std::string &output)
+{
+    //"a.cpp:12:23: missed: couldn't vectorize loop"
+    std::string returnString{""};
+    for (auto &line : splitLines(output)) {
+        size_t foundKind{std::string::npos};
+        std::string kind{""};
+        for (auto &it : {"missed", "optimized"}) {
+            foundKind = line.find(": " + static_cast<std::string>(it) + ": ");
+            if (foundKind != std::string::npos) {
+                kind = it;
+                break;
+            }
+        }
+        size_t foundColumn{(foundKind == std::string::npos) ? std::string::npos : line.rfind(':', foundKind - 1)};
+        size_t foundLine{((foundColumn == std::string::npos) || (foundColumn == 0)) ? std::string::npos : line.rfind(':', foundColumn - 1)};
+        if ((foundLine == std::string::npos)
+            || (!isNumber(line.substr(foundLine + 1, foundColumn - foundLine - 1)))
+            || (!isNumber(line.substr(foundColumn + 1, foundKind - foundColumn - 1)))) {
+            returnString += (line + "\n");
+            continue;
+        }
+        std::string message{trimmed(line.substr(foundKind + kind.length() + 4))};
+        this->addRemark(Remark{line.substr(0, foundLine),
+                               std::stoi(line.substr(foundLine + 1, foundColumn - foundLine - 1)),
+                               std::stoi(line.substr(foundColumn + 1, foundKind - foundColumn - 1)),
+                               kind,
+                               gccRemarkFunction(message),
+                               stripNodeNumbers(message)});
+    }
+    return returnString;
+}
+
+std::string OptimizationRemarks::stripClangRemarks(const std::string &output) const
+{
+    //The record holds everything -Rpass-missed printed, so the printed
+    //copy (and the source line and caret clang shows under it) is dropped
+    std::string returnString{""};
+    bool inRemark{false};
+    for (auto &line : splitLines(output)) {
+        if (line.find(": remark: ") != std::string::npos) {
+            inRemark = true;
+            continue;
+        }
+        size_t foundBar{line.find('|')};
+        if ((inRemark) && (foundBar != std::string::npos) && (line.find_first_not_of(" 0123456789") == foundBar)) {
+            continue;
+        }
+        inRemark = false;
+        returnString += (line + "\n");
+    }
+    return returnString;
+}
+
+void OptimizationRemarks::readClangRecord(const std::string &objectFile)
+{
+    //clang names the record after the object, with .opt.yaml in place of .o
+    std::string recordPath{objectFile};
+    if ((recordPath.length() > 2) && (recordPath.compare(recordPath.length() - 2, 2, ".o") == 0)) {
+        recordPath.erase(recordPath.length() - 2);
+    }
+    std::ifstream readFromFile{recordPath + ".opt.yaml"};
+    if (!readFromFile.is_open()) {
+        readFromFile.open(objectFile + ".opt.yaml");
+        if (!readFromFile.is_open()) {
+            return;
+        }
+    }
+    //--- !Missed
+    //Pass:            inline
+    //DebugLoc:        { File: a.cpp, Line: 10, Column: 5 }
+    //Function:        _Z4mainv
+    //Args:
+    //  - Callee:          _Z3foov
+    //  - String:          ' will not be inlined into '
+    //...
+    Remark remark{"", 0, 0, "", "", ""};
+    bool inRemark{false};
+    std::string line{""};
+    while (std::getline(readFromFile, line)) {
+        if (startsWith(line, "--- !")) {
+            std::string kind{line.substr(5)};
+            std::transform(kind.begin(), kind.end(), kind.begin(), ::tolower);
+            remark = Remark{"", 0, 0, ((kind == "passed") ? "optimized" : kind), "", ""};
+            inRemark = true;
+            continue;
+        }
+        if (!inRemark) {
+            continue;
+        }
+        if (line == "...") {
+            remark.message = trimmed(remark.message);
+            this->addRemark(remark);
+            inRemark = false;
+            continue;
+        }
+        size_t foundColon{line.find(':')};
+        if (foundColon == std::string::npos) {
+            continue;
+        }
+        std::string key{line.substr(0, foundColon)};
+        std::string value{line.substr(foundColon + 1)};
+        if (key == "DebugLoc") {
+            parseDebugLoc(value, remark.file, remark.line, remark.column);
+        } else if (key == "Function") {
+            remark.function = demangled(yamlValue(value));
+        } else if (startsWith(key, "  - ")) {
+            std::string argumentName{key.substr(4)};
+            remark.message += (((argumentName == "Callee") || (argumentName == "Caller")) ? demangled(yamlValue(value)) : yamlValue(value));
+        }
+    }
+}
+
+std::string OptimizationRemarks::summary() const
+{
+    std::stringstream returnStream;
+    std::map<std::string, std::vector<const Remark *>> remarksByFile;
+    for (auto &it : this->m_remarks) {
+        remarksByFile[it.file].emplace_back(&it);
+    }
+    returnStream << "Optimization remarks (" << this->m_remarks.size() << ((this->m_remarks.size() == 1) ? " remark" : " remarks") << ", by file, function and line):" << std::endl;
+    for (auto &fileIt : remarksByFile) {
+        std::vector<const Remark *> &fileRemarks = fileIt.second;
+        std::stable_sort(fileRemarks.begin(), fileRemarks.end(), [](const Remark *lhs, const Remark *rhs) {
+            return ((lhs->line < rhs->line) || ((lhs->line == rhs->line) && (lhs->column < rhs->column)));
+        });
+        //gcc leaves the function out of its vectorizer remarks, but any other
+        //remark on the same line is (all but certainly) in the same function
+        std::map<int, std::string> lineFunctions;
+        for (auto &it : fileRemarks) {
+            if (it->function != "") {
+                lineFunctions.emplace(it->line, it->function);
+            }
+        }
+        //Functions are listed in the order they first show up in the file
+        std::vector<std::string> functionOrder;
+        std::map<std::string, std::vector<const Remark *>> remarksByFunction;
+        for (auto &it : fileRemarks) {
+            auto foundFunction = lineFunctions.find(it->line);
+            std::string function{(it->function != "") ? it->function : ((foundFunction != lineFunctions.end()) ? foundFunction->second : UNKNOWN_FUNCTION)};
+            if (remarksByFunction.find(function) == remarksByFunction.end()) {
+                functionOrder.emplace_back(function);
+            }
+            remarksByFunction[function].emplace_back(it);
+        }
+        returnStream << "    " << fileIt.first << std::endl;
+        for (auto &functionIt : functionOrder) {
+            returnStream << "        " << functionIt << std::endl;
+            for (auto &it : remarksByFunction[functionIt]) {
+                std::stringstream location;
+                location << it->line << ':' << it->column;
+                returnStream << "            " << std::left << std::setw(9) << location.str() << std::setw(11) << it->kind << std::right << it->message << std::endl;
+            }
+        }
+    }
+    if (this->m_filteredCount != 0) {
+        returnStream << "    (" << this->m_filteredCount << " more " << ((this->m_filteredCount == 1) ? "remark" : "remarks")
+                     << ((this->m_fileFilters.empty()) ? " about system headers" : " about other files") << " left out)" << std::endl;
+    }
+    return returnStream.str();
+}
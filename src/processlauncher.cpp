@@ -0,0 +1,330 @@
+/***********************************************************************
+*    processlauncher.cpp:                                              *
+*    Starts compiled programs with controlled conditions for EasyGpp   *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a ProcessLauncher class.    *
+*    This class starts a program with posix_spawn (or fork and exec    *
+*    when it has resource limits, with no shell in between either      *
+*    way), optionally pinned to a set of CPUs, with address space      *
+*    layout randomization turned off, with address space and CPU time  *
+*    limits, and with an environment padded to a fixed size, so that   *
+*    repeated runs of a program differ as little as possible           *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "processlauncher.h"
+#include "easygpputilities.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/personality.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+static const char *ENVIRONMENT_PADDING_VARIABLE{"EASYGPP_ENVIRONMENT_PADDING"};
+static const size_t ENVIRONMENT_BLOCK_SIZE{4096};
+static const char *CPUFREQ_DIRECTORY{"/sys/devices/system/cpu/cpu"};
+static const char *PERFORMANCE_GOVERNOR{"performance"};
+
+//posix_spawn has no way to set resource limits in the child, and setting
+//them on easyg++ itself would count its own CPU time against the limit (and
+//could keep it from mapping anything more), so a program with limits is
+//started with fork() instead, setting them between the fork and the exec.
+//Only async-signal-safe calls are made in the child, since other threads
+//may be holding locks. Returns zero, or the errno of the failed step
+static int forkWithLimits(pid_t &childPid, const char *programPath, char *const *argumentPointers, char *const *environmentPointers,
+                          const int *descriptors, const struct rlimit *addressSpaceLimit, const struct rlimit *cpuTimeLimit, bool ownProcessGroup)
+{
+    //The exec's errno comes back through a close-on-exec pipe, which is
+    //simply closed (read as zero bytes) when the exec succeeds
+    int errorPipe[2]{-1, -1};
+    if (pipe2(errorPipe, O_CLOEXEC) != 0) {
+        return errno;
+    }
+    childPid = fork();
+    if (childPid < 0) {
+        int forkError{errno};
+        close(errorPipe[0]);
+        close(errorPipe[1]);
+        return forkError;
+    } else if (childPid == 0) {
+        for (int i = 0; i < 3; i++) {
+            if ((descriptors[i] >= 0) && (descriptors[i] != i)) {
+                dup2(descriptors[i], i);
+            } else if (descriptors[i] == i) {
+                fcntl(i, F_SETFD, 0);
+            }
+        }
+        int childError{0};
+        if ((ownProcessGroup) && (setpgid(0, 0) != 0)) {
+            childError = errno;
+        } else if ((addressSpaceLimit) && (setrlimit(RLIMIT_AS, addressSpaceLimit) != 0)) {
+            childError = errno;
+        } else if ((cpuTimeLimit) && (setrlimit(RLIMIT_CPU, cpuTimeLimit) != 0)) {
+            childError = errno;
+        } else {
+            execve(programPath, argumentPointers, environmentPointers);
+            childError = errno;
+        }
+        ssize_t bytesWritten{write(errorPipe[1], &childError, sizeof(childError))};
+        static_cast<void>(bytesWritten);
+        _exit(127);
+    }
+    close(errorPipe[1]);
+    int childError{0};
+    ssize_t bytesRead{0};
+    do {
+        bytesRead = read(errorPipe[0], &childError, sizeof(childError));
+    } while ((bytesRead < 0) && (errno == EINTR));
+    close(errorPipe[0]);
+    if (bytesRead == static_cast<ssize_t>(sizeof(childError))) {
+        int status{0};
+        while ((waitpid(childPid, &status, 0) < 0) && (errno == EINTR)) { }
+        childPid = -1;
+        return childError;
+    }
+    return 0;
+}
+
+ProcessLauncher::ProcessLauncher(const LaunchSettings &launchSettings) :
+    m_launchSettings{launchSettings}
+{
+
+}
+
+const LaunchSettings &ProcessLauncher::launchSettings() const
+{
+    return this->m_launchSettings;
+}
+
+std::vector<std::string> ProcessLauncher::environment(const std::string &programPath, const std::vector<std::string> &arguments) const
+{
+    std::vector<std::string> returnVector;
+    size_t stringBytes{programPath.length() + 1};
+    for (auto &it : arguments) {
+        stringBytes += (it.length() + 1);
+    }
+    const std::string paddingPrefix{static_cast<std::string>(ENVIRONMENT_PADDING_VARIABLE) + "="};
+    for (char **it = environ; *it != nullptr; it++) {
+        std::string variable{*it};
+        if (variable.compare(0, paddingPrefix.length(), paddingPrefix) != 0) {
+            stringBytes += (variable.length() + 1);
+            returnVector.emplace_back(variable);
+        }
+    }
+    if (this->m_launchSettings.normalizeEnvironment) {
+        //The argument and environment strings sit at the top of the initial
+        //stack, so their total size shifts the alignment of everything the
+        //program puts on the stack. Padding them to a whole block keeps that
+        //the same from run to run, and from shell to shell
+        stringBytes += (paddingPrefix.length() + 1);
+        size_t paddingLength{(ENVIRONMENT_BLOCK_SIZE - (stringBytes % ENVIRONMENT_BLOCK_SIZE)) % ENVIRONMENT_BLOCK_SIZE};
+        returnVector.emplace_back(paddingPrefix + std::string(paddingLength, 'x'));
+    }
+    return returnVector;
+}
+
+pid_t ProcessLauncher::spawn(const std::string &programPath, const std::vector<std::string> &arguments, int inputDescriptor, int outputDescriptor, int errorDescriptor) const
+{
+    std::vector<char *> argumentPointers;
+    argumentPointers.emplace_back(const_cast<char *>(programPath.c_str()));
+    for (auto &it : arguments) {
+        argumentPointers.emplace_back(const_cast<char *>(it.c_str()));
+    }
+    argumentPointers.emplace_back(nullptr);
+    std::vector<std::string> environmentStrings{this->environment(programPath, arguments)};
+    std::vector<char *> environmentPointers;
+    for (auto &it : environmentStrings) {
+        environmentPointers.emplace_back(const_cast<char *>(it.c_str()));
+    }
+    environmentPointers.emplace_back(nullptr);
+
+    posix_spawn_file_actions_t fileActions;
+    posix_spawn_file_actions_init(&fileActions);
+    int descriptors[3]{inputDescriptor, outputDescriptor, errorDescriptor};
+    for (int i = 0; i < 3; i++) {
+        if ((descriptors[i] >= 0) && (descriptors[i] != i)) {
+            posix_spawn_file_actions_adddup2(&fileActions, descriptors[i], i);
+        }
+    }
+
+    //posix_spawn has no attributes for the CPU affinity or the personality,
+    //but the child inherits both from the calling thread (with fork() too),
+    //so they are set on this thread for the length of the call and put back
+    //afterwards
+    cpu_set_t previousCpus;
+    bool cpusChanged{false};
+    if ((!this->m_launchSettings.cpus.empty()) && (sched_getaffinity(0, sizeof(previousCpus), &previousCpus) == 0)) {
+        cpu_set_t pinnedCpus;
+        CPU_ZERO(&pinnedCpus);
+        for (auto &it : this->m_launchSettings.cpus) {
+            CPU_SET(it, &pinnedCpus);
+        }
+        cpusChanged = (sched_setaffinity(0, sizeof(pinnedCpus), &pinnedCpus) == 0);
+    }
+    int previousPersonality{personality(0xffffffff)};
+    bool personalityChanged{false};
+    if ((this->m_launchSettings.disableAddressRandomization) && (previousPersonality != -1)) {
+        personalityChanged = (personality(static_cast<unsigned long>(previousPersonality) | ADDR_NO_RANDOMIZE) != -1);
+    }
+
+    //Worked out before forking, since the child may not allocate
+    rlim_t addressSpaceBytes{static_cast<rlim_t>(this->m_launchSettings.addressSpaceLimitMegabytes) * 1024 * 1024};
+    struct rlimit addressSpaceLimit{addressSpaceBytes, addressSpaceBytes};
+    //SIGXCPU at the soft limit, SIGKILL a second later if it is ignored, but
+    //never above the current hard limit, which only root may raise
+    struct rlimit cpuTimeLimit{static_cast<rlim_t>(this->m_launchSettings.cpuTimeLimitSeconds), static_cast<rlim_t>(this->m_launchSettings.cpuTimeLimitSeconds + 1)};
+    struct rlimit currentLimit;
+    if (getrlimit(RLIMIT_AS, &currentLimit) == 0) {
+        addressSpaceLimit.rlim_cur = addressSpaceLimit.rlim_max = std::min(addressSpaceBytes, currentLimit.rlim_max);
+    }
+    if (getrlimit(RLIMIT_CPU, &currentLimit) == 0) {
+        cpuTimeLimit.rlim_cur = std::min(cpuTimeLimit.rlim_cur, currentLimit.rlim_max);
+        cpuTimeLimit.rlim_max = std::min(cpuTimeLimit.rlim_max, currentLimit.rlim_max);
+    }
+    pid_t childPid{-1};
+    int spawnError{0};
+    if ((this->m_launchSettings.addressSpaceLimitMegabytes != 0) || (this->m_launchSettings.cpuTimeLimitSeconds != 0)) {
+        spawnError = forkWithLimits(childPid, programPath.c_str(), argumentPointers.data(), environmentPointers.data(), descriptors,
+                                    ((this->m_launchSettings.addressSpaceLimitMegabytes != 0) ? &addressSpaceLimit : nullptr),
+                                    ((this->m_launchSettings.cpuTimeLimitSeconds != 0) ? &cpuTimeLimit : nullptr), this->m_launchSettings.ownProcessGroup);
+    } else {
+        posix_spawnattr_t spawnAttributes;
+        posix_spawnattr_init(&spawnAttributes);
+        if (this->m_launchSettings.ownProcessGroup) {
+            posix_spawnattr_setflags(&spawnAttributes, POSIX_SPAWN_SETPGROUP);
+            posix_spawnattr_setpgroup(&spawnAttributes, 0);
+        }
+        spawnError = posix_spawn(&childPid, programPath.c_str(), &fileActions, &spawnAttributes, argumentPointers.data(), environmentPointers.data());
+        posix_spawnattr_destroy(&spawnAttributes);
+    }
+
+    if (personalityChanged) {
+        personality(static_cast<unsigned long>(previousPersonality));
+    }
+    if (cpusChanged) {
+        sched_setaffinity(0, sizeof(previousCpus), &previousCpus);
+    }
+    posix_spawn_file_actions_destroy(&fileActions);
+    if (spawnError != 0) {
+        errno = spawnError;
+        return -1;
+    }
+    return childPid;
+}
+
+int ProcessLauncher::waitForExit(pid_t childPid, struct rusage *resourceUsage)
+{
+    int status{0};
+    while (wait4(childPid, &status, 0, resourceUsage) < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    if (WIFEXITED(status)) {
+        return WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
+    }
+    return -1;
+}
+
+std::string ProcessLauncher::describe() const
+{
+    std::stringstream returnStream;
+    if (this->m_launchSettings.cpus.empty()) {
+        returnStream << "not pinned";
+    } else {
+        returnStream << "pinned to CPU" << ((this->m_launchSettings.cpus.size() == 1) ? " " : "s ");
+        for (size_t i = 0; i < this->m_launchSettings.cpus.size(); i++) {
+            returnStream << ((i == 0) ? "" : ",") << this->m_launchSettings.cpus[i];
+        }
+    }
+    returnStream << ", address randomization " << (this->m_launchSettings.disableAddressRandomization ? "off" : "on");
+    if (this->m_launchSettings.normalizeEnvironment) {
+        returnStream << ", environment padded to " << ENVIRONMENT_BLOCK_SIZE << " byte blocks";
+    }
+    if (this->m_launchSettings.addressSpaceLimitMegabytes != 0) {
+        returnStream << ", address space limited to " << this->m_launchSettings.addressSpaceLimitMegabytes << " MB";
+    }
+    if (this->m_launchSettings.cpuTimeLimitSeconds != 0) {
+        returnStream << ", CPU time limited to " << this->m_launchSettings.cpuTimeLimitSeconds << " s";
+    }
+    return returnStream.str();
+}
+
+bool ProcessLauncher::parseCpuList(const std::string &cpuList, std::vector<int> &cpus)
+{
+    std::vector<int> parsedCpus;
+    std::stringstream listStream{cpuList};
+    std::string range{""};
+    while (std::getline(listStream, range, ',')) {
+        size_t dashPosition{range.find('-')};
+        std::string first{range.substr(0, dashPosition)};
+        std::string last{(dashPosition == std::string::npos) ? first : range.substr(dashPosition + 1)};
+        //Bounded, so a long run of digits is rejected rather than thrown on
+        unsigned int firstCpu{0};
+        unsigned int lastCpu{0};
+        if ((!EasyGppUtilities::parseUnsignedInteger(first, firstCpu, CPU_SETSIZE - 1)) || (!EasyGppUtilities::parseUnsignedInteger(last, lastCpu, CPU_SETSIZE - 1)) || (firstCpu > lastCpu)) {
+            return false;
+        }
+        for (int i = static_cast<int>(firstCpu); i <= static_cast<int>(lastCpu); i++) {
+            parsedCpus.emplace_back(i);
+        }
+    }
+    if (parsedCpus.empty()) {
+        return false;
+    }
+    cpus = parsedCpus;
+    return true;
+}
+
+int ProcessLauncher::quietestCpu()
+{
+    cpu_set_t allowedCpus;
+    if (sched_getaffinity(0, sizeof(allowedCpus), &allowedCpus) != 0) {
+        return 0;
+    }
+    for (int i = CPU_SETSIZE - 1; i > 0; i--) {
+        if (CPU_ISSET(i, &allowedCpus)) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+std::vector<std::string> ProcessLauncher::governorWarnings(const std::vector<int> &cpus)
+{
+    std::vector<int> checkedCpus{cpus};
+    if (checkedCpus.empty()) {
+        for (int i = 0; i < sysconf(_SC_NPROCESSORS_ONLN); i++) {
+            checkedCpus.emplace_back(i);
+        }
+    }
+    std::vector<std::string> returnVector;
+    for (auto &it : checkedCpus) {
+        //Virtual machines and some kernels have no cpufreq at all, which
+        //leaves the frequency to the host and is not worth a warning
+        std::ifstream readFromFile{CPUFREQ_DIRECTORY + std::to_string(it) + "/cpufreq/scaling_governor"};
+        std::string governor{""};
+        if ((readFromFile.is_open()) && (std::getline(readFromFile, governor)) && (governor != PERFORMANCE_GOVERNOR)) {
+            returnVector.emplace_back("CPU " + std::to_string(it) + " uses the \"" + governor + "\" frequency governor, not \"" + PERFORMANCE_GOVERNOR + "\"");
+        }
+    }
+    return returnVector;
+}
@@ -0,0 +1,770 @@
+/***********************************************************************
+*    samplingprofiler.cpp:                                             *
+*    Runs a compiled program under a sampling profiler for EasyGpp     *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a SamplingProfiler class.   *
+*    This class runs a program while sampling its call stacks, either  *
+*    with perf_event_open (cpu-clock events, which also work inside    *
+*    virtual machines) or, where perf is not allowed, with a small     *
+*    SIGPROF sampler that is preloaded into the program. The samples   *
+*    are symbolized with addr2line against the program's debug         *
+*    information, and reported as a table of hotspots and as folded    *
+*    stacks for flame graphs                                           *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "samplingprofiler.h"
+#include "buildscheduler.h"
+#include "easygpputilities.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <elf.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+static const unsigned int PERF_DATA_PAGES{64};
+static const size_t ADDR2LINE_BATCH_SIZE{256};
+static const char *SAMPLER_OUTPUT_VARIABLE{"EASYGPP_SAMPLER_OUTPUT"};
+static const char *SAMPLER_FREQUENCY_VARIABLE{"EASYGPP_SAMPLER_FREQUENCY"};
+static const char *UNKNOWN_FRAME{"[unknown]"};
+
+//Preloaded into the program when perf_event_open is not allowed. Every
+//SIGPROF (sent by ITIMER_PROF, so only while the program uses CPU time)
+//records the interrupted instruction and, on the main thread, the return
+//addresses found by following the frame pointers. The samples and the
+//program's executable mappings are written out when the program exits
+static const char *SAMPLER_SOURCE{R"(#define _GNU_SOURCE
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#define SAMPLER_CAPACITY (16u * 1024u * 1024u)
+#define SAMPLER_MAX_DEPTH 128
+
+extern void *__libc_stack_end;
+static uint64_t *samplerBuffer;
+static size_t samplerUsed;
+static size_t samplerLost;
+static uintptr_t samplerStackEnd;
+static pid_t samplerPid;
+static char samplerOutput[4096];
+
+static void samplerHandler(int signalNumber, siginfo_t *signalInfo, void *context)
+{
+    ucontext_t *userContext = (ucontext_t *)context;
+    uint64_t frames[SAMPLER_MAX_DEPTH];
+    size_t depth = 0;
+    uintptr_t programCounter, stackPointer, framePointer;
+    int savedErrno = errno;
+    (void)signalNumber;
+    (void)signalInfo;
+#if defined(__x86_64__)
+    programCounter = (uintptr_t)userContext->uc_mcontext.gregs[REG_RIP];
+    stackPointer = (uintptr_t)userContext->uc_mcontext.gregs[REG_RSP];
+    framePointer = (uintptr_t)userContext->uc_mcontext.gregs[REG_RBP];
+#elif defined(__aarch64__)
+    programCounter = (uintptr_t)userContext->uc_mcontext.pc;
+    stackPointer = (uintptr_t)userContext->uc_mcontext.sp;
+    framePointer = (uintptr_t)userContext->uc_mcontext.regs[29];
+#else
+    errno = savedErrno;
+    return;
+#endif
+    frames[depth++] = programCounter;
+    if ((pid_t)syscall(SYS_gettid) == samplerPid) {
+        while ((depth < SAMPLER_MAX_DEPTH) && (framePointer >= stackPointer) && (framePointer + 2 * sizeof(uintptr_t) <= samplerStackEnd) && ((framePointer % sizeof(uintptr_t)) == 0)) {
+            uintptr_t *frameRecord = (uintptr_t *)framePointer;
+            if (frameRecord[1] == 0) {
+                break;
+            }
+            frames[depth++] = frameRecord[1];
+            if (frameRecord[0] <= framePointer) {
+                break;
+            }
+            stackPointer = framePointer;
+            framePointer = frameRecord[0];
+        }
+    }
+    size_t index = __atomic_fetch_add(&samplerUsed, depth + 1, __ATOMIC_RELAXED);
+    if (index + depth + 1 > SAMPLER_CAPACITY) {
+        __atomic_fetch_add(&samplerLost, 1, __ATOMIC_RELAXED);
+    } else {
+        samplerBuffer[index] = depth;
+        memcpy(&samplerBuffer[index + 1], frames, depth * sizeof(uint64_t));
+    }
+    errno = savedErrno;
+}
+
+__attribute__((constructor)) static void samplerStart(void)
+{
+    const char *outputPath = getenv("EASYGPP_SAMPLER_OUTPUT");
+    const char *frequencyString = getenv("EASYGPP_SAMPLER_FREQUENCY");
+    if ((outputPath == NULL) || (strlen(outputPath) >= sizeof(samplerOutput))) {
+        return;
+    }
+    strcpy(samplerOutput, outputPath);
+    /* Programs started by the profiled program keep the preload, but not the output */
+    unsetenv("EASYGPP_SAMPLER_OUTPUT");
+    long frequency = ((frequencyString != NULL) ? atol(frequencyString) : 0);
+    if (frequency <= 0) {
+        frequency = 999;
+    }
+    void *buffer = mmap(NULL, SAMPLER_CAPACITY * sizeof(uint64_t), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (buffer == MAP_FAILED) {
+        samplerOutput[0] = '\0';
+        return;
+    }
+    samplerBuffer = (uint64_t *)buffer;
+    samplerStackEnd = (uintptr_t)__libc_stack_end;
+    samplerPid = getpid();
+    struct sigaction signalAction;
+    memset(&signalAction, 0, sizeof(signalAction));
+    signalAction.sa_sigaction = samplerHandler;
+    signalAction.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&signalAction.sa_mask);
+    sigaction(SIGPROF, &signalAction, NULL);
+    struct itimerval timerValue;
+    timerValue.it_interval.tv_sec = 0;
+    timerValue.it_interval.tv_usec = ((1000000 / frequency) > 0) ? (1000000 / frequency) : 1;
+    timerValue.it_value = timerValue.it_interval;
+    setitimer(ITIMER_PROF, &timerValue, NULL);
+}
+
+__attribute__((destructor)) static void samplerStop(void)
+{
+    if (samplerOutput[0] == '\0') {
+        return;
+    }
+    struct itimerval timerValue;
+    memset(&timerValue, 0, sizeof(timerValue));
+    setitimer(ITIMER_PROF, &timerValue, NULL);
+    signal(SIGPROF, SIG_IGN);
+    FILE *outputFile = fopen(samplerOutput, "w");
+    if (outputFile == NULL) {
+        return;
+    }
+    fprintf(outputFile, "lost %zu\n", samplerLost);
+    FILE *mapsFile = fopen("/proc/self/maps", "r");
+    if (mapsFile != NULL) {
+        char mapsLine[4096 + 256];
+        while (fgets(mapsLine, sizeof(mapsLine), mapsFile) != NULL) {
+            fprintf(outputFile, "map %s", mapsLine);
+        }
+        fclose(mapsFile);
+    }
+    size_t used = ((samplerUsed > SAMPLER_CAPACITY) ? SAMPLER_CAPACITY : samplerUsed);
+    for (size_t index = 0; index < used; index += samplerBuffer[index] + 1) {
+        if ((samplerBuffer[index] == 0) || (index + samplerBuffer[index] + 1 > used)) {
+            break;
+        }
+        fprintf(outputFile, "sample");
+        for (size_t frame = 1; frame <= samplerBuffer[index]; frame++) {
+            fprintf(outputFile, " %llx", (unsigned long long)samplerBuffer[index + frame]);
+        }
+        fprintf(outputFile, "\n");
+    }
+    fclose(outputFile);
+}
+)"};
+
+namespace {
+    bool startsWith(const std::string &stringToCheck, const std::string &prefix)
+    {
+        return (stringToCheck.compare(0, prefix.length(), prefix) == 0);
+    }
+
+    std::vector<char *> argumentVector(const std::string &programPath, const std::vector<std::string> &arguments)
+    {
+        std::vector<char *> returnVector;
+        returnVector.emplace_back(const_cast<char *>(programPath.c_str()));
+        for (auto &it : arguments) {
+            returnVector.emplace_back(const_cast<char *>(it.c_str()));
+        }
+        returnVector.emplace_back(nullptr);
+        return returnVector;
+    }
+
+    int returnValueFromStatus(int status)
+    {
+        if (WIFEXITED(status)) {
+            return WEXITSTATUS(status);
+        } else if (WIFSIGNALED(status)) {
+            return 128 + WTERMSIG(status);
+        }
+        return -1;
+    }
+
+    int waitForChild(pid_t childPid)
+    {
+        int status{0};
+        while (waitpid(childPid, &status, 0) < 0) {
+            if (errno != EINTR) {
+                return -1;
+            }
+        }
+        return returnValueFromStatus(status);
+    }
+}
+
+SamplingProfiler::SamplingProfiler(const std::string &programPath, const std::vector<std::string> &arguments, unsigned int frequency) :
+    m_programPath{programPath},
+    m_arguments{arguments},
+    m_frequency{(frequency == 0) ? 1 : frequency},
+    m_returnValue{-1},
+    m_method{""},
+    m_lostSamples{0}
+{
+
+}
+
+int SamplingProfiler::returnValue() const
+{
+    return this->m_returnValue;
+}
+
+std::string SamplingProfiler::method() const
+{
+    return this->m_method;
+}
+
+size_t SamplingProfiler::sampleCount() const
+{
+    return this->m_stacks.size();
+}
+
+bool SamplingProfiler::run(const std::string &samplerDirectory, const std::string &compilerCommand)
+{
+    this->m_stacks.clear();
+    this->m_regions.clear();
+    this->m_frames.clear();
+    this->m_lostSamples = 0;
+    if (this->runWithPerfEvents()) {
+        this->m_method = "perf_event_open";
+    } else if (this->runWithPreloadedSampler(samplerDirectory, compilerCommand)) {
+        this->m_method = "SIGPROF sampler";
+    } else {
+        return false;
+    }
+    this->symbolize();
+    return true;
+}
+
+bool SamplingProfiler::runWithPerfEvents()
+{
+    //The child waits on a pipe until every event is open, so nothing it
+    //does after exec() is missed. enable_on_exec keeps easyg++'s own fork
+    //and the wait out of the samples
+    int startPipe[2];
+    if (pipe2(startPipe, O_CLOEXEC) != 0) {
+        return false;
+    }
+    std::vector<char *> argumentPointers{argumentVector(this->m_programPath, this->m_arguments)};
+    pid_t childPid{fork()};
+    if (childPid < 0) {
+        close(startPipe[0]);
+        close(startPipe[1]);
+        return false;
+    } else if (childPid == 0) {
+        close(startPipe[1]);
+        char startByte{0};
+        ssize_t bytesRead{-1};
+        do {
+            bytesRead = read(startPipe[0], &startByte, 1);
+        } while ((bytesRead < 0) && (errno == EINTR));
+        if (bytesRead != 1) {
+            _exit(127);
+        }
+        execv(this->m_programPath.c_str(), argumentPointers.data());
+        _exit(127);
+    }
+    close(startPipe[0]);
+
+    struct perf_event_attr eventAttributes;
+    memset(&eventAttributes, 0, sizeof(eventAttributes));
+    eventAttributes.size = sizeof(eventAttributes);
+    eventAttributes.type = PERF_TYPE_SOFTWARE;
+    eventAttributes.config = PERF_COUNT_SW_CPU_CLOCK;
+    eventAttributes.sample_freq = this->m_frequency;
+    eventAttributes.freq = 1;
+    eventAttributes.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_TID | PERF_SAMPLE_CALLCHAIN;
+    eventAttributes.disabled = 1;
+    eventAttributes.enable_on_exec = 1;
+    eventAttributes.inherit = 1;
+    eventAttributes.mmap = 1;
+    eventAttributes.exclude_kernel = 1;
+    eventAttributes.exclude_hv = 1;
+    eventAttributes.exclude_callchain_kernel = 1;
+    eventAttributes.watermark = 1;
+    eventAttributes.wakeup_watermark = (PERF_DATA_PAGES / 2) * static_cast<unsigned int>(sysconf(_SC_PAGESIZE));
+
+    //Inherited events can only be mapped one CPU at a time, so threads the
+    //program starts are followed by opening one event on every CPU
+    size_t pageSize{static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+    size_t mappingSize{(PERF_DATA_PAGES + 1) * pageSize};
+    long processorCount{sysconf(_SC_NPROCESSORS_CONF)};
+    std::vector<int> eventDescriptors;
+    std::vector<void *> eventMappings;
+    bool mappingFailed{false};
+    for (long cpu = 0; cpu < processorCount; cpu++) {
+        int eventDescriptor{static_cast<int>(syscall(SYS_perf_event_open, &eventAttributes, childPid, static_cast<int>(cpu), -1, PERF_FLAG_FD_CLOEXEC))};
+        if (eventDescriptor < 0) {
+            continue;
+        }
+        void *eventMapping{mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, eventDescriptor, 0)};
+        if (eventMapping == MAP_FAILED) {
+            close(eventDescriptor);
+            mappingFailed = true;
+            break;
+        }
+        eventDescriptors.emplace_back(eventDescriptor);
+        eventMappings.emplace_back(eventMapping);
+    }
+    if ((eventDescriptors.empty()) || (mappingFailed)) {
+        for (size_t i = 0; i < eventDescriptors.size(); i++) {
+            munmap(eventMappings[i], mappingSize);
+            close(eventDescriptors[i]);
+        }
+        //Closing the pipe without writing makes the child exit without running
+        close(startPipe[1]);
+        waitForChild(childPid);
+        return false;
+    }
+
+    auto drainEvents = [&](void *eventMapping) {
+        struct perf_event_mmap_page *metadataPage{static_cast<struct perf_event_mmap_page *>(eventMapping)};
+        const unsigned char *dataPages{static_cast<const unsigned char *>(eventMapping) + pageSize};
+        uint64_t dataMask{PERF_DATA_PAGES * pageSize - 1};
+        uint64_t dataHead{__atomic_load_n(&metadataPage->data_head, __ATOMIC_ACQUIRE)};
+        uint64_t dataTail{metadataPage->data_tail};
+        std::vector<unsigned char> record;
+        while (dataTail + sizeof(struct perf_event_header) <= dataHead) {
+            //Records can wrap around the end of the ring buffer
+            struct perf_event_header eventHeader;
+            for (size_t i = 0; i < sizeof(eventHeader); i++) {
+                reinterpret_cast<unsigned char *>(&eventHeader)[i] = dataPages[(dataTail + i) & dataMask];
+            }
+            if ((eventHeader.size < sizeof(eventHeader)) || (dataTail + eventHeader.size > dataHead)) {
+                break;
+            }
+            record.resize(eventHeader.size);
+            for (size_t i = 0; i < eventHeader.size; i++) {
+                record[i] = dataPages[(dataTail + i) & dataMask];
+            }
+            dataTail += eventHeader.size;
+            uint32_t recordPid{0};
+            if (record.size() >= 16) {
+                memcpy(&recordPid, &record[8], sizeof(recordPid));
+            }
+            if ((eventHeader.type == PERF_RECORD_SAMPLE) && (record.size() >= 32)) {
+                //ip, pid/tid, then the callchain (only threads of the program itself are kept)
+                uint32_t samplePid{0};
+                uint64_t instructionPointer{0};
+                uint64_t chainLength{0};
+                memcpy(&instructionPointer, &record[8], sizeof(instructionPointer));
+                memcpy(&samplePid, &record[16], sizeof(samplePid));
+                memcpy(&chainLength, &record[24], sizeof(chainLength));
+                if (samplePid != static_cast<uint32_t>(childPid)) {
+                    continue;
+                }
+                std::vector<uint64_t> stack;
+                for (uint64_t i = 0; (i < chainLength) && (32 + (i + 1) * 8 <= record.size()); i++) {
+                    uint64_t chainAddress{0};
+                    memcpy(&chainAddress, &record[32 + i * 8], sizeof(chainAddress));
+                    if (chainAddress >= static_cast<uint64_t>(PERF_CONTEXT_MAX)) {
+                        continue;
+                    }
+                    stack.emplace_back(stack.empty() ? chainAddress : (chainAddress - 1));
+                }
+                if (stack.empty()) {
+                    stack.emplace_back(instructionPointer);
+                }
+                this->m_stacks.emplace_back(std::move(stack));
+            } else if ((eventHeader.type == PERF_RECORD_MMAP) && (record.size() > 40) && (recordPid == static_cast<uint32_t>(childPid))) {
+                MappedRegion mappedRegion{0, 0, 0, ""};
+                uint64_t regionLength{0};
+                memcpy(&mappedRegion.start, &record[16], sizeof(mappedRegion.start));
+                memcpy(&regionLength, &record[24], sizeof(regionLength));
+                memcpy(&mappedRegion.offset, &record[32], sizeof(mappedRegion.offset));
+                mappedRegion.end = mappedRegion.start + regionLength;
+                mappedRegion.path = std::string{reinterpret_cast<const char *>(&record[40]), strnlen(reinterpret_cast<const char *>(&record[40]), record.size() - 40)};
+                this->m_regions.emplace_back(mappedRegion);
+            } else if ((eventHeader.type == PERF_RECORD_LOST) && (record.size() >= 24)) {
+                uint64_t lostCount{0};
+                memcpy(&lostCount, &record[16], sizeof(lostCount));
+                this->m_lostSamples += static_cast<size_t>(lostCount);
+            }
+        }
+        __atomic_store_n(&metadataPage->data_tail, dataTail, __ATOMIC_RELEASE);
+    };
+
+    char startByte{1};
+    bool childStarted{write(startPipe[1], &startByte, 1) == 1};
+    close(startPipe[1]);
+    std::vector<struct pollfd> pollDescriptors;
+    for (auto &it : eventDescriptors) {
+        pollDescriptors.emplace_back(pollfd{it, POLLIN, 0});
+    }
+    bool childRunning{childStarted};
+    while (childRunning) {
+        poll(pollDescriptors.data(), pollDescriptors.size(), 100);
+        for (auto &it : eventMappings) {
+            drainEvents(it);
+        }
+        int status{0};
+        pid_t waitedPid{waitpid(childPid, &status, WNOHANG)};
+        if (waitedPid == childPid) {
+            this->m_returnValue = returnValueFromStatus(status);
+            childRunning = false;
+        } else if ((waitedPid < 0) && (errno != EINTR)) {
+            childRunning = false;
+        }
+    }
+    if (!childStarted) {
+        this->m_returnValue = waitForChild(childPid);
+    }
+    for (size_t i = 0; i < eventDescriptors.size(); i++) {
+        drainEvents(eventMappings[i]);
+        munmap(eventMappings[i], mappingSize);
+        close(eventDescriptors[i]);
+    }
+    return childStarted;
+}
+
+bool SamplingProfiler::runWithPreloadedSampler(const std::string &samplerDirectory, const std::string &compilerCommand)
+{
+    using namespace EasyGppUtilities;
+    //Named after a hash of its source, so a changed sampler is rebuilt
+    std::string samplerLibrary{samplerDirectory + "/easygpp-sampler-" + toHexString(fnv1a64(SAMPLER_SOURCE)) + ".so"};
+    if (access(samplerLibrary.c_str(), R_OK) != 0) {
+        if (!makeDirectoryPath(samplerDirectory)) {
+            return false;
+        }
+        std::string samplerSource{samplerDirectory + "/easygpp-sampler.c"};
+        std::ofstream writeToFile{samplerSource};
+        writeToFile << SAMPLER_SOURCE;
+        writeToFile.close();
+        //Built beside the final name and renamed, like a precompiled header
+        std::string temporaryPath{samplerLibrary + "." + std::to_string(getpid()) + ".tmp"};
+        BuildResult buildResult{BuildScheduler::runCommand(compilerCommand + " -x c -O2 -fPIC -shared -o \"" + temporaryPath + "\" \"" + samplerSource + "\"")};
+        if ((buildResult.returnValue != 0) || (std::rename(temporaryPath.c_str(), samplerLibrary.c_str()) != 0)) {
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+
+    std::string outputPath{samplerDirectory + "/samples-" + std::to_string(getpid())};
+    std::remove(outputPath.c_str());
+    std::vector<std::string> environment;
+    std::string preloadList{samplerLibrary};
+    for (char **it = environ; *it != nullptr; it++) {
+        std::string variable{*it};
+        if (startsWith(variable, "LD_PRELOAD=")) {
+            preloadList += (" " + variable.substr(std::strlen("LD_PRELOAD=")));
+        } else if ((!startsWith(variable, static_cast<std::string>(SAMPLER_OUTPUT_VARIABLE) + "=")) && (!startsWith(variable, static_cast<std::string>(SAMPLER_FREQUENCY_VARIABLE) + "="))) {
+            environment.emplace_back(variable);
+        }
+    }
+    environment.emplace_back("LD_PRELOAD=" + preloadList);
+    environment.emplace_back(static_cast<std::string>(SAMPLER_OUTPUT_VARIABLE) + "=" + outputPath);
+    environment.emplace_back(static_cast<std::string>(SAMPLER_FREQUENCY_VARIABLE) + "=" + std::to_string(this->m_frequency));
+    std::vector<char *> environmentPointers;
+    for (auto &it : environment) {
+        environmentPointers.emplace_back(const_cast<char *>(it.c_str()));
+    }
+    environmentPointers.emplace_back(nullptr);
+    std::vector<char *> argumentPointers{argumentVector(this->m_programPath, this->m_arguments)};
+    pid_t childPid{fork()};
+    if (childPid < 0) {
+        return false;
+    } else if (childPid == 0) {
+        execve(this->m_programPath.c_str(), argumentPointers.data(), environmentPointers.data());
+        _exit(127);
+    }
+    this->m_returnValue = waitForChild(childPid);
+    //A program that ends with _exit(), or is killed, never writes its samples
+    bool outputRead{this->readSamplerOutput(outputPath)};
+    std::remove(outputPath.c_str());
+    return (outputRead || (this->m_returnValue != -1));
+}
+
+bool SamplingProfiler::readSamplerOutput(const std::string &outputPath)
+{
+    std::ifstream readFromFile{outputPath};
+    if (!readFromFile.is_open()) {
+        return false;
+    }
+    std::string line{""};
+    while (std::getline(readFromFile, line)) {
+        if (startsWith(line, "sample ")) {
+            std::stringstream sampleStream{line.substr(std::strlen("sample "))};
+            std::vector<uint64_t> stack;
+            uint64_t address{0};
+            while (sampleStream >> std::hex >> address) {
+                stack.emplace_back(stack.empty() ? address : (address - 1));
+            }
+            if (!stack.empty()) {
+                this->m_stacks.emplace_back(std::move(stack));
+            }
+        } else if (startsWith(line, "map ")) {
+            //start-end perms offset device inode path, as in /proc/self/maps
+            unsigned long long start{0};
+            unsigned long long end{0};
+            unsigned long long offset{0};
+            char permissions[8]{};
+            int pathPosition{0};
+            if ((std::sscanf(line.c_str() + std::strlen("map "), "%llx-%llx %7s %llx %*s %*s %n", &start, &end, permissions, &offset, &pathPosition) < 4) || (permissions[2] != 'x') || (pathPosition == 0)) {
+                continue;
+            }
+            std::string regionPath{line.substr(std::strlen("map ") + static_cast<size_t>(pathPosition))};
+            if (regionPath.empty()) {
+                continue;
+            }
+            this->m_regions.emplace_back(MappedRegion{start, end, offset, regionPath});
+        } else if (startsWith(line, "lost ")) {
+            this->m_lostSamples += std::stoul(line.substr(std::strlen("lost ")));
+        }
+    }
+    return true;
+}
+
+const SamplingProfiler::MappedRegion *SamplingProfiler::regionFor(uint64_t address) const
+{
+    //Later mappings replace earlier ones over the same addresses
+    for (auto it = this->m_regions.rbegin(); it != this->m_regions.rend(); it++) {
+        if ((address >= it->start) && (address < it->end)) {
+            return &(*it);
+        }
+    }
+    return nullptr;
+}
+
+bool SamplingProfiler::readLoadSegments(const std::string &elfPath, std::vector<LoadSegment> &loadSegments)
+{
+    loadSegments.clear();
+    std::ifstream readFromFile{elfPath, std::ios::binary};
+    Elf64_Ehdr elfHeader;
+    if ((!readFromFile.read(reinterpret_cast<char *>(&elfHeader), sizeof(elfHeader))) || (std::memcmp(elfHeader.e_ident, ELFMAG, SELFMAG) != 0) || (elfHeader.e_ident[EI_CLASS] != ELFCLASS64)) {
+        return false;
+    }
+    for (uint16_t i = 0; i < elfHeader.e_phnum; i++) {
+        Elf64_Phdr programHeader;
+        readFromFile.seekg(static_cast<std::streamoff>(elfHeader.e_phoff + i * elfHeader.e_phentsize));
+        if (!readFromFile.read(reinterpret_cast<char *>(&programHeader), sizeof(programHeader))) {
+            return false;
+        }
+        if (programHeader.p_type == PT_LOAD) {
+            loadSegments.emplace_back(LoadSegment{programHeader.p_offset, programHeader.p_filesz, programHeader.p_vaddr});
+        }
+    }
+    return !loadSegments.empty();
+}
+
+void SamplingProfiler::symbolize()
+{
+    //addr2line wants addresses as the linker laid them out, so each sampled
+    //address goes through the file offset it was mapped from, which works
+    //the same for position independent executables and shared libraries
+    std::map<std::string, std::map<uint64_t, std::vector<uint64_t>>> addressesByFile;
+    std::map<std::string, std::vector<LoadSegment>> segmentsByFile;
+    for (auto &stackIt : this->m_stacks) {
+        for (auto &it : stackIt) {
+            if (this->m_frames.find(it) != this->m_frames.end()) {
+                continue;
+            }
+            const MappedRegion *mappedRegion{this->regionFor(it)};
+            if (!mappedRegion) {
+                this->m_frames.emplace(it, Frame{UNKNOWN_FRAME, ""});
+                continue;
+            }
+            std::string libraryName{"[" + mappedRegion->path.substr(mappedRegion->path.find_last_of('/') + 1) + "]"};
+            this->m_frames.emplace(it, Frame{libraryName, ""});
+            auto foundSegments = segmentsByFile.find(mappedRegion->path);
+            if (foundSegments == segmentsByFile.end()) {
+                std::vector<LoadSegment> loadSegments;
+                readLoadSegments(mappedRegion->path, loadSegments);
+                foundSegments = segmentsByFile.emplace(mappedRegion->path, loadSegments).first;
+            }
+            uint64_t fileOffset{it - mappedRegion->start + mappedRegion->offset};
+            for (auto &segmentIt : foundSegments->second) {
+                if ((fileOffset >= segmentIt.fileOffset) && (fileOffset < segmentIt.fileOffset + segmentIt.fileSize)) {
+                    addressesByFile[mappedRegion->path][fileOffset - segmentIt.fileOffset + segmentIt.virtualAddress].emplace_back(it);
+                    break;
+                }
+            }
+        }
+    }
+
+    char workingDirectory[4096];
+    std::string currentDirectory{(getcwd(workingDirectory, sizeof(workingDirectory)) != nullptr) ? (static_cast<std::string>(workingDirectory) + "/") : ""};
+    for (auto &fileIt : addressesByFile) {
+        std::vector<uint64_t> fileAddresses;
+        for (auto &it : fileIt.second) {
+            fileAddresses.emplace_back(it.first);
+        }
+        for (size_t batchStart = 0; batchStart < fileAddresses.size(); batchStart += ADDR2LINE_BATCH_SIZE) {
+            size_t batchEnd{std::min(batchStart + ADDR2LINE_BATCH_SIZE, fileAddresses.size())};
+            std::stringstream addr2lineCommand;
+            addr2lineCommand << "addr2line -f -C -e \"" << fileIt.first << "\"" << std::hex;
+            for (size_t i = batchStart; i < batchEnd; i++) {
+                addr2lineCommand << " 0x" << fileAddresses[i];
+            }
+            addr2lineCommand << " 2>/dev/null";
+            BuildResult addr2lineResult{BuildScheduler::runCommand(addr2lineCommand.str())};
+            if (addr2lineResult.returnValue != 0) {
+                continue;
+            }
+            //Two lines for every address: the function, then file:line
+            std::stringstream outputStream{addr2lineResult.output};
+            std::string functionName{""};
+            std::string location{""};
+            for (size_t i = batchStart; (i < batchEnd) && (std::getline(outputStream, functionName)) && (std::getline(outputStream, location)); i++) {
+                size_t discriminatorPosition{location.find(" (discriminator")};
+                if (discriminatorPosition != std::string::npos) {
+                    location.erase(discriminatorPosition);
+                }
+                if ((currentDirectory != "") && (startsWith(location, currentDirectory))) {
+                    location.erase(0, currentDirectory.length());
+                }
+                if (startsWith(location, "??")) {
+                    location = "";
+                }
+                for (auto &it : fileIt.second[fileAddresses[i]]) {
+                    Frame &frame = this->m_frames[it];
+                    if (functionName != "??") {
+                        frame.function = functionName;
+                    }
+                    frame.location = location;
+                }
+            }
+        }
+    }
+}
+
+SamplingProfiler::Frame SamplingProfiler::frameFor(uint64_t address) const
+{
+    auto foundFrame = this->m_frames.find(address);
+    if (foundFrame == this->m_frames.end()) {
+        return Frame{UNKNOWN_FRAME, ""};
+    }
+    return foundFrame->second;
+}
+
+std::string SamplingProfiler::report(size_t topCount) const
+{
+    std::stringstream returnStream;
+    returnStream << "Sampling profile of " << this->m_programPath << " (" << this->m_stacks.size() << ((this->m_stacks.size() == 1) ? " sample" : " samples")
+                 << " at " << this->m_frequency << " Hz, using " << this->m_method << "):" << std::endl;
+    if (this->m_stacks.empty()) {
+        returnStream << "    No samples were taken, the program may have run too briefly (or ended with _exit())" << std::endl;
+        return returnStream.str();
+    }
+    //Self counts the sampled function, total counts every function on the
+    //stack once (so recursion is not counted twice)
+    std::map<std::string, size_t> selfCounts;
+    std::map<std::string, size_t> totalCounts;
+    std::map<std::string, std::map<std::string, size_t>> lineCounts;
+    for (auto &stackIt : this->m_stacks) {
+        Frame sampledFrame{this->frameFor(stackIt.front())};
+        selfCounts[sampledFrame.function]++;
+        if (sampledFrame.location != "") {
+            lineCounts[sampledFrame.function][sampledFrame.location]++;
+        }
+        std::set<std::string> stackFunctions;
+        for (auto &it : stackIt) {
+            stackFunctions.emplace(this->frameFor(it).function);
+        }
+        for (auto &it : stackFunctions) {
+            totalCounts[it]++;
+        }
+    }
+    std::vector<std::pair<std::string, size_t>> hotspots{selfCounts.begin(), selfCounts.end()};
+    std::stable_sort(hotspots.begin(), hotspots.end(), [](const std::pair<std::string, size_t> &lhs, const std::pair<std::string, size_t> &rhs) {
+        return (lhs.second > rhs.second);
+    });
+    double sampleTotal{static_cast<double>(this->m_stacks.size())};
+    returnStream << std::fixed << std::setprecision(1);
+    returnStream << "    " << std::setw(8) << "self" << std::setw(8) << "total" << std::setw(10) << "samples" << "  " << std::left << std::setw(40) << "function" << "hottest line" << std::right << std::endl;
+    for (size_t i = 0; (i < hotspots.size()) && (i < topCount); i++) {
+        std::string hottestLine{""};
+        size_t hottestCount{0};
+        for (auto &it : lineCounts[hotspots[i].first]) {
+            if (it.second > hottestCount) {
+                hottestLine = it.first;
+                hottestCount = it.second;
+            }
+        }
+        std::stringstream selfPercent;
+        std::stringstream totalPercent;
+        selfPercent << std::fixed << std::setprecision(1) << 100.0 * static_cast<double>(hotspots[i].second) / sampleTotal << "%";
+        totalPercent << std::fixed << std::setprecision(1) << 100.0 * static_cast<double>(totalCounts[hotspots[i].first]) / sampleTotal << "%";
+        std::string functionName{hotspots[i].first};
+        if (functionName.length() > 38) {
+            functionName = functionName.substr(0, 35) + "...";
+        }
+        returnStream << "    " << std::setw(8) << selfPercent.str() << std::setw(8) << totalPercent.str() << std::setw(10) << hotspots[i].second << "  "
+                     << std::left << std::setw(40) << functionName << hottestLine << std::right << std::endl;
+    }
+    if (hotspots.size() > topCount) {
+        returnStream << "    (" << hotspots.size() - topCount << " more functions not shown)" << std::endl;
+    }
+    if (this->m_lostSamples != 0) {
+        returnStream << std::endl << "    WARNING: " << this->m_lostSamples << " samples were lost, a lower frequency would keep them" << std::endl;
+    }
+    return returnStream.str();
+}
+
+bool SamplingProfiler::writeFoldedStacks(const std::string &filePath) const
+{
+    //One line per distinct stack, outermost function first, as read by
+    //flamegraph.pl and speedscope
+    std::map<std::string, size_t> foldedStacks;
+    for (auto &stackIt : this->m_stacks) {
+        std::string foldedStack{""};
+        for (auto it = stackIt.rbegin(); it != stackIt.rend(); it++) {
+            std::string functionName{this->frameFor(*it).function};
+            std::replace(functionName.begin(), functionName.end(), ';', ':');
+            foldedStack += (((foldedStack == "") ? "" : ";") + functionName);
+        }
+        foldedStacks[foldedStack]++;
+    }
+    std::ofstream writeToFile{filePath};
+    if (!writeToFile.is_open()) {
+        return false;
+    }
+    for (auto &it : foldedStacks) {
+        writeToFile << it.first << " " << it.second << std::endl;
+    }
+    return writeToFile.good();
+}
@@ -0,0 +1,304 @@
+/***********************************************************************
+*    testrunner.cpp:                                                   *
+*    Runs a compiled program against input/expected output files       *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a TestRunner class. This    *
+*    class finds the NAME.in/NAME.out pairs in a directory, runs the   *
+*    program once per pair with NAME.in as its standard input, and     *
+*    compares what it prints with NAME.out as it is printed, with a    *
+*    time limit on each run                                            *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "testrunner.h"
+#include "easygpputilities.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+static const char *INPUT_EXTENSION{".in"};
+static const char *EXPECTED_OUTPUT_EXTENSION{".out"};
+static const size_t READ_BUFFER_SIZE{65536};
+//How long the output is still read after the time limit kills the program
+static const int KILL_GRACE_MILLISECONDS{1000};
+//Longer lines are still compared in full, but shown cut short
+static const size_t SHOWN_LINE_LENGTH{60};
+static const char *END_OF_OUTPUT{"<end of output>"};
+static const char *END_OF_FILE{"<end of file>"};
+
+//Compares the program's output with the expected output a line at a time,
+//as it arrives, so neither is ever held in memory (or on disk) as a whole
+class OutputComparator
+{
+public:
+    explicit OutputComparator(const std::string &expectedOutputPath) :
+        m_expectedOutput{expectedOutputPath},
+        m_partialLine{""},
+        m_lineNumber{0},
+        m_differingLine{0},
+        m_expectedLine{""},
+        m_actualLine{""}
+    {
+
+    }
+
+    bool isOpen() const
+    {
+        return this->m_expectedOutput.is_open();
+    }
+
+    void addOutput(const char *data, size_t length)
+    {
+        size_t lineStart{0};
+        for (size_t i = 0; i < length; i++) {
+            if (data[i] == '\n') {
+                this->m_partialLine.append(data + lineStart, i - lineStart);
+                this->compareLine(this->m_partialLine);
+                this->m_partialLine.clear();
+                lineStart = i + 1;
+            }
+        }
+        this->m_partialLine.append(data + lineStart, length - lineStart);
+    }
+
+    //Once the output has ended, whatever is left of the expected output has
+    //to be blank
+    void finish()
+    {
+        if (!this->m_partialLine.empty()) {
+            this->compareLine(this->m_partialLine);
+            this->m_partialLine.clear();
+        }
+        std::string expectedLine{""};
+        while ((this->m_differingLine == 0) && (std::getline(this->m_expectedOutput, expectedLine))) {
+            this->m_lineNumber++;
+            if (!trimmed(expectedLine).empty()) {
+                this->recordDifference(expectedLine, END_OF_OUTPUT);
+            }
+        }
+    }
+
+    size_t differingLine() const { return this->m_differingLine; }
+    std::string expectedLine() const { return this->m_expectedLine; }
+    std::string actualLine() const { return this->m_actualLine; }
+
+private:
+    std::ifstream m_expectedOutput;
+    std::string m_partialLine;
+    size_t m_lineNumber;
+    size_t m_differingLine;
+    std::string m_expectedLine;
+    std::string m_actualLine;
+
+    void compareLine(const std::string &actualLine)
+    {
+        this->m_lineNumber++;
+        if (this->m_differingLine != 0) {
+            return;
+        }
+        std::string expectedLine{""};
+        if (!std::getline(this->m_expectedOutput, expectedLine)) {
+            if (!trimmed(actualLine).empty()) {
+                this->recordDifference(END_OF_FILE, actualLine);
+            }
+        } else if (trimmed(expectedLine) != trimmed(actualLine)) {
+            this->recordDifference(expectedLine, actualLine);
+        }
+    }
+
+    void recordDifference(const std::string &expectedLine, const std::string &actualLine)
+    {
+        this->m_differingLine = this->m_lineNumber;
+        this->m_expectedLine = trimmed(expectedLine);
+        this->m_actualLine = trimmed(actualLine);
+    }
+
+    static std::string trimmed(const std::string &line)
+    {
+        size_t lineEnd{line.find_last_not_of(" \t\r")};
+        return ((lineEnd == std::string::npos) ? "" : line.substr(0, lineEnd + 1));
+    }
+};
+
+TestRunner::TestRunner(const std::string &programPath, const std::vector<std::string> &arguments, const LaunchSettings &launchSettings, unsigned int timeoutSeconds) :
+    m_programPath{programPath},
+    m_arguments{arguments},
+    m_processLauncher{LaunchSettings{launchSettings.cpus, launchSettings.disableAddressRandomization, launchSettings.normalizeEnvironment,
+                                     launchSettings.addressSpaceLimitMegabytes, launchSettings.cpuTimeLimitSeconds, true}},
+    m_timeoutSeconds{timeoutSeconds}
+{
+
+}
+
+std::vector<TestCase> TestRunner::findTestCases(const std::string &directoryPath, std::vector<std::string> &unpairedInputs)
+{
+    std::vector<TestCase> returnVector;
+    std::vector<std::string> inputFiles{EasyGppUtilities::filesWithExtension(directoryPath, INPUT_EXTENSION)};
+    std::sort(inputFiles.begin(), inputFiles.end());
+    for (auto &it : inputFiles) {
+        std::string expectedOutputPath{it.substr(0, it.length() - std::strlen(INPUT_EXTENSION)) + EXPECTED_OUTPUT_EXTENSION};
+        if (access(expectedOutputPath.c_str(), R_OK) == 0) {
+            returnVector.emplace_back(TestCase{EasyGppUtilities::stripExtension(EasyGppUtilities::fileBaseName(it)), it, expectedOutputPath});
+        } else {
+            unpairedInputs.emplace_back(it);
+        }
+    }
+    return returnVector;
+}
+
+TestResult TestRunner::run(const TestCase &testCase) const
+{
+    TestResult testResult{false, false, -1, 0.0, 0, 0, "", "", ""};
+    OutputComparator outputComparator{testCase.expectedOutputPath};
+    if (!outputComparator.isOpen()) {
+        testResult.error = "unable to open " + testCase.expectedOutputPath;
+        return testResult;
+    }
+    //The input file itself is the program's standard input, so nothing is
+    //copied on the way in. Everything is close-on-exec, since other cases
+    //are being started from other threads at the same time, and a write end
+    //leaked into one of them would keep this case's output from ending
+    int inputDescriptor{open(testCase.inputPath.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (inputDescriptor < 0) {
+        testResult.error = "unable to open " + testCase.inputPath + ": " + std::strerror(errno);
+        return testResult;
+    }
+    int outputPipe[2]{-1, -1};
+    int nullDevice{open("/dev/null", O_WRONLY | O_CLOEXEC)};
+    if (pipe2(outputPipe, O_CLOEXEC) != 0) {
+        testResult.error = static_cast<std::string>("unable to create a pipe: ") + std::strerror(errno);
+        close(inputDescriptor);
+        if (nullDevice >= 0) {
+            close(nullDevice);
+        }
+        return testResult;
+    }
+    auto startTime = std::chrono::steady_clock::now();
+    pid_t childPid{this->m_processLauncher.spawn(this->m_programPath, this->m_arguments, inputDescriptor, outputPipe[1], nullDevice)};
+    int spawnError{errno};
+    close(inputDescriptor);
+    close(outputPipe[1]);
+    if (nullDevice >= 0) {
+        close(nullDevice);
+    }
+    if (childPid < 0) {
+        testResult.error = "unable to start " + this->m_programPath + ": " + std::strerror(spawnError);
+        close(outputPipe[0]);
+        return testResult;
+    }
+
+    auto deadline = startTime + std::chrono::seconds(this->m_timeoutSeconds);
+    std::vector<char> readBuffer(READ_BUFFER_SIZE);
+    while (true) {
+        int timeoutMilliseconds{-1};
+        if ((this->m_timeoutSeconds != 0) || (testResult.timedOut)) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            timeoutMilliseconds = static_cast<int>(std::max<decltype(remaining)>(remaining, 0));
+        }
+        struct pollfd outputPoll{outputPipe[0], POLLIN, 0};
+        int pollResult{poll(&outputPoll, 1, timeoutMilliseconds)};
+        if ((pollResult < 0) && (errno == EINTR)) {
+            continue;
+        } else if ((pollResult == 0) && (testResult.timedOut)) {
+            //Something outside the process group (eg a daemon the program
+            //started) still holds the pipe open, so the rest is not waited for
+            break;
+        } else if (pollResult == 0) {
+            //The whole process group is killed, so anything the program
+            //started lets go of the pipe too, and what is already in the
+            //pipe is still read, for a little while
+            testResult.timedOut = true;
+            kill(-childPid, SIGKILL);
+            deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(KILL_GRACE_MILLISECONDS);
+            continue;
+        } else if (pollResult < 0) {
+            break;
+        }
+        ssize_t bytesRead{read(outputPipe[0], readBuffer.data(), readBuffer.size())};
+        if ((bytesRead < 0) && (errno == EINTR)) {
+            continue;
+        } else if (bytesRead <= 0) {
+            break;
+        }
+        outputComparator.addOutput(readBuffer.data(), static_cast<size_t>(bytesRead));
+    }
+    close(outputPipe[0]);
+    struct rusage resourceUsage;
+    testResult.returnValue = ProcessLauncher::waitForExit(childPid, &resourceUsage);
+    testResult.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    testResult.peakMemoryKilobytes = resourceUsage.ru_maxrss;
+    outputComparator.finish();
+    testResult.differingLine = outputComparator.differingLine();
+    testResult.expectedLine = outputComparator.expectedLine();
+    testResult.actualLine = outputComparator.actualLine();
+    testResult.passed = ((!testResult.timedOut) && (testResult.returnValue == 0) && (testResult.differingLine == 0));
+    return testResult;
+}
+
+static std::string shownLine(const std::string &line)
+{
+    if ((line == END_OF_OUTPUT) || (line == END_OF_FILE)) {
+        return line;
+    }
+    return "\"" + ((line.length() > SHOWN_LINE_LENGTH) ? (line.substr(0, SHOWN_LINE_LENGTH) + "...") : line) + "\"";
+}
+
+std::string TestRunner::describe(const TestCase &testCase, const TestResult &testResult)
+{
+    std::stringstream returnStream;
+    returnStream << (testResult.passed ? "PASS  " : "FAIL  ") << std::left << std::setw(24) << testCase.name << std::right;
+    if (testResult.error != "") {
+        returnStream << "  " << testResult.error;
+        return returnStream.str();
+    }
+    returnStream << std::fixed << std::setprecision(1) << std::setw(10) << (testResult.wallSeconds * 1000.0) << " ms";
+    returnStream << std::setw(10) << testResult.peakMemoryKilobytes << " KB";
+    if (testResult.timedOut) {
+        returnStream << "  killed at the time limit";
+    } else if (testResult.returnValue != 0) {
+        returnStream << "  exited with a return value of " << testResult.returnValue;
+    }
+    if (testResult.differingLine != 0) {
+        returnStream << std::endl << "      line " << testResult.differingLine << ": expected " << shownLine(testResult.expectedLine)
+                     << ", got " << shownLine(testResult.actualLine);
+    }
+    return returnStream.str();
+}
+
+std::string TestRunner::summary(const std::vector<TestCase> &testCases, const std::vector<TestResult> &testResults)
+{
+    size_t passedCount{0};
+    size_t slowestIndex{0};
+    long peakMemoryKilobytes{0};
+    for (size_t i = 0; i < testResults.size(); i++) {
+        passedCount += (testResults[i].passed ? 1 : 0);
+        if (testResults[i].wallSeconds > testResults[slowestIndex].wallSeconds) {
+            slowestIndex = i;
+        }
+        peakMemoryKilobytes = std::max(peakMemoryKilobytes, testResults[i].peakMemoryKilobytes);
+    }
+    std::stringstream returnStream;
+    returnStream << passedCount << " of " << testResults.size() << " test cases passed";
+    if (!testResults.empty()) {
+        returnStream << " (slowest " << testCases[slowestIndex].name << " at " << std::fixed << std::setprecision(1) << (testResults[slowestIndex].wallSeconds * 1000.0)
+                     << " ms, largest peak memory " << peakMemoryKilobytes << " KB)";
+    }
+    return returnStream.str();
+}
@@ -0,0 +1,349 @@
+/***********************************************************************
+*    timereport.cpp:                                                   *
+*    Collects where the compiler spends its time for EasyGpp           *
+*    Copyright (c) 2016 Tyler Lewis                                    *
+************************************************************************
+*    This is a source file for EasyGpp:                                *
+*    https://github.com/Pinguinsan/EasyGpp                             *
+*    The source code is released under the GNU LGPL                    *
+*    This file holds the implementation of a TimeReport class. This    *
+*    class adds the compiler's own timing switches to every compile,   *
+*    gathers what each translation unit reported (clang's -ftime-trace *
+*    files, or gcc's -ftime-report and -H output), and turns it into a *
+*    ranked summary for the whole project and one merged Chrome trace  *
+*                                                                      *
+*    You should have received a copy of the GNU Lesser General         *
+*    Public license along with libraryprojects                         *
+*    If not, see <http://www.gnu.org/licenses/>                        *
+***********************************************************************/
+
+#include "timereport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <cstdlib>
+#include <cctype>
+
+static const char *CLANG_TIME_TRACE_SWITCHES{" -ftime-trace"};
+static const char *GCC_TIME_REPORT_SWITCHES{" -ftime-report -H"};
+
+namespace {
+    std::vector<std::string> splitLines(const std::string &text)
+    {
+        std::vector<std::string> returnVector;
+        std::stringstream textStream{text};
+        std::string line{""};
+        while (std::getline(textStream, line)) {
+            returnVector.emplace_back(line);
+        }
+        return returnVector;
+    }
+
+    bool startsWith(const std::string &stringToCheck, const std::string &prefix)
+    {
+        return (stringToCheck.compare(0, prefix.length(), prefix) == 0);
+    }
+
+    //" phase parsing    :   0.54 ( 78%)   0.27 ( 96%)   0.83 ( 84%)    39M ( 84%)"
+    //gives "phase parsing" and 0.83 (the wall clock column)
+    bool parseTimeVariable(const std::string &line, std::string &name, double &wallSeconds)
+    {
+        size_t foundColon{line.find(':')};
+        if (foundColon == std::string::npos) {
+            return false;
+        }
+        name = line.substr(0, foundColon);
+        name.erase(0, name.find_first_not_of(" |"));
+        name.erase(name.find_last_not_of(' ') + 1);
+        std::vector<double> columns;
+        const char *position{line.c_str() + foundColon + 1};
+        while (*position != '\0') {
+            char *numberEnd{nullptr};
+            double value{strtod(position, &numberEnd)};
+            if (numberEnd == position) {
+                position++;
+                continue;
+            }
+            position = numberEnd;
+            //Skip the "( 78%)" that follows every time column
+            while ((*position == ' ') || (*position == '(')) {
+                position++;
+            }
+            if (isdigit(static_cast<unsigned char>(*position))) {
+                strtod(position, &numberEnd);
+                if (*numberEnd == '%') {
+                    position = numberEnd + 1;
+                }
+            }
+            columns.emplace_back(value);
+        }
+        if (columns.size() < 3) {
+            return false;
+        }
+        wallSeconds = columns[2];
+        return (!name.empty());
+    }
+
+    std::string formatSeconds(double seconds)
+    {
+        std::stringstream returnStream;
+        returnStream << std::fixed << std::setprecision(2) << seconds << "s";
+        return returnStream.str();
+    }
+
+    std::string padRight(const std::string &stringToPad, size_t width)
+    {
+        return ((stringToPad.length() >= width) ? (stringToPad + " ") : (stringToPad + std::string(width - stringToPad.length(), ' ')));
+    }
+}
+
+TimeReport::TimeReport(bool clangTrace) :
+    m_clangTrace{clangTrace},
+    m_baseTime{std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count()},
+    m_nextThreadId{1},
+    m_chromeTrace{},
+    m_phaseSeconds{},
+    m_activitySeconds{},
+    m_templateSeconds{},
+    m_headerCosts{},
+    m_unitSeconds{}
+{
+
+}
+
+std::string TimeReport::compileSwitches() const
+{
+    return (this->m_clangTrace ? CLANG_TIME_TRACE_SWITCHES : GCC_TIME_REPORT_SWITCHES);
+}
+
+size_t TimeReport::translationUnitCount() const
+{
+    return this->m_unitSeconds.size();
+}
+
+void TimeReport::addPhaseSeconds(const std::string &phaseName, double seconds)
+{
+    for (auto &it : this->m_phaseSeconds) {
+        if (it.first == phaseName) {
+            it.second += seconds;
+            return;
+        }
+    }
+    this->m_phaseSeconds.emplace_back(phaseName, seconds);
+}
+
+std::string TimeReport::addTranslationUnit(const std::string &description, const std::string &objectFile, const BuildResult &buildResult)
+{
+    int threadId{this->m_nextThreadId++};
+    double startMicroseconds{(buildResult.startTime - this->m_baseTime) * 1000000.0};
+    this->m_chromeTrace.setThreadName(threadId, description);
+    this->m_chromeTrace.addEvent(TraceEvent{description, "", startMicroseconds, buildResult.elapsedSeconds * 1000000.0, threadId});
+    this->m_unitSeconds.emplace_back(description, buildResult.elapsedSeconds);
+    if (this->m_clangTrace) {
+        this->readClangTrace(objectFile, threadId, startMicroseconds);
+        return buildResult.output;
+    }
+    return this->readGccReport(buildResult.output, threadId, startMicroseconds);
+}
+
+std::string TimeReport::readGccReport(const std::string &output, int threadId, double startMicroseconds)
+{
+    //-H prints one line per header opened, with one dot per nesting level,
+    //so a header's cost is approximated by how many headers it pulls in
+    std::vector<std::string> lines{splitLines(output)};
+    std::string returnString{""};
+    std::vector<std::pair<size_t, std::string>> includeStack;
+    std::set<std::string> headersInUnit;
+    bool inGuardList{false};
+    bool inTimeReport{false};
+    double phaseOffset{0.0};
+    for (size_t i = 0; i < lines.size(); i++) {
+        const std::string &line = lines[i];
+        size_t depth{line.find_first_not_of('.')};
+        if ((depth != std::string::npos) && (depth > 0) && (line[depth] == ' ')) {
+            std::string headerPath{line.substr(depth + 1)};
+            while ((!includeStack.empty()) && (includeStack.back().first >= depth)) {
+                includeStack.pop_back();
+            }
+            for (auto &it : includeStack) {
+                this->m_headerCosts[it.second].pulledInHeaders++;
+            }
+            HeaderCost &headerCost = this->m_headerCosts.emplace(headerPath, HeaderCost{0.0, 0, 0}).first->second;
+            if (headersInUnit.emplace(headerPath).second) {
+                headerCost.translationUnits++;
+            }
+            includeStack.emplace_back(depth, headerPath);
+            continue;
+        }
+        if ((startsWith(line, "! ")) || (startsWith(line, "x "))) {
+            continue;
+        }
+        if (line == "Multiple include guards may be useful for:") {
+            inGuardList = true;
+            continue;
+        }
+        if (inGuardList) {
+            if ((!line.empty()) && (line.find(": ") == std::string::npos)) {
+                continue;
+            }
+            inGuardList = false;
+        }
+        if ((line.empty()) && (i + 1 < lines.size()) && (startsWith(lines[i + 1], "Time variable"))) {
+            continue;
+        }
+        if (startsWith(line, "Time variable")) {
+            inTimeReport = true;
+            continue;
+        }
+        if (inTimeReport) {
+            std::string name{""};
+            double wallSeconds{0.0};
+            if (!parseTimeVariable(line, name, wallSeconds)) {
+                continue;
+            }
+            if (name == "TOTAL") {
+                inTimeReport = false;
+            } else if (startsWith(name, "phase ")) {
+                //Phases run one after the other, so they are laid end to end
+                this->addPhaseSeconds(name.substr(6), wallSeconds);
+                this->m_chromeTrace.addEvent(TraceEvent{name, "", startMicroseconds + phaseOffset, wallSeconds * 1000000.0, threadId});
+                phaseOffset += wallSeconds * 1000000.0;
+            } else {
+                this->m_activitySeconds[name] += wallSeconds;
+            }
+            continue;
+        }
+        if ((startsWith(line, "Extra diagnostic checks enabled")) || (startsWith(line, "Configure with --enable-checking=release"))) {
+            continue;
+        }
+        returnString += (line + "\n");
+    }
+    return returnString;
+}
+
+void TimeReport::readClangTrace(const std::string &objectFile, int threadId, double startMicroseconds)
+{
+    //clang names the trace after the object, with .json in place of .o
+    std::vector<TraceEvent> traceEvents;
+    std::string tracePath{objectFile};
+    if ((tracePath.length() > 2) && (tracePath.compare(tracePath.length() - 2, 2, ".o") == 0)) {
+        tracePath.erase(tracePath.length() - 2);
+    }
+    if ((!ChromeTrace::readEvents(tracePath + ".json", traceEvents)) && (!ChromeTrace::readEvents(objectFile + ".json", traceEvents))) {
+        return;
+    }
+    std::set<std::string> headersInUnit;
+    for (auto &it : traceEvents) {
+        double seconds{it.durationMicroseconds / 1000000.0};
+        if (startsWith(it.name, "Total ")) {
+            this->m_activitySeconds[it.name.substr(6)] += seconds;
+            continue;
+        }
+        if ((it.name == "Frontend") || (it.name == "Backend")) {
+            this->addPhaseSeconds(it.name, seconds);
+        } else if ((it.name == "Source") && (it.detail != "")) {
+            HeaderCost &headerCost = this->m_headerCosts.emplace(it.detail, HeaderCost{0.0, 0, 0}).first->second;
+            headerCost.seconds += seconds;
+            if (headersInUnit.emplace(it.detail).second) {
+                headerCost.translationUnits++;
+            }
+        } else if (((it.name == "InstantiateClass") || (it.name == "InstantiateFunction")) && (it.detail != "")) {
+            std::pair<double, size_t> &templateCost = this->m_templateSeconds[it.detail];
+            templateCost.first += seconds;
+            templateCost.second++;
+        }
+        this->m_chromeTrace.addEvent(TraceEvent{it.name, it.detail, startMicroseconds + it.startMicroseconds, it.durationMicroseconds, threadId});
+    }
+}
+
+std::string TimeReport::summary(size_t topCount) const
+{
+    double totalSeconds{0.0};
+    for (auto &it : this->m_unitSeconds) {
+        totalSeconds += it.second;
+    }
+    std::stringstream returnStream;
+    returnStream << "Compile time report for " << this->m_unitSeconds.size() << ((this->m_unitSeconds.size() == 1) ? " translation unit" : " translation units")
+                 << " (" << formatSeconds(totalSeconds) << " of compiler time)" << std::endl;
+    auto percentOfTotal = [totalSeconds](double seconds) {
+        std::stringstream percentStream;
+        percentStream << std::fixed << std::setprecision(1) << ((totalSeconds > 0.0) ? (100.0 * seconds / totalSeconds) : 0.0) << "%";
+        return percentStream.str();
+    };
+
+    if (!this->m_phaseSeconds.empty()) {
+        returnStream << std::endl << "    Phases:" << std::endl;
+        for (auto &it : this->m_phaseSeconds) {
+            returnStream << "        " << padRight(it.first, 40) << padRight(formatSeconds(it.second), 10) << percentOfTotal(it.second) << std::endl;
+        }
+    }
+
+    std::vector<std::pair<std::string, double>> activities{this->m_activitySeconds.begin(), this->m_activitySeconds.end()};
+    std::sort(activities.begin(), activities.end(), [](const std::pair<std::string, double> &lhs, const std::pair<std::string, double> &rhs) {
+        return (lhs.second > rhs.second);
+    });
+    if (!activities.empty()) {
+        returnStream << std::endl << "    Most expensive activities:" << std::endl;
+        for (size_t i = 0; (i < activities.size()) && (i < topCount); i++) {
+            returnStream << "        " << padRight(activities[i].first, 40) << padRight(formatSeconds(activities[i].second), 10) << percentOfTotal(activities[i].second) << std::endl;
+        }
+    }
+
+    std::vector<std::pair<std::string, HeaderCost>> headers{this->m_headerCosts.begin(), this->m_headerCosts.end()};
+    if (this->m_clangTrace) {
+        std::sort(headers.begin(), headers.end(), [](const std::pair<std::string, HeaderCost> &lhs, const std::pair<std::string, HeaderCost> &rhs) {
+            return (lhs.second.seconds > rhs.second.seconds);
+        });
+    } else {
+        std::sort(headers.begin(), headers.end(), [](const std::pair<std::string, HeaderCost> &lhs, const std::pair<std::string, HeaderCost> &rhs) {
+            return ((lhs.second.translationUnits + lhs.second.pulledInHeaders) > (rhs.second.translationUnits + rhs.second.pulledInHeaders));
+        });
+    }
+    if (!headers.empty()) {
+        returnStream << std::endl << (this->m_clangTrace ? "    Most expensive headers (time includes nested headers):" 
+                                                         : "    Most expensive headers (gcc does not time headers, so ranked by how many headers each pulls in):") << std::endl;
+        for (size_t i = 0; (i < headers.size()) && (i < topCount); i++) {
+            const HeaderCost &headerCost = headers[i].second;
+            returnStream << "        " << padRight(headers[i].first, 60);
+            if (this->m_clangTrace) {
+                returnStream << padRight(formatSeconds(headerCost.seconds), 10);
+            } else {
+                returnStream << padRight(std::to_string(headerCost.pulledInHeaders) + " headers pulled in", 24);
+            }
+            returnStream << "in " << headerCost.translationUnits << ((headerCost.translationUnits == 1) ? " translation unit" : " translation units") << std::endl;
+        }
+    }
+
+    std::vector<std::pair<std::string, std::pair<double, size_t>>> templates{this->m_templateSeconds.begin(), this->m_templateSeconds.end()};
+    std::sort(templates.begin(), templates.end(), [](const std::pair<std::string, std::pair<double, size_t>> &lhs, const std::pair<std::string, std::pair<double, size_t>> &rhs) {
+        return (lhs.second.first > rhs.second.first);
+    });
+    if (!templates.empty()) {
+        returnStream << std::endl << "    Most expensive template instantiations:" << std::endl;
+        for (size_t i = 0; (i < templates.size()) && (i < topCount); i++) {
+            returnStream << "        " << padRight(templates[i].first, 60) << padRight(formatSeconds(templates[i].second.first), 10) 
+                         << templates[i].second.second << ((templates[i].second.second == 1) ? " time" : " times") << std::endl;
+        }
+    } else if (this->m_activitySeconds.find("template instantiation") != this->m_activitySeconds.end()) {
+        returnStream << std::endl << "    Template instantiation: " << formatSeconds(this->m_activitySeconds.at("template instantiation")) 
+                     << " in total (gcc does not break this down per template, clang's -ftime-trace does)" << std::endl;
+    }
+
+    std::vector<std::pair<std::string, double>> units{this->m_unitSeconds};
+    std::sort(units.begin(), units.end(), [](const std::pair<std::string, double> &lhs, const std::pair<std::string, double> &rhs) {
+        return (lhs.second > rhs.second);
+    });
+    returnStream << std::endl << "    Slowest translation units:" << std::endl;
+    for (size_t i = 0; (i < units.size()) && (i < topCount); i++) {
+        returnStream << "        " << padRight(units[i].first, 60) << padRight(formatSeconds(units[i].second), 10) << percentOfTotal(units[i].second) << std::endl;
+    }
+    return returnStream.str();
+}
+
+bool TimeReport::writeTrace(const std::string &filePath) const
+{
+    return this->m_chromeTrace.write(filePath);
+}